@@ -16,6 +16,8 @@
 #include <AMReX_StateData.H>
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_Print.H>
+#include <AMReX_AsyncOut.H>
+#include <AMReX_FileSystem.H>
 
 #ifdef BL_LAZY
 #include <AMReX_Lazy.H>
@@ -38,13 +40,16 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <list>
 #include <sstream>
+#include <thread>
 
 namespace amrex {
 
@@ -80,6 +85,9 @@ namespace
 #endif
     bool plot_files_output;
     int  checkpoint_nfiles;
+    int  checkpoint_full_int;
+    std::string checkpoint_stage_dir;
+    Real checkpoint_drain_rate;
     int  regrid_on_restart;
     int  use_efficient_regrid;
     int  plotfile_on_restart;
@@ -90,6 +98,134 @@ namespace
     bool prereadFAHeaders;
     VisMF::Header::Version plot_headerversion(VisMF::Header::Version_v1);
     VisMF::Header::Version checkpoint_headerversion(VisMF::Header::Version_v1);
+
+    //
+    // Which rank drains the node-local checkpoint staging area.  It is the
+    // lowest rank on each node.
+    //
+    struct StageNodeInfo
+    {
+        bool defined = false;
+        bool leader  = true;
+    };
+    StageNodeInfo stage_node;
+
+    void
+    defineStageNodeInfo ()
+    {
+        if (stage_node.defined) return;
+        stage_node.defined = true;
+#ifdef AMREX_USE_MPI
+        MPI_Comm node_comm;
+        MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+                            ParallelDescriptor::MyProc(), MPI_INFO_NULL, &node_comm);
+        int node_rank;
+        MPI_Comm_rank(node_comm, &node_rank);
+        stage_node.leader = node_rank == 0;
+        MPI_Comm_free(&node_comm);
+#endif
+    }
+
+    //
+    // The staged checkpoint whose drain has been submitted but which has
+    // not been renamed to its final name yet.
+    //
+    std::string pending_staged_checkpoint;
+
+    void
+    drainFile (std::string const& src, std::string const& dst,
+               Real rate, Long& nbytes, double t0)
+    {
+        std::ifstream ifs(src, std::ios::in | std::ios::binary);
+        if ( ! ifs.good()) {
+            amrex::FileOpenFailed(src);
+        }
+        std::ofstream ofs(dst, std::ios::out | std::ios::trunc | std::ios::binary);
+        if ( ! ofs.good()) {
+            amrex::FileOpenFailed(dst);
+        }
+        Vector<char> buf(VisMF::GetIOBufferSize());
+        while (ifs) {
+            ifs.read(buf.data(), buf.size());
+            const std::streamsize n = ifs.gcount();
+            if (n <= 0) break;
+            ofs.write(buf.data(), n);
+            nbytes += n;
+            if (rate > 0.0) {
+                // Sleep until the average rate is back under the limit.
+                const double ahead = double(nbytes)/(rate*1.e6) - (amrex::second()-t0);
+                if (ahead > 0.0) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(ahead));
+                }
+            }
+        }
+        if ( ! ofs.good()) {
+            amrex::Abort("Amr::checkPoint: failed to drain " + src + " to " + dst);
+        }
+    }
+
+    //
+    // Called by all ranks after a staged checkpoint's writes have been
+    // submitted.  Once every rank's writes to the staging directory are
+    // done, the node's leader submits a job to its AsyncOut thread that
+    // copies the staged files into ckfile.temp at no more than
+    // checkpoint_drain_rate MB/s and removes the staging directory.
+    // No MPI calls are made on the AsyncOut thread.
+    //
+    void
+    drainStagedCheckPoint (std::string const& stage, std::string const& ckfile)
+    {
+        AsyncOut::Finish();
+        ParallelDescriptor::Barrier("Amr::checkPoint::staged");
+
+        if (stage_node.leader)
+        {
+            const Real rate = checkpoint_drain_rate;
+            AsyncOut::Submit([=] ()
+            {
+                const std::string dest = ckfile + ".temp";
+                const double t0 = amrex::second();
+                Long nbytes = 0;
+                for (auto const& f : FileSystem::ListFiles(stage)) {
+                    const auto pos = f.find_last_of('/');
+                    if (pos != std::string::npos) {
+                        const std::string dir = dest + "/" + f.substr(0,pos);
+                        if ( ! amrex::UtilCreateDirectory(dir, 0755)) {
+                            amrex::CreateDirectoryFailed(dir);
+                        }
+                    }
+                    drainFile(stage + "/" + f, dest + "/" + f, rate, nbytes, t0);
+                }
+                FileSystem::RemoveAll(stage);
+            });
+        }
+
+        pending_staged_checkpoint = ckfile;
+    }
+
+    //
+    // Wait for the drain of the pending staged checkpoint on all nodes and
+    // rename ckfile.temp to ckfile, so that a restart never sees a
+    // partially drained checkpoint.  This is collective, and it is called
+    // before the next checkpoint and at the end of the run.
+    //
+    void
+    commitStagedCheckPoint ()
+    {
+        if (pending_staged_checkpoint.empty()) return;
+
+        const std::string ckfile = pending_staged_checkpoint;
+        pending_staged_checkpoint.clear();
+
+        AsyncOut::Finish();
+        ParallelDescriptor::Barrier("Amr::commitStagedCheckPoint");
+        if (ParallelDescriptor::IOProcessor()) {
+            if (std::rename((ckfile + ".temp").c_str(), ckfile.c_str()) != 0) {
+                amrex::Abort("Amr::checkPoint: failed to rename " + ckfile + ".temp");
+            }
+        }
+        ParallelDescriptor::Barrier("Renaming staged checkPoint file.");
+    }
 }
 
 
@@ -116,6 +252,9 @@ Amr::Initialize ()
 #endif
     plot_files_output        = true;
     checkpoint_nfiles        = 64;
+    checkpoint_full_int      = 0;
+    checkpoint_stage_dir.clear();
+    checkpoint_drain_rate    = 0.0;
     regrid_on_restart        = 0;
     use_efficient_regrid     = 0;
     plotfile_on_restart      = 0;
@@ -740,6 +879,8 @@ Amr::deleteDeriveSmallPlotVar (const std::string& name)
 
 Amr::~Amr ()
 {
+    commitStagedCheckPoint();
+
     levelbld->variableCleanUp();
 
     Amr::Finalize();
@@ -1446,6 +1587,28 @@ Amr::restart (const std::string& filename)
       }
     }
 
+    //
+    // A differential checkpoint names the full checkpoint it is based on.
+    // The two are in the same directory.
+    //
+    {
+        Vector<char> diffBaseChars;
+        ParallelDescriptor::ReadAndBcastFile(filename + "/DifferentialBase", diffBaseChars, false);
+        if (diffBaseChars.size() > 0) {
+            std::string baseName;
+            std::istringstream dis(std::string(diffBaseChars.dataPtr()), std::istringstream::in);
+            dis >> baseName;
+            std::string dirName(filename);
+            while (dirName.size() > 1 && dirName.back() == '/') { dirName.pop_back(); }
+            const auto pos = dirName.find_last_of('/');
+            dirName = (pos == std::string::npos) ? std::string() : dirName.substr(0, pos+1);
+            StateData::SetDifferentialBase(dirName + baseName);
+            if (verbose > 0) {
+                amrex::Print() << "differential checkpoint based on: " << dirName + baseName << "\n";
+            }
+        }
+    }
+
     //
     // Open the checkpoint header file for reading.
     //
@@ -1673,6 +1836,8 @@ Amr::restart (const std::string& filename)
     last_checkpoint = level_steps[0];
     last_plotfile = level_steps[0];
 
+    StateData::SetDifferentialBase(std::string());
+
     for (int lev = 0; lev <= finest_level; ++lev)
     {
         Box restart_domain(Geom(lev).Domain());
@@ -1709,6 +1874,8 @@ Amr::checkPoint ()
     BL_PROFILE_REGION_START("Amr::checkPoint()");
     BL_PROFILE("Amr::checkPoint()");
 
+    commitStagedCheckPoint();
+
     VisMF::SetNOutFiles(checkpoint_nfiles);
     //
     // In checkpoint files always write out FABs in NATIVE format.
@@ -1732,11 +1899,40 @@ Amr::checkPoint ()
         runlog << "CHECKPOINT: file = " << ckfile << '\n';
     }
 
+    //
+    // A differential checkpoint is relative to the last full one, and
+    // requires the grids to be the same as then.
+    //
+    bool differential = checkpoint_full_int > 1 && ! last_full_checkpoint.empty()
+        && num_differential_checkpoints < checkpoint_full_int-1;
+    for (int i = 0; differential && i <= finest_level; ++i) {
+        differential = amr_level[i]->canCheckPointDifferential();
+    }
+    if (differential) {
+        StateData::SetCheckPointType(StateData::Differential);
+    } else if (checkpoint_full_int > 1) {
+        StateData::SetCheckPointType(StateData::FullWithChecksums);
+    } else {
+        StateData::SetCheckPointType(StateData::Full);
+    }
+
+    if (verbose > 0 && differential) {
+        amrex::Print() << "CHECKPOINT: differential, based on " << last_full_checkpoint << "\n";
+    }
+
   amrex::StreamRetry sretry(ckfile, abort_on_stream_retry_failure,
                              stream_max_tries);
 
-  // For AsyncOut, we need to turn off stream retry and write to ckfile directly.
-  const std::string ckfileTemp = (AsyncOut::UseAsyncOut()) ? ckfile : (ckfile + ".temp");
+  // For AsyncOut, we need to turn off stream retry and write to ckfile directly,
+  // or to the node-local staging directory if there is one.
+  const bool staged = AsyncOut::UseAsyncOut() && ! checkpoint_stage_dir.empty();
+  std::string ckfileTemp = (AsyncOut::UseAsyncOut()) ? ckfile : (ckfile + ".temp");
+  if (staged) {
+      defineStageNodeInfo();
+      const auto pos = ckfile.find_last_of('/');
+      ckfileTemp = checkpoint_stage_dir + "/"
+          + ((pos == std::string::npos) ? ckfile : ckfile.substr(pos+1));
+  }
 
   while(sretry.TryFileOutput()) {
 
@@ -1750,7 +1946,27 @@ Amr::checkPoint ()
     //  it to a bad suffix if there were stream errors.
     //
 
-    if (precreateDirectories) {    // ---- make all directories at once
+    if (staged) {
+      //
+      // The staging directory is node-local, so each node needs its own
+      // tree.  The final directory is filled in by the drain.
+      //
+      if (stage_node.leader && amrex::FileExists(ckfileTemp)) {
+          FileSystem::RemoveAll(ckfileTemp);
+      }
+      amrex::UtilRenameDirectoryToOld(ckfile, false);
+      amrex::UtilCreateCleanDirectory(ckfile + ".temp", false);
+      ParallelDescriptor::Barrier("Amr::checkPoint::stage");
+      for (int i(0); i <= finest_level; ++i)
+      {
+        std::string LevelDir, FullPath;
+        amr_level[i]->LevelDirectoryNames(ckfileTemp, LevelDir, FullPath);
+        if ( ! amrex::UtilCreateDirectory(FullPath, 0755)) {
+          amrex::CreateDirectoryFailed(FullPath);
+        }
+        amr_level[i]->SetLevelDirectoryCreated(true);
+      }
+    } else if (precreateDirectories) {    // ---- make all directories at once
       amrex::UtilRenameDirectoryToOld(ckfile, false);      // dont call barrier
       amrex::UtilCreateCleanDirectory(ckfileTemp, false);  // dont call barrier
       for (int i(0); i <= finest_level; ++i)
@@ -1809,6 +2025,18 @@ Amr::checkPoint ()
         HeaderFile << '\n';
         for (int i(0); i <= max_level; ++i) { HeaderFile << level_count[i] << ' '; }
         HeaderFile << '\n';
+
+        if (differential) {
+            std::string baseName(last_full_checkpoint);
+            const auto pos = baseName.find_last_of('/');
+            if (pos != std::string::npos) { baseName = baseName.substr(pos+1); }
+            std::ofstream DiffBaseFile(ckfileTemp + "/DifferentialBase",
+                                       std::ios::out | std::ios::trunc);
+            if ( ! DiffBaseFile.good()) {
+                amrex::FileOpenFailed(ckfileTemp + "/DifferentialBase");
+            }
+            DiffBaseFile << baseName << '\n';
+        }
     }
 
     for (int i = 0; i <= finest_level; ++i) {
@@ -1871,6 +2099,18 @@ Amr::checkPoint ()
     }
   }  // end while
 
+  if (staged) {
+      drainStagedCheckPoint(ckfileTemp, ckfile);
+  }
+
+  if (differential) {
+      ++num_differential_checkpoints;
+  } else if (checkpoint_full_int > 1) {
+      last_full_checkpoint = ckfile;
+      num_differential_checkpoints = 0;
+  }
+  StateData::SetCheckPointType(StateData::Full);
+
   //
   // Restore the previous FAB format.
   //
@@ -3186,6 +3426,26 @@ Amr::initPltAndChk ()
     //
     if (plot_nfiles       == -1) plot_nfiles       = ParallelDescriptor::NProcs();
     if (checkpoint_nfiles == -1) checkpoint_nfiles = ParallelDescriptor::NProcs();
+    //
+    // If > 1, only every checkpoint_full_int-th checkpoint is written in
+    // full.  The ones in between contain only the FABs that have changed.
+    //
+    pp.query("checkpoint_full_int", checkpoint_full_int);
+    //
+    // With amrex.async_out, checkpoints can be staged in node-local storage
+    // (e.g., /dev/shm) and drained to check_file in the background, at no
+    // more than checkpoint_drain_rate MB/s per node if that is > 0.
+    //
+    pp.query("checkpoint_stage_dir", checkpoint_stage_dir);
+    pp.query("checkpoint_drain_rate", checkpoint_drain_rate);
+    if ( ! checkpoint_stage_dir.empty()) {
+        if ( ! AsyncOut::UseAsyncOut()) {
+            amrex::Print() << "Warning: amr.checkpoint_stage_dir is ignored without amrex.async_out\n";
+        } else if (AsyncOut::GetWriteInfo(0).nspots > 1) {
+            amrex::Abort("amr.checkpoint_stage_dir requires amrex.async_out_nfiles to be "
+                         "at least the number of processes");
+        }
+    }
 
     check_file_root = "chk";
     pp.query("check_file",check_file_root);
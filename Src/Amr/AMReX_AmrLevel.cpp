@@ -15,6 +15,8 @@
 #include <AMReX_EB2.H>
 #endif
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 #include <memory>
 #include <limits>
@@ -30,6 +32,7 @@ EBSupport AmrLevel::m_eb_support_level = EBSupport::volume;
 
 DescriptorList AmrLevel::desc_lst;
 DeriveList     AmrLevel::derive_lst;
+int            AmrLevel::batch_derive = 0;
 
 void
 AmrLevel::postCoarseTimeStep (Real time)
@@ -334,10 +337,19 @@ AmrLevel::writePlotFile (const std::string& dir,
     // derived
     if (derive_names.size() > 0)
     {
-        for (auto const& dname : derive_names)
+        if (batch_derive)
         {
-            derive(dname, cur_time, plotMF, cnt);
-            cnt++;
+            derive(Vector<std::string>(derive_names.begin(), derive_names.end()),
+                   cur_time, plotMF, cnt);
+            cnt += derive_names.size();
+        }
+        else
+        {
+            for (auto const& dname : derive_names)
+            {
+                derive(dname, cur_time, plotMF, cnt);
+                cnt++;
+            }
         }
     }
 
@@ -544,6 +556,19 @@ AmrLevel::checkPoint (const std::string& dir,
 }
 
 
+bool
+AmrLevel::canCheckPointDifferential () const
+{
+    for (int i = 0; i < desc_lst.size(); i++)
+    {
+        if ( ! state[i].canCheckPointDifferential()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 void
 AmrLevel::checkPointPre (const std::string& /*dir*/,
                          std::ostream&      /*os*/)
@@ -1931,6 +1956,144 @@ AmrLevel::derive (const std::string& name, Real time, MultiFab& mf, int dcomp)
     }
 }
 
+void
+AmrLevel::derive (const Vector<std::string>& names, Real time, MultiFab& mf, int dcomp)
+{
+    BL_PROFILE("AmrLevel::derive(batch)");
+
+    const int ngrow = mf.nGrow();
+    const int nnames = names.size();
+
+    BL_ASSERT(dcomp+nnames <= mf.nComp());
+
+    // The quantities computed by a derFuncFab are done together.  For each
+    // state type, find the components they need and the most ghost cells.
+    Vector<const DeriveRec*> recs(nnames, nullptr);
+    Vector<int> ngrow_src(nnames, 0);
+    std::map<int,Vector<int> > needed;  // state type -> sorted components
+    std::map<int,int> ngrow_fill;       // state type -> ghost cells
+    for (int i = 0; i < nnames; ++i)
+    {
+        int index, scomp, ncomp;
+        if (isStateVariable(names[i], index, scomp)) continue;
+        const DeriveRec* rec = derive_lst.get(names[i]);
+        if (rec == nullptr || rec->derFuncFab() == nullptr) continue;
+
+        recs[i] = rec;
+
+        rec->getRange(0, index, scomp, ncomp);
+        const BoxArray& srcBA = state[index].boxArray();
+        ngrow_src[i] = ngrow;
+        {
+            Box bx0 = srcBA[0];
+            Box bx1 = rec->boxMap()(bx0);
+            int g = bx0.smallEnd(0) - bx1.smallEnd(0);
+            ngrow_src[i] += g;
+        }
+
+        for (int k = 0; k < rec->numRange(); ++k)
+        {
+            rec->getRange(k, index, scomp, ncomp);
+            Vector<int>& comps = needed[index];
+            for (int n = scomp; n < scomp+ncomp; ++n) {
+                comps.push_back(n);
+            }
+            ngrow_fill[index] = std::max(ngrow_fill[index], ngrow_src[i]);
+        }
+    }
+
+    // Fill each state type once.  The components needed are stored in
+    // order, and each contiguous run of them is one FillPatch.
+    std::map<int,MultiFab> filled;
+    std::map<int,std::map<int,int> > slot;  // state type -> component -> slot in filled
+    for (auto& kv : needed)
+    {
+        const int index = kv.first;
+        Vector<int>& comps = kv.second;
+        std::sort(comps.begin(), comps.end());
+        comps.erase(std::unique(comps.begin(), comps.end()), comps.end());
+
+        const int ncomps = comps.size();
+        const int ng = ngrow_fill[index];
+        MultiFab& smf = filled[index];
+        smf.define(state[index].boxArray(), dmap, ncomps, ng, MFInfo(), *m_factory);
+
+        for (int n = 0; n < ncomps; ++n) {
+            slot[index][comps[n]] = n;
+        }
+        for (int n0 = 0; n0 < ncomps; )
+        {
+            int n1 = n0+1;
+            while (n1 < ncomps && comps[n1] == comps[n1-1]+1) { ++n1; }
+            FillPatch(*this, smf, ng, time, index, comps[n0], n1-n0, n0);
+            n0 = n1;
+        }
+    }
+
+    // The source data of each quantity is an alias into the filled data if
+    // its components are contiguous there, or a local copy otherwise.
+    Vector<std::unique_ptr<MultiFab> > srcMF(nnames);
+    for (int i = 0; i < nnames; ++i)
+    {
+        const DeriveRec* rec = recs[i];
+        if (rec == nullptr) continue;
+
+        int index0, scomp, ncomp;
+        rec->getRange(0, index0, scomp, ncomp);
+        const int slot0 = slot[index0][scomp];
+        bool contiguous = true;
+        for (int k = 0, dc = 0; k < rec->numRange(); ++k, dc += ncomp)
+        {
+            int index;
+            rec->getRange(k, index, scomp, ncomp);
+            contiguous = contiguous && index == index0 && slot[index][scomp] == slot0+dc
+                && slot[index][scomp+ncomp-1] == slot0+dc+ncomp-1;
+        }
+
+        if (contiguous) {
+            srcMF[i] = std::make_unique<MultiFab>(filled[index0], amrex::make_alias,
+                                                  slot0, rec->numState());
+        } else {
+            srcMF[i] = std::make_unique<MultiFab>(state[index0].boxArray(), dmap, rec->numState(),
+                                                  ngrow_src[i], MFInfo(), *m_factory);
+            for (int k = 0, dc = 0; k < rec->numRange(); ++k, dc += ncomp)
+            {
+                int index;
+                rec->getRange(k, index, scomp, ncomp);
+                for (int n = 0; n < ncomp; ++n) {
+                    MultiFab::Copy(*srcMF[i], filled[index], slot[index][scomp+n], dc+n,
+                                   1, ngrow_src[i]);
+                }
+            }
+        }
+    }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(mf,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.growntilebox();
+        FArrayBox& derfab = mf[mfi];
+        for (int i = 0; i < nnames; ++i)
+        {
+            const DeriveRec* rec = recs[i];
+            if (rec == nullptr) continue;
+            FArrayBox const& datafab = (*srcMF[i])[mfi];
+            rec->derFuncFab()(bx, derfab, dcomp+i, rec->numDerive(), datafab, geom, time,
+                              rec->getBC(), level);
+        }
+    }
+
+    // State variables and the rest are done one at a time.
+    for (int i = 0; i < nnames; ++i)
+    {
+        if (recs[i] == nullptr) {
+            derive(names[i], time, mf, dcomp+i);
+        }
+    }
+}
+
 //! Update the distribution maps in StateData based on the size of the map
 void
 AmrLevel::UpdateDistributionMaps ( DistributionMapping& update_dmap )
@@ -1981,6 +2144,8 @@ AmrLevel::setPlotVariables ()
 {
     ParmParse pp("amr");
 
+    pp.query("batch_derive", batch_derive);
+
     if (pp.contains("plot_vars"))
     {
         std::string nm;
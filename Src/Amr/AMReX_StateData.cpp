@@ -12,6 +12,7 @@
 #include <iostream>
 #include <limits>
 #include <algorithm>
+#include <cstring>
 
 namespace amrex {
 
@@ -26,6 +27,56 @@ static constexpr int MFOLDDATA = 1;
 
 Vector<std::string> StateData::fabArrayHeaderNames;
 std::map<std::string, Vector<char> > *StateData::faHeaderMap;
+StateData::CheckPointType StateData::checkPointType = StateData::Full;
+std::string StateData::differentialBase;
+
+namespace {
+
+// 64-bit FNV-1a hash of the raw bytes of a FAB, including ghost cells.
+std::uint64_t
+fabChecksum (const FArrayBox& fab)
+{
+    const FArrayBox* pfab = &fab;
+#ifdef AMREX_USE_GPU
+    FArrayBox hostfab;
+    if (!fab.arena()->isHostAccessible()) {
+        hostfab.resize(fab.box(), fab.nComp(), The_Pinned_Arena());
+        amrex::dtoh_memcpy(hostfab.dataPtr(), fab.dataPtr(), fab.nBytes());
+        pfab = &hostfab;
+    }
+#endif
+
+    const std::uint64_t prime = 1099511628211ULL;
+    std::uint64_t h = 14695981039346656037ULL;
+
+    const char* p = reinterpret_cast<const char*>(pfab->dataPtr());
+    const std::size_t nbytes = pfab->nBytes();
+    const std::size_t nwords = nbytes / sizeof(std::uint64_t);
+    for (std::size_t i = 0; i < nwords; ++i) {
+        std::uint64_t w;
+        std::memcpy(&w, p + i*sizeof(std::uint64_t), sizeof(std::uint64_t));
+        h = (h ^ w) * prime;
+    }
+    for (std::size_t i = nwords*sizeof(std::uint64_t); i < nbytes; ++i) {
+        h = (h ^ static_cast<unsigned char>(p[i])) * prime;
+    }
+    return h;
+}
+
+Vector<std::uint64_t>
+fabChecksums (const MultiFab& mf)
+{
+    Vector<std::uint64_t> r(mf.local_size());
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        r[mfi.LocalIndex()] = fabChecksum(mf[mfi]);
+    }
+    return r;
+}
+
+}
 
 
 StateData::StateData ()
@@ -57,7 +108,11 @@ StateData::StateData (StateData&& rhs) noexcept
       old_time(rhs.old_time),
       new_data(std::move(rhs.new_data)),
       old_data(std::move(rhs.old_data)),
-      arena(rhs.arena)
+      arena(rhs.arena),
+      checksums(std::move(rhs.checksums)),
+      has_checksums(rhs.has_checksums),
+      checksum_grids(std::move(rhs.checksum_grids)),
+      checksum_dmap(std::move(rhs.checksum_dmap))
 {
 }
 
@@ -130,6 +185,7 @@ StateData::define (const Box&             p_domain,
                                           MFInfo().SetTag("StateData").SetArena(arena),
                                           *m_factory);
     old_data.reset();
+    clearChecksums();
 }
 
 void
@@ -220,6 +276,8 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
     int nsets;
     is >> nsets;
 
+    clearChecksums();
+
     new_data = std::make_unique<MultiFab>(grids,dmap,desc->nComp(),desc->nExtra(),
                                           MFInfo().SetTag("StateData").SetArena(arena),
                                           *m_factory);
@@ -273,8 +331,63 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
             }
         }
 
-        VisMF::Read(*whichMF, FullPathName, faHeader);
+        if (differentialBase.empty()) {
+            VisMF::Read(*whichMF, FullPathName, faHeader);
+        } else {
+            //
+            // A differential checkpoint holds only the FABs that have
+            // changed since the full checkpoint it is based on.
+            //
+            std::string BasePathName = differentialBase;
+            if (BasePathName[BasePathName.length()-1] != '/') {
+                BasePathName += '/';
+            }
+            BasePathName += mf_name;
+            VisMF::Read(*whichMF, BasePathName);
+            if (VisMF::Exist(FullPathName)) {
+                readDifferential(*whichMF, FullPathName);
+            }
+        }
+    }
+}
+
+void
+StateData::readDifferential (MultiFab& mf, const std::string& mf_fullpath)
+{
+    BL_PROFILE("StateData::readDifferential()");
+
+    VisMF vismf(mf_fullpath);
+    const BoxArray& dba = vismf.boxArray();
+
+    //
+    // Put each changed FAB on the process that owns it in mf.
+    //
+    Vector<int> index(dba.size());
+    Vector<int> pmap(dba.size());
+    std::vector<std::pair<int,Box> > isects;
+    for (int i = 0, N = dba.size(); i < N; ++i) {
+        index[i] = -1;
+        grids.intersections(dba[i], isects);
+        for (const auto& is : isects) {
+            if (grids[is.first] == dba[i]) {
+                index[i] = is.first;
+                break;
+            }
+        }
+        if (index[i] < 0) {
+            amrex::Abort("StateData::readDifferential: grids do not match those of "+mf_fullpath);
+        }
+        pmap[i] = dmap[index[i]];
     }
+
+    MultiFab dmf(dba, DistributionMapping(std::move(pmap)), vismf.nComp(), vismf.nGrow(),
+                 MFInfo().SetArena(arena));
+    VisMF::Read(dmf, mf_fullpath);
+
+    for (MFIter mfi(dmf); mfi.isValid(); ++mfi) {
+        mf[index[mfi.index()]].copy<RunOn::Device>(dmf[mfi]);
+    }
+    Gpu::streamSynchronize();
 }
 
 void
@@ -296,6 +409,29 @@ StateData::restart (const StateDescriptor& d,
     new_data->setVal(0._rt);
 }
 
+void
+StateData::clearChecksums ()
+{
+    for (int i = 0; i < 2; ++i) {
+        checksums[i].clear();
+        has_checksums[i] = false;
+    }
+    checksum_grids = BoxArray();
+    checksum_dmap = DistributionMapping();
+}
+
+bool
+StateData::canCheckPointDifferential (bool dump_old) const noexcept
+{
+    if (!desc->store_in_checkpoint()) {
+        return true;
+    }
+    if (!has_checksums[MFNEWDATA] || (dump_old && old_data && !has_checksums[MFOLDDATA])) {
+        return false;
+    }
+    return checksum_grids == grids && checksum_dmap == dmap;
+}
+
 StateData::~StateData()
 {
     desc = nullptr;
@@ -801,16 +937,25 @@ StateData::checkPoint (const std::string& name,
 
         if (desc->store_in_checkpoint())
         {
+           //
+           // The FabArrays of a differential checkpoint might not all
+           // be written, so their headers cannot be preread.
+           //
+           const bool preread = (checkPointType != Differential);
            if (dump_old)
            {
                os << 2 << '\n' << mf_name_new << '\n' << mf_name_old << '\n';
-               fabArrayHeaderNames.push_back(mf_name_new);
-               fabArrayHeaderNames.push_back(mf_name_old);
+               if (preread) {
+                   fabArrayHeaderNames.push_back(mf_name_new);
+                   fabArrayHeaderNames.push_back(mf_name_old);
+               }
            }
            else
            {
                os << 1 << '\n' << mf_name_new << '\n';
-               fabArrayHeaderNames.push_back(mf_name_new);
+               if (preread) {
+                   fabArrayHeaderNames.push_back(mf_name_new);
+               }
            }
         }
         else
@@ -823,23 +968,81 @@ StateData::checkPoint (const std::string& name,
     {
         BL_ASSERT(new_data);
         std::string mf_fullpath_new(fullpathname + NewSuffix);
-        if (AsyncOut::UseAsyncOut()) {
-            VisMF::AsyncWrite(*new_data,mf_fullpath_new);
-        } else {
-            VisMF::Write(*new_data,mf_fullpath_new,how);
-        }
+        writeCheckPointData(*new_data, MFNEWDATA, mf_fullpath_new, how);
 
         if (dump_old)
         {
             BL_ASSERT(old_data);
             std::string mf_fullpath_old(fullpathname + OldSuffix);
-            if (AsyncOut::UseAsyncOut()) {
-                VisMF::AsyncWrite(*old_data,mf_fullpath_old);
-            } else {
-                VisMF::Write(*old_data,mf_fullpath_old,how);
-            }
+            writeCheckPointData(*old_data, MFOLDDATA, mf_fullpath_old, how);
+        }
+    }
+}
+
+void
+StateData::writeCheckPointData (const MultiFab& mf, int which,
+                                const std::string& mf_fullpath, VisMF::How how)
+{
+    if (checkPointType != Differential)
+    {
+        if (AsyncOut::UseAsyncOut()) {
+            VisMF::AsyncWrite(mf,mf_fullpath);
+        } else {
+            VisMF::Write(mf,mf_fullpath,how);
+        }
+
+        if (checkPointType == FullWithChecksums) {
+            checksums[which] = fabChecksums(mf);
+            has_checksums[which] = true;
+            checksum_grids = grids;
+            checksum_dmap = dmap;
+        }
+        return;
+    }
+
+    BL_PROFILE("StateData::writeCheckPointData()-diff");
+
+    AMREX_ASSERT(has_checksums[which] && checksum_grids == grids && checksum_dmap == dmap);
+
+    const Vector<std::uint64_t>& cs = fabChecksums(mf);
+    Vector<int> changed(grids.size(), 0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        if (cs[mfi.LocalIndex()] != checksums[which][mfi.LocalIndex()]) {
+            changed[mfi.index()] = 1;
+        }
+    }
+    ParallelDescriptor::ReduceIntMax(changed.dataPtr(), changed.size());
+
+    BoxList bl(grids.ixType());
+    Vector<int> pmap;
+    Vector<int> index;
+    for (int i = 0, N = grids.size(); i < N; ++i) {
+        if (changed[i]) {
+            bl.push_back(grids[i]);
+            pmap.push_back(dmap[i]);
+            index.push_back(i);
         }
     }
+
+    if (bl.isEmpty()) {
+        return;  // restart will use the full checkpoint only
+    }
+
+    //
+    // The changed FABs are written as a MultiFab aliasing mf.
+    //
+    MultiFab dmf(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)),
+                 mf.nComp(), mf.nGrowVect(), MFInfo().SetAlloc(false));
+    for (MFIter mfi(dmf); mfi.isValid(); ++mfi) {
+        const FArrayBox& fab = mf[index[mfi.index()]];
+        dmf.setFab(mfi, FArrayBox(fab.box(), fab.nComp(), const_cast<Real*>(fab.dataPtr())));
+    }
+
+    if (AsyncOut::UseAsyncOut()) {
+        VisMF::AsyncWrite(dmf,mf_fullpath);
+    } else {
+        VisMF::Write(dmf,mf_fullpath,how);
+    }
 }
 
 void
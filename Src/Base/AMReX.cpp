@@ -41,6 +41,8 @@
 #include <AMReX_iMultiFab.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_AsyncOut.H>
+#include <AMReX_DeferredReduce.H>
+#include <AMReX_TileSizeTuner.H>
 #endif
 
 #ifdef BL_LAZY
@@ -502,6 +504,7 @@ amrex::Initialize (int& argc, char**& argv, bool build_parm_parse,
     FArrayBox::Initialize();
     IArrayBox::Initialize();
     FabArrayBase::Initialize();
+    TileSizeTuner::Initialize();
     MultiFab::Initialize();
     iMultiFab::Initialize();
     VisMF::Initialize();
@@ -593,6 +596,10 @@ amrex::Finalize (amrex::AMReX* pamrex)
     Lazy::Finalize();
 #endif
 
+#ifndef BL_AMRPROF
+    DeferredReduce::Finalize();
+#endif
+
     while (!The_Finalize_Function_Stack.empty())
     {
         //
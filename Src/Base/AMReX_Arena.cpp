@@ -11,6 +11,9 @@
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Gpu.H>
+#ifdef AMREX_TINY_PROFILING
+#include <AMReX_TinyProfiler.H>
+#endif
 
 #ifdef _WIN32
 ///#include <memoryapi.h>
@@ -236,6 +239,10 @@ Arena::Initialize ()
     the_pinned_arena_release_threshold = Gpu::Device::totalGlobalMem();
 #endif
 
+#ifdef AMREX_TINY_PROFILING
+    TinyProfiler::InitializeMemory();
+#endif
+
     ParmParse pp("amrex");
     pp.query("use_buddy_allocator", use_buddy_allocator);
     pp.query("buddy_allocator_size", buddy_allocator_size);
@@ -1,14 +1,42 @@
 #include <AMReX_BArena.H>
+#ifdef AMREX_TINY_PROFILING
+#include <AMReX_TinyProfiler.H>
+#endif
+
+amrex::BArena::BArena ()
+#ifdef AMREX_TINY_PROFILING
+    : m_count_memory(TinyProfiler::MemoryProfiling())
+#endif
+{}
 
 void*
 amrex::BArena::alloc (std::size_t sz_)
 {
+#ifdef AMREX_TINY_PROFILING
+    if (m_count_memory) {
+        // Keep the size in front of the block so that free can count it.
+        char* p = static_cast<char*>(std::malloc(sz_ + align_size));
+        if (p == nullptr) return nullptr;
+        *reinterpret_cast<std::size_t*>(p) = sz_;
+        TinyProfiler::MemoryAlloc(sz_);
+        return p + align_size;
+    }
+#endif
     return std::malloc(sz_);
 }
 
 void
 amrex::BArena::free (void* pt)
 {
+#ifdef AMREX_TINY_PROFILING
+    if (m_count_memory) {
+        if (pt == nullptr) return;
+        char* p = static_cast<char*>(pt) - align_size;
+        TinyProfiler::MemoryFree(*reinterpret_cast<std::size_t*>(p));
+        std::free(p);
+        return;
+    }
+#endif
     std::free(pt);
 }
 
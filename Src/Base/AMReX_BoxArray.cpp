@@ -5,6 +5,7 @@
 #include <AMReX_Utility.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_BaseFab.H>
+#include <AMReX_ParmParse.H>
 
 #ifdef AMREX_MEM_PROFILING
 #include <AMReX_MemProfiler.H>
@@ -12,7 +13,10 @@
 
 #include <AMReX_OpenMP.H>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <numeric>
 
 namespace amrex {
 
@@ -30,6 +34,8 @@ bool BoxArray::initialized = false;
 
 namespace {
     const int bl_ignore_max = 100000;
+    BoxArray::IndexPolicy s_index_policy = BoxArray::IndexPolicy::Auto;
+    int s_bins_threshold = 4096;
 }
 
 BARef::BARef ()
@@ -182,11 +188,28 @@ BARef::resize (Long n) {
     m_abox.resize(n);
     hash.clear();
     has_hashmap = false;
+    bin_offset.clear();
+    bin_ids.clear();
+    index_kind = -1;
 #ifdef AMREX_MEM_PROFILING
     updateMemoryUsage_box(1);
 #endif
 }
 
+Long
+BARef::indexBytes () const
+{
+    Long b = 0;
+    if (hash.size() > 0 || bin_offset.size() > 0) {
+        b = sizeof(hash) + amrex::bytesOf(bin_offset) + amrex::bytesOf(bin_ids);
+        for (const auto& x: hash) {
+            b += amrex::gcc_map_node_extra_bytes
+                + sizeof(IntVect) + amrex::bytesOf(x.second);
+        }
+    }
+    return b;
+}
+
 #ifdef AMREX_MEM_PROFILING
 void
 BARef::updateMemoryUsage_box (int s)
@@ -208,12 +231,8 @@ BARef::updateMemoryUsage_box (int s)
 void
 BARef::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
-        Long b = sizeof(hash);
-        for (const auto& x: hash) {
-            b += amrex::gcc_map_node_extra_bytes
-                + sizeof(IntVect) + amrex::bytesOf(x.second);
-        }
+    if (hash.size() > 0 || bin_offset.size() > 0) {
+        Long b = indexBytes();
         if (s > 0) {
             total_hash_bytes += b;
             total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -260,11 +279,44 @@ BoxArray::Initialize ()
     if (!initialized) {
         initialized = true;
         BARef::Initialize();
+
+        ParmParse pp("amrex");
+        std::string policy;
+        if (pp.query("boxarray_index", policy)) {
+            if (policy == "auto") {
+                s_index_policy = IndexPolicy::Auto;
+            } else if (policy == "hash") {
+                s_index_policy = IndexPolicy::Hash;
+            } else if (policy == "bins") {
+                s_index_policy = IndexPolicy::Bins;
+            } else {
+                amrex::Abort("amrex.boxarray_index must be auto, hash or bins");
+            }
+        }
+        pp.query("boxarray_bins_threshold", s_bins_threshold);
     }
 
     amrex::ExecOnFinalize(BoxArray::Finalize);
 }
 
+void
+BoxArray::SetIndexPolicy (IndexPolicy policy) noexcept
+{
+    s_index_policy = policy;
+}
+
+BoxArray::IndexPolicy
+BoxArray::GetIndexPolicy () noexcept
+{
+    return s_index_policy;
+}
+
+void
+BoxArray::SetBinsThreshold (int nboxes) noexcept
+{
+    s_bins_threshold = nboxes;
+}
+
 void
 BoxArray::Finalize ()
 {
@@ -1185,10 +1237,64 @@ BoxArray::intersections (const Box&                         bx,
 {
     // This is called too many times BL_PROFILE("BoxArray::intersections()");
 
-    BARef::HashType& BoxHashMap = getHashMap();
-
     isects.resize(0);
 
+    if (empty()) return;
+
+    if (useBinIndex())
+    {
+        BL_ASSERT(bx.ixType() == ixType());
+
+        Box gbx = amrex::grow(bx,ng);
+
+        IntVect glo = gbx.smallEnd();
+        IntVect ghi = gbx.bigEnd();
+        const IntVect& doilo = getDoiLo();
+        const IntVect& doihi = getDoiHi();
+
+        gbx.setSmall(glo - doihi).setBig(ghi + doilo);
+        gbx.refine(crseRatio());
+
+        const Box& bin_box = m_ref->bin_box;
+        Box cbx = amrex::coarsen(Box(gbx.smallEnd(),gbx.bigEnd()),m_ref->bin_size) & bin_box;
+        if (!cbx.ok()) return;
+
+        const IntVect& bin_size = m_ref->bin_size;
+        const int* offset = m_ref->bin_offset.data();
+        const int* ids = m_ref->bin_ids.data();
+        auto& abox = m_ref->m_abox;
+        IndexType t = ixType();
+        IntVect cr = crseRatio();
+
+        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+        {
+            const Long ibin = bin_box.index(iv);
+            for (int n = offset[ibin]; n < offset[ibin+1]; ++n)
+            {
+                const int index = ids[n];
+                // Boxes are in every bin they overlap.  Only look at them in
+                // the first of those bins that the query covers.
+                if (amrex::max(cbx.smallEnd(), amrex::coarsen(abox[index].smallEnd(),bin_size)) != iv) {
+                    continue;
+                }
+
+                const Box& ibox = m_bat.is_null() ? abox[index]
+                    : (m_bat.is_simple() ? amrex::convert(amrex::coarsen(abox[index],cr),t)
+                                         : m_bat.m_op.m_bndryReg(abox[index]));
+                const Box& isect = bx & amrex::grow(ibox,ng);
+
+                if (isect.ok())
+                {
+                    isects.push_back(std::pair<int,Box>(index,isect));
+                    if (first_only) return;
+                }
+            }
+        }
+        return;
+    }
+
+    BARef::HashType& BoxHashMap = getHashMap();
+
     if (!BoxHashMap.empty())
     {
         BL_ASSERT(bx.ixType() == ixType());
@@ -1282,6 +1388,64 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
 
     if (empty()) return;
 
+    if (useBinIndex())
+    {
+        BL_ASSERT(bx.ixType() == ixType());
+
+        Box gbx = bx;
+
+        IntVect glo = gbx.smallEnd();
+        IntVect ghi = gbx.bigEnd();
+        const IntVect& doilo = getDoiLo();
+        const IntVect& doihi = getDoiHi();
+
+        gbx.setSmall(glo - doihi).setBig(ghi + doilo);
+        gbx.refine(crseRatio());
+
+        const Box& bin_box = m_ref->bin_box;
+        Box cbx = amrex::coarsen(Box(gbx.smallEnd(),gbx.bigEnd()),m_ref->bin_size) & bin_box;
+        if (!cbx.ok()) return;
+
+        const IntVect& bin_size = m_ref->bin_size;
+        const int* offset = m_ref->bin_offset.data();
+        const int* ids = m_ref->bin_ids.data();
+        auto& abox = m_ref->m_abox;
+        IndexType t = ixType();
+        IntVect cr = crseRatio();
+
+        Vector<Box> intersect_boxes;
+        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+        {
+            const Long ibin = bin_box.index(iv);
+            for (int n = offset[ibin]; n < offset[ibin+1]; ++n)
+            {
+                const int index = ids[n];
+                if (amrex::max(cbx.smallEnd(), amrex::coarsen(abox[index].smallEnd(),bin_size)) != iv) {
+                    continue;
+                }
+                const Box& ibox = m_bat.is_null() ? abox[index]
+                    : (m_bat.is_simple() ? amrex::convert(amrex::coarsen(abox[index],cr),t)
+                                         : m_bat.m_op.m_bndryReg(abox[index]));
+                if (bx.intersects(ibox)) {
+                    intersect_boxes.push_back(ibox);
+                }
+            }
+        }
+
+        BoxList newbl(bl.ixType());
+        BoxList newdiff(bl.ixType());
+        for  (auto const& ibox : intersect_boxes) {
+            newbl.clear();
+            for (Box const& b : bl) {
+                amrex::boxDiff(newdiff, b, ibox);
+                newbl.join(newdiff);
+            }
+            bl.swap(newbl);
+            if (bl.isEmpty()) { return; }
+        }
+        return;
+    }
+
     BARef::HashType& BoxHashMap = getHashMap();
 
     BL_ASSERT(bx.ixType() == ixType());
@@ -1364,17 +1528,26 @@ BoxArray::complementIn (BoxList& bl, const Box& bx) const
     }
 }
 
+Long
+BoxArray::indexBytes () const
+{
+    return m_ref->indexBytes();
+}
+
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (!m_ref->hash.empty() || !m_ref->bin_offset.empty())
     {
 #ifdef AMREX_MEM_PROFILING
         m_ref->updateMemoryUsage_hash(-1);
 #endif
         m_ref->hash.clear();
         m_ref->has_hashmap = false;
+        m_ref->bin_offset.clear();
+        m_ref->bin_ids.clear();
     }
+    m_ref->index_kind = -1;
 }
 
 //
@@ -1393,6 +1566,9 @@ BoxArray::removeOverlap (bool simplify)
 
     uniqify();
 
+    // Boxes are added to the hash as we go, so we need it rather than the bins.
+    m_ref->index_kind = 0;
+
     BARef::HashType& BoxHashMap = m_ref->hash;
 
     const Box EmptyBox;
@@ -1541,6 +1717,124 @@ BoxArray::getHashMap () const
     return BoxHashMap;
 }
 
+bool
+BoxArray::useBinIndex () const
+{
+    int kind;
+#ifdef AMREX_USE_OMP
+#pragma omp atomic read
+#endif
+    kind = m_ref->index_kind;
+
+    if (kind < 0)
+    {
+#ifdef AMREX_USE_OMP
+#pragma omp critical(intersections_lock)
+#endif
+        {
+            if (m_ref->index_kind < 0) {
+                if (s_index_policy == IndexPolicy::Hash || size() == 0 ||
+                    (s_index_policy == IndexPolicy::Auto && size() < s_bins_threshold)) {
+                    m_ref->index_kind = 0;
+                } else {
+                    buildBinIndex();
+                }
+            }
+#ifdef AMREX_USE_OMP
+#pragma omp flush
+#endif
+            kind = m_ref->index_kind;
+        }
+    }
+
+    return kind == 1;
+}
+
+void
+BoxArray::buildBinIndex () const
+{
+    const auto& abox = m_ref->m_abox;
+    const int N = size();
+
+    //
+    // Start with bins the size of the median box, and make them larger
+    // until the boxes are listed in at most 8 bins each on average.  The
+    // bins cover the index range of the boxes regardless of their type.
+    //
+    auto cell_range = [&abox] (int i) { return Box(abox[i].smallEnd(), abox[i].bigEnd()); };
+
+    IntVect bin_size;
+    Box boundingbox = cell_range(0);
+    {
+        Vector<int> ext(N);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            for (int i = 0; i < N; ++i) {
+                ext[i] = amrex::max(abox[i].length(idim), 1);
+            }
+            std::nth_element(ext.begin(), ext.begin()+N/2, ext.end());
+            bin_size[idim] = ext[N/2];
+        }
+        for (int i = 1; i < N; ++i) {
+            boundingbox.minBox(cell_range(i));
+        }
+    }
+
+    Long nentries;
+    for (;;) {
+        nentries = 0;
+        for (int i = 0; i < N; ++i) {
+            const Box& cbx = amrex::coarsen(cell_range(i),bin_size);
+            if (cbx.ok()) { nentries += cbx.numPts(); }
+        }
+        if (nentries <= 8*Long(N)) break;
+        bin_size *= 2;
+    }
+
+    const Box& bin_box = amrex::coarsen(boundingbox,bin_size);
+    const Long nbins = bin_box.numPts();
+
+    // Too sparse for a dense grid of bins.  Use the hash.
+    if (s_index_policy == IndexPolicy::Auto && nbins > 8*Long(N) + 4096) {
+        m_ref->index_kind = 0;
+        return;
+    }
+
+    AMREX_ALWAYS_ASSERT(nbins < Long(std::numeric_limits<int>::max()) &&
+                        nentries < Long(std::numeric_limits<int>::max()));
+
+    Vector<int>& offset = m_ref->bin_offset;
+    Vector<int>& ids = m_ref->bin_ids;
+    offset.assign(nbins+1, 0);
+    ids.resize(nentries);
+
+    for (int i = 0; i < N; ++i) {
+        const Box& cbx = amrex::coarsen(cell_range(i),bin_size);
+        if (!cbx.ok()) continue;
+        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv)) {
+            ++offset[bin_box.index(iv)+1];
+        }
+    }
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    Vector<int> pos(offset.begin(), offset.end()-1);
+    for (int i = 0; i < N; ++i) {
+        const Box& cbx = amrex::coarsen(cell_range(i),bin_size);
+        if (!cbx.ok()) continue;
+        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv)) {
+            ids[pos[bin_box.index(iv)]++] = i;
+        }
+    }
+
+    m_ref->bin_size = bin_size;
+    m_ref->bin_box = bin_box;
+
+#ifdef AMREX_MEM_PROFILING
+    m_ref->updateMemoryUsage_hash(1);
+#endif
+
+    m_ref->index_kind = 1;
+}
+
 void
 BoxArray::uniqify ()
 {
@@ -3,6 +3,9 @@
 #include <AMReX_BLassert.H>
 #include <AMReX_Gpu.H>
 #include <AMReX_ParallelReduce.H>
+#ifdef AMREX_TINY_PROFILING
+#include <AMReX_TinyProfiler.H>
+#endif
 
 #include <utility>
 #include <cstring>
@@ -107,6 +110,10 @@ CArena::alloc (std::size_t nbytes)
 
     m_actually_used += nbytes;
 
+#ifdef AMREX_TINY_PROFILING
+    TinyProfiler::MemoryAlloc(nbytes);
+#endif
+
     BL_ASSERT(!(vp == 0));
 
     return vp;
@@ -136,6 +143,10 @@ CArena::free (void* vp)
 
     m_actually_used -= busy_it->size();
 
+#ifdef AMREX_TINY_PROFILING
+    TinyProfiler::MemoryFree(busy_it->size());
+#endif
+
     //
     // Put free'd block on free list and save iterator to insert()ed position.
     //
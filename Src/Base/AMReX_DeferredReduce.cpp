@@ -0,0 +1,164 @@
+
+#include <AMReX_DeferredReduce.H>
+#include <AMReX_BLProfiler.H>
+
+#include <algorithm>
+
+namespace amrex {
+namespace DeferredReduce {
+
+namespace {
+    // Batches still accepting values.
+    std::vector<std::shared_ptr<detail::Batch> > pending;
+    // Batches started but possibly not finished.
+    std::vector<std::weak_ptr<detail::Batch> > inflight;
+    Long num_started = 0;
+
+#ifdef BL_USE_MPI
+    MPI_Op mpiOp (detail::Op op)
+    {
+        switch (op) {
+        case detail::Op::sum: return MPI_SUM;
+        case detail::Op::min: return MPI_MIN;
+        default:              return MPI_MAX;
+        }
+    }
+#endif
+}
+
+namespace detail {
+
+Batch::~Batch ()
+{
+    if (started && !finished) {
+        wait();
+    }
+}
+
+void
+Batch::start ()
+{
+    if (started) return;
+    started = true;
+    ++num_started;
+
+    recvbuf.resize(sendbuf.size());
+#ifdef BL_USE_MPI
+    const int count = static_cast<int>(sendbuf.size()) / type_size;
+#if (MPI_VERSION >= 3)
+    BL_MPI_REQUIRE( MPI_Iallreduce(sendbuf.data(), recvbuf.data(), count, type,
+                                   mpiOp(op), comm, &req) );
+#else
+    BL_MPI_REQUIRE( MPI_Allreduce(sendbuf.data(), recvbuf.data(), count, type,
+                                  mpiOp(op), comm) );
+    finished = true;
+#endif
+#else
+    std::copy(sendbuf.begin(), sendbuf.end(), recvbuf.begin());
+    finished = true;
+#endif
+}
+
+void
+Batch::wait ()
+{
+    if (finished) return;
+    if (!started) {
+        DeferredReduce::Flush();
+    }
+#ifdef BL_USE_MPI
+    if (!finished) {
+        BL_PROFILE("DeferredReduce::wait()");
+        BL_MPI_REQUIRE( MPI_Wait(&req, MPI_STATUS_IGNORE) );
+    }
+#endif
+    finished = true;
+}
+
+bool
+Batch::test ()
+{
+#ifdef BL_USE_MPI
+    if (started && !finished) {
+        int flag = 0;
+        BL_MPI_REQUIRE( MPI_Test(&req, &flag, MPI_STATUS_IGNORE) );
+        finished = (flag != 0);
+    }
+#endif
+    return finished;
+}
+
+std::shared_ptr<Batch>
+add (Op op, MPI_Datatype type, int type_size, MPI_Comm comm, void const* v, int n, int& pos)
+{
+    auto it = std::find_if(pending.begin(), pending.end(),
+                           [&] (std::shared_ptr<Batch> const& b)
+                           { return b->op == op && b->type == type && b->comm == comm; });
+    if (it == pending.end()) {
+        pending.push_back(std::make_shared<Batch>(op, type, type_size, comm));
+        it = pending.end()-1;
+    }
+
+    Batch& b = **it;
+    AMREX_ASSERT(b.type_size == type_size);
+    pos = static_cast<int>(b.sendbuf.size()) / type_size;
+    const char* p = static_cast<char const*>(v);
+    b.sendbuf.insert(b.sendbuf.end(), p, p + std::size_t(n)*type_size);
+    return *it;
+}
+
+}
+
+void
+Flush ()
+{
+    if (pending.empty()) return;
+
+    BL_PROFILE("DeferredReduce::Flush()");
+
+    // Batches are created in the same order on every process, so the
+    // collectives are started in the same order too.
+    for (auto& b : pending) {
+        b->start();
+        if (!b->finished) {
+            inflight.push_back(b);
+        }
+    }
+    pending.clear();
+
+    inflight.erase(std::remove_if(inflight.begin(), inflight.end(),
+                                  [] (std::weak_ptr<detail::Batch> const& w)
+                                  { auto b = w.lock(); return !b || b->finished; }),
+                   inflight.end());
+}
+
+int
+NumPending ()
+{
+    int n = 0;
+    for (auto const& b : pending) {
+        n += static_cast<int>(b->sendbuf.size()) / b->type_size;
+    }
+    return n;
+}
+
+Long
+NumStarted ()
+{
+    return num_started;
+}
+
+void
+Finalize ()
+{
+    Flush();
+    for (auto& w : inflight) {
+        if (auto b = w.lock()) {
+            b->wait();
+        }
+    }
+    inflight.clear();
+}
+
+}
+}
@@ -0,0 +1,491 @@
+
+#include <AMReX_DistributedLayout.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace amrex {
+
+namespace {
+
+    // Box covering the indices of bx, whatever its type.
+    Box indexRange (const Box& bx) noexcept
+    {
+        return Box(bx.smallEnd(), bx.bigEnd());
+    }
+
+    void packBox (Vector<int>& buf, const Box& bx)
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) { buf.push_back(bx.smallEnd(idim)); }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) { buf.push_back(bx.bigEnd(idim)); }
+    }
+
+    Box unpackBox (const int*& p, IndexType typ)
+    {
+        IntVect lo(p), hi(p+AMREX_SPACEDIM);
+        p += 2*AMREX_SPACEDIM;
+        return Box(lo, hi, typ);
+    }
+
+    void packIntVect (Vector<int>& buf, const IntVect& iv)
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) { buf.push_back(iv[idim]); }
+    }
+
+    IntVect unpackIntVect (const int*& p)
+    {
+        IntVect iv(p);
+        p += AMREX_SPACEDIM;
+        return iv;
+    }
+
+    // Send send[i] to process i and return what every process sent to us.
+    Vector<Vector<int> > exchange (const Vector<Vector<int> >& send)
+    {
+#ifdef BL_USE_MPI
+        const int nprocs = ParallelDescriptor::NProcs();
+        MPI_Comm comm = ParallelDescriptor::Communicator();
+
+        Vector<int> scnt(nprocs), rcnt(nprocs), sdsp(nprocs+1,0), rdsp(nprocs+1,0);
+        for (int i = 0; i < nprocs; ++i) {
+            scnt[i] = static_cast<int>(send[i].size());
+        }
+        BL_MPI_REQUIRE( MPI_Alltoall(scnt.data(), 1, MPI_INT, rcnt.data(), 1, MPI_INT, comm) );
+        for (int i = 0; i < nprocs; ++i) {
+            sdsp[i+1] = sdsp[i] + scnt[i];
+            rdsp[i+1] = rdsp[i] + rcnt[i];
+        }
+
+        Vector<int> sbuf(sdsp[nprocs]), rbuf(rdsp[nprocs]);
+        for (int i = 0; i < nprocs; ++i) {
+            std::copy(send[i].begin(), send[i].end(), sbuf.begin()+sdsp[i]);
+        }
+        BL_MPI_REQUIRE( MPI_Alltoallv(sbuf.data(), scnt.data(), sdsp.data(), MPI_INT,
+                                      rbuf.data(), rcnt.data(), rdsp.data(), MPI_INT, comm) );
+
+        Vector<Vector<int> > recv(nprocs);
+        for (int i = 0; i < nprocs; ++i) {
+            recv[i].assign(rbuf.begin()+rdsp[i], rbuf.begin()+rdsp[i+1]);
+        }
+        return recv;
+#else
+        return send;
+#endif
+    }
+}
+
+DistributedLayout::DistributedLayout (const BoxList& local_boxes, const Box& domain,
+                                      const IntVect& halo, const Periodicity& period,
+                                      const IntVect& bin_size)
+{
+    define(local_boxes, domain, halo, period, bin_size);
+}
+
+DistributedLayout::DistributedLayout (const BoxArray& ba, const DistributionMapping& dm,
+                                      const Box& domain, const IntVect& halo,
+                                      const Periodicity& period, const IntVect& bin_size)
+{
+    define(ba, dm, domain, halo, period, bin_size);
+}
+
+void
+DistributedLayout::define (const BoxList& local_boxes, const Box& domain, const IntVect& halo,
+                           const Periodicity& period, const IntVect& bin_size)
+{
+    BL_PROFILE("DistributedLayout::define()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    Vector<int> counts(nprocs, 0);
+    counts[myproc] = local_boxes.size();
+#ifdef BL_USE_MPI
+    BL_MPI_REQUIRE( MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, counts.data(), 1, MPI_INT,
+                                  ParallelDescriptor::Communicator()) );
+#endif
+
+    Long offset = 0;
+    m_nglobal = 0;
+    for (int i = 0; i < nprocs; ++i) {
+        if (i == myproc) { offset = m_nglobal; }
+        m_nglobal += counts[i];
+    }
+    AMREX_ALWAYS_ASSERT(m_nglobal < Long(std::numeric_limits<int>::max()));
+
+    m_ixtype = local_boxes.ixType();
+    m_local.clear();
+    m_local.reserve(local_boxes.size());
+    int index = static_cast<int>(offset);
+    for (const Box& bx : local_boxes) {
+        m_local.push_back(Entry{bx, IntVect(0), index++, myproc});
+    }
+
+    m_domain = domain;
+    m_halo_size = halo;
+    m_period = period;
+    m_bin_size = bin_size;
+
+    buildDirectory();
+    findNeighbors();
+}
+
+void
+DistributedLayout::define (const BoxArray& ba, const DistributionMapping& dm,
+                           const Box& domain, const IntVect& halo,
+                           const Periodicity& period, const IntVect& bin_size)
+{
+    BL_PROFILE("DistributedLayout::define()");
+
+    const int myproc = ParallelDescriptor::MyProc();
+
+    m_nglobal = ba.size();
+    m_ixtype = ba.ixType();
+    m_local.clear();
+    for (int i = 0, N = ba.size(); i < N; ++i) {
+        if (dm[i] == myproc) {
+            m_local.push_back(Entry{ba[i], IntVect(0), i, myproc});
+        }
+    }
+
+    m_domain = domain;
+    m_halo_size = halo;
+    m_period = period;
+    m_bin_size = bin_size;
+
+    buildDirectory();
+    findNeighbors();
+}
+
+Box
+DistributedLayout::binRange (const Box& bx) const noexcept
+{
+    return amrex::coarsen(indexRange(bx), m_bin_size) & m_bin_box;
+}
+
+int
+DistributedLayout::binOwner (Long ibin) const noexcept
+{
+    return static_cast<int>((ibin * ParallelDescriptor::NProcs()) / m_nbins);
+}
+
+void
+DistributedLayout::buildDirectory ()
+{
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    if (m_bin_size == IntVect(0))
+    {
+        m_bin_size = IntVect(1);
+        for (const auto& e : m_local) {
+            m_bin_size.max(indexRange(e.box).length());
+        }
+        ParallelDescriptor::ReduceIntMax(m_bin_size.getVect(), AMREX_SPACEDIM);
+        m_bin_size *= 2;
+    }
+
+    // One more index on the high side so that nodal boxes are covered too.
+    Box dom = indexRange(m_domain);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        dom.growHi(idim,1);
+    }
+    m_bin_box = amrex::coarsen(dom, m_bin_size);
+    m_nbins = m_bin_box.numPts();
+
+    // Bins b with binOwner(b) == myproc
+    m_bin_begin = (Long(myproc) * m_nbins + nprocs - 1) / nprocs;
+    m_bin_end = (Long(myproc+1) * m_nbins + nprocs - 1) / nprocs;
+
+    //
+    // Send each local box to the owners of the bins it overlaps.
+    //
+    Vector<Vector<int> > send(nprocs);
+    Vector<int> owners;
+    for (const auto& e : m_local)
+    {
+        const Box& cb = binRange(e.box);
+        if (!cb.ok()) continue;
+        owners.clear();
+        for (IntVect iv = cb.smallEnd(), End = cb.bigEnd(); iv <= End; cb.next(iv)) {
+            owners.push_back(binOwner(m_bin_box.index(iv)));
+        }
+        std::sort(owners.begin(), owners.end());
+        owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+        for (int p : owners) {
+            packBox(send[p], e.box);
+            send[p].push_back(e.index);
+            send[p].push_back(e.owner);
+        }
+    }
+
+    Vector<Vector<int> > recv = exchange(send);
+
+    m_dir_entries.clear();
+    for (int p = 0; p < nprocs; ++p) {
+        const int* q = recv[p].data();
+        const int* qend = q + recv[p].size();
+        while (q < qend) {
+            Box bx = unpackBox(q, m_ixtype);
+            int index = *q++;
+            int owner = *q++;
+            m_dir_entries.push_back(Entry{bx, IntVect(0), index, owner});
+        }
+    }
+
+    //
+    // Bin the entries we received over the bins we own.
+    //
+    const Long nmybins = m_bin_end - m_bin_begin;
+    m_dir_offset.assign(nmybins+1, 0);
+    for (int n = 0, N = m_dir_entries.size(); n < N; ++n) {
+        const Box& cb = binRange(m_dir_entries[n].box);
+        if (!cb.ok()) continue;
+        for (IntVect iv = cb.smallEnd(), End = cb.bigEnd(); iv <= End; cb.next(iv)) {
+            const Long ibin = m_bin_box.index(iv);
+            if (ibin >= m_bin_begin && ibin < m_bin_end) {
+                ++m_dir_offset[ibin-m_bin_begin+1];
+            }
+        }
+    }
+    std::partial_sum(m_dir_offset.begin(), m_dir_offset.end(), m_dir_offset.begin());
+
+    m_dir_ids.resize(m_dir_offset[nmybins]);
+    Vector<int> pos(m_dir_offset.begin(), m_dir_offset.end()-1);
+    for (int n = 0, N = m_dir_entries.size(); n < N; ++n) {
+        const Box& cb = binRange(m_dir_entries[n].box);
+        if (!cb.ok()) continue;
+        for (IntVect iv = cb.smallEnd(), End = cb.bigEnd(); iv <= End; cb.next(iv)) {
+            const Long ibin = m_bin_box.index(iv);
+            if (ibin >= m_bin_begin && ibin < m_bin_end) {
+                m_dir_ids[pos[ibin-m_bin_begin]++] = n;
+            }
+        }
+    }
+}
+
+Vector<Vector<DistributedLayout::Entry> >
+DistributedLayout::query (const Vector<Box>& regions) const
+{
+    BL_PROFILE("DistributedLayout::query()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    const std::vector<IntVect> shifts = m_period.shiftIntVect();
+
+    //
+    // Ask the owners of the bins under each region, for each periodic
+    // image, for the boxes there.
+    //
+    Vector<Vector<int> > send(nprocs);
+    Vector<int> owners;
+    for (int k = 0, N = regions.size(); k < N; ++k)
+    {
+        for (const auto& t : shifts)
+        {
+            // The boxes whose image shifted by t meets the region.
+            const Box& piece = amrex::shift(indexRange(regions[k]), -t);
+            const Box& cb = binRange(piece);
+            if (!cb.ok()) continue;
+            owners.clear();
+            for (IntVect iv = cb.smallEnd(), End = cb.bigEnd(); iv <= End; cb.next(iv)) {
+                owners.push_back(binOwner(m_bin_box.index(iv)));
+            }
+            std::sort(owners.begin(), owners.end());
+            owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+            for (int p : owners) {
+                send[p].push_back(k);
+                packIntVect(send[p], t);
+                packBox(send[p], piece);
+            }
+        }
+    }
+
+    Vector<Vector<int> > requests = exchange(send);
+
+    //
+    // Answer the requests from the part of the directory we own.
+    //
+    Vector<Vector<int> > reply(nprocs);
+    Vector<int> found;
+    for (int p = 0; p < nprocs; ++p)
+    {
+        const int* q = requests[p].data();
+        const int* qend = q + requests[p].size();
+        while (q < qend)
+        {
+            const int k = *q++;
+            const IntVect t = unpackIntVect(q);
+            const Box piece = unpackBox(q, IndexType::TheCellType());
+            const Box& cb = binRange(piece);
+
+            found.clear();
+            for (IntVect iv = cb.smallEnd(), End = cb.bigEnd(); iv <= End; cb.next(iv)) {
+                const Long ibin = m_bin_box.index(iv);
+                if (ibin < m_bin_begin || ibin >= m_bin_end) continue;
+                const Long b = ibin - m_bin_begin;
+                for (int n = m_dir_offset[b]; n < m_dir_offset[b+1]; ++n) {
+                    const int id = m_dir_ids[n];
+                    if (indexRange(m_dir_entries[id].box).intersects(piece)) {
+                        found.push_back(id);
+                    }
+                }
+            }
+            std::sort(found.begin(), found.end());
+            found.erase(std::unique(found.begin(), found.end()), found.end());
+
+            for (int id : found) {
+                const Entry& e = m_dir_entries[id];
+                reply[p].push_back(k);
+                packIntVect(reply[p], t);
+                packBox(reply[p], e.box);
+                reply[p].push_back(e.index);
+                reply[p].push_back(e.owner);
+            }
+        }
+    }
+
+    Vector<Vector<int> > answers = exchange(reply);
+
+    Vector<Vector<Entry> > r(regions.size());
+    for (int p = 0; p < nprocs; ++p)
+    {
+        const int* q = answers[p].data();
+        const int* qend = q + answers[p].size();
+        while (q < qend) {
+            const int k = *q++;
+            const IntVect t = unpackIntVect(q);
+            const Box bx = unpackBox(q, m_ixtype);
+            const int index = *q++;
+            const int owner = *q++;
+            r[k].push_back(Entry{bx, t, index, owner});
+        }
+    }
+
+    // A box spanning bins owned by several processes is found by each of them.
+    for (auto& v : r) {
+        std::sort(v.begin(), v.end(), [] (const Entry& a, const Entry& b)
+                  { return (a.index < b.index) || (a.index == b.index && a.shift < b.shift); });
+        v.erase(std::unique(v.begin(), v.end(), [] (const Entry& a, const Entry& b)
+                            { return a.index == b.index && a.shift == b.shift; }),
+                v.end());
+    }
+
+    return r;
+}
+
+void
+DistributedLayout::findNeighbors ()
+{
+    const int myproc = ParallelDescriptor::MyProc();
+
+    Vector<Box> regions;
+    regions.reserve(m_local.size());
+    for (const auto& e : m_local) {
+        regions.push_back(amrex::grow(e.box, m_halo_size));
+    }
+
+    m_neighbors = query(regions);
+    m_halo.clear();
+
+    for (int i = 0, N = m_local.size(); i < N; ++i)
+    {
+        auto& nbrs = m_neighbors[i];
+        const int self = m_local[i].index;
+        nbrs.erase(std::remove_if(nbrs.begin(), nbrs.end(), [self] (const Entry& e)
+                                  { return e.index == self && e.shift == IntVect(0); }),
+                   nbrs.end());
+        for (const auto& e : nbrs) {
+            if (e.owner != myproc) {
+                m_halo.push_back(Entry{e.box, IntVect(0), e.index, e.owner});
+            }
+        }
+    }
+
+    std::sort(m_halo.begin(), m_halo.end(), [] (const Entry& a, const Entry& b)
+              { return a.index < b.index; });
+    m_halo.erase(std::unique(m_halo.begin(), m_halo.end(), [] (const Entry& a, const Entry& b)
+                             { return a.index == b.index; }),
+                 m_halo.end());
+}
+
+int
+DistributedLayout::localIndex (int global_index) const noexcept
+{
+    auto it = std::lower_bound(m_local.begin(), m_local.end(), global_index,
+                               [] (const Entry& e, int idx) { return e.index < idx; });
+    return (it != m_local.end() && it->index == global_index)
+        ? static_cast<int>(it - m_local.begin()) : -1;
+}
+
+void
+DistributedLayout::fillBoundaryTags (const IntVect& nghost,
+                                     FabArrayBase::CopyComTagsContainer& loc_tags,
+                                     FabArrayBase::MapOfCopyComTagContainers& snd_tags,
+                                     FabArrayBase::MapOfCopyComTagContainers& rcv_tags) const
+{
+    BL_PROFILE("DistributedLayout::fillBoundaryTags()");
+
+    AMREX_ALWAYS_ASSERT(nghost.allLE(m_halo_size));
+
+    const int myproc = ParallelDescriptor::MyProc();
+
+    loc_tags.clear();
+    snd_tags.clear();
+    rcv_tags.clear();
+
+    for (int i = 0, N = m_local.size(); i < N; ++i)
+    {
+        const Box& lbx = m_local[i].box;
+        const int lidx = m_local[i].index;
+        const Box& gbx = amrex::grow(lbx, nghost);
+
+        for (const auto& e : m_neighbors[i])
+        {
+            // Our ghost cells filled from the neighbor's image.
+            const Box& rbx = gbx & amrex::shift(e.box, e.shift);
+            if (rbx.ok()) {
+                for (const Box& dbx : amrex::boxDiff(rbx, lbx)) {
+                    FabArrayBase::CopyComTag tag(dbx, amrex::shift(dbx, -e.shift), lidx, e.index);
+                    if (e.owner == myproc) {
+                        loc_tags.push_back(tag);
+                    } else {
+                        rcv_tags[e.owner].push_back(tag);
+                    }
+                }
+            }
+
+            // The neighbor's ghost cells filled from our image.  Halos are
+            // symmetric, so every remote box that needs our data is here.
+            const Box& sbx = amrex::grow(e.box, nghost) & amrex::shift(lbx, -e.shift);
+            if (e.owner != myproc && sbx.ok())
+            {
+                for (const Box& dbx : amrex::boxDiff(sbx, e.box)) {
+                    snd_tags[e.owner].push_back(
+                        FabArrayBase::CopyComTag(dbx, amrex::shift(dbx, e.shift), e.index, lidx));
+                }
+            }
+        }
+    }
+
+    std::sort(loc_tags.begin(), loc_tags.end());
+    for (auto& kv : snd_tags) { std::sort(kv.second.begin(), kv.second.end()); }
+    for (auto& kv : rcv_tags) { std::sort(kv.second.begin(), kv.second.end()); }
+}
+
+Long
+DistributedLayout::bytes () const
+{
+    Long cnt = sizeof(DistributedLayout)
+        + amrex::bytesOf(m_local) + amrex::bytesOf(m_halo)
+        + amrex::bytesOf(m_dir_entries) + amrex::bytesOf(m_dir_offset) + amrex::bytesOf(m_dir_ids);
+    for (const auto& v : m_neighbors) {
+        cnt += amrex::bytesOf(v);
+    }
+    return cnt;
+}
+
+}
@@ -37,6 +37,7 @@ namespace amrex {
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    DistributionMapping::SFCCurve sfc_curve = DistributionMapping::SFCCurve::Morton;
 
 // We default to SFC.
 DistributionMapping::Strategy DistributionMapping::m_Strategy = DistributionMapping::SFC;
@@ -91,6 +92,18 @@ DistributionMapping::SFC_Threshold ()
     return sfc_threshold;
 }
 
+void
+DistributionMapping::SFC_Curve (SFCCurve curve)
+{
+    sfc_curve = curve;
+}
+
+DistributionMapping::SFCCurve
+DistributionMapping::SFC_Curve ()
+{
+    return sfc_curve;
+}
+
 bool
 DistributionMapping::operator== (const DistributionMapping& rhs) const noexcept
 {
@@ -114,6 +127,7 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9_rt;
     node_size        = 0;
+    sfc_curve        = SFCCurve::Morton;
     flag_verbose_mapper = 0;
 
     ParmParse pp("DistributionMapping");
@@ -125,6 +139,26 @@ DistributionMapping::Initialize ()
     pp.query("node_size",           node_size);
     pp.query("verbose_mapper",      flag_verbose_mapper);
 
+    std::string theCurve;
+
+    if (pp.query("sfc_curve", theCurve))
+    {
+        if (theCurve == "morton" || theCurve == "MORTON")
+        {
+            sfc_curve = SFCCurve::Morton;
+        }
+        else if (theCurve == "hilbert" || theCurve == "HILBERT")
+        {
+            sfc_curve = SFCCurve::Hilbert;
+        }
+        else
+        {
+            std::string msg("Unknown sfc_curve: ");
+            msg += theCurve;
+            amrex::Warning(msg.c_str());
+        }
+    }
+
     std::string theStrategy;
 
     if (pp.query("strategy", theStrategy))
@@ -995,6 +1029,106 @@ namespace {
 
         return token;
     }
+
+    //
+    // Position of iv along a Hilbert curve through [0,2^nbits)^AMREX_SPACEDIM,
+    // using Skilling's transpose algorithm (AIP Conf. Proc. 707, 381 (2004)).
+    //
+    uint64_t hilbertKey (IntVect const& iv, int nbits)
+    {
+        uint32_t X[AMREX_SPACEDIM];
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            X[idim] = static_cast<uint32_t>(iv[idim]);
+        }
+
+        const uint32_t M = 1u << (nbits-1);
+        // Inverse undo
+        for (uint32_t Q = M; Q > 1; Q >>= 1) {
+            const uint32_t P = Q - 1;
+            for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+                if (X[i] & Q) {
+                    X[0] ^= P;
+                } else {
+                    const uint32_t t = (X[0] ^ X[i]) & P;
+                    X[0] ^= t;
+                    X[i] ^= t;
+                }
+            }
+        }
+        // Gray encode
+        for (int i = 1; i < AMREX_SPACEDIM; ++i) {
+            X[i] ^= X[i-1];
+        }
+        uint32_t t = 0;
+        for (uint32_t Q = M; Q > 1; Q >>= 1) {
+            if (X[AMREX_SPACEDIM-1] & Q) t ^= Q - 1;
+        }
+        for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+            X[i] ^= t;
+        }
+
+        uint64_t key = 0;
+        for (int b = nbits-1; b >= 0; --b) {
+            for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+                key = (key << 1) | ((X[i] >> b) & 1u);
+            }
+        }
+        return key;
+    }
+
+    std::vector<SFCToken> makeSFCTokens (const BoxArray& boxes)
+    {
+        const int N = boxes.size();
+        std::vector<SFCToken> tokens;
+        tokens.reserve(N);
+
+#if (AMREX_SPACEDIM > 1)
+        if (sfc_curve == DistributionMapping::SFCCurve::Hilbert && N > 0)
+        {
+            // The curve covers the smallest power-of-two cube containing
+            // the lower corners, up to 64 bits in total.
+            const Box& bx0 = boxes[0];
+            IntVect lo = bx0.smallEnd();
+            IntVect hi = lo;
+            for (int i = 1; i < N; ++i) {
+                const Box& bx = boxes[i];
+                lo.min(bx.smallEnd());
+                hi.max(bx.smallEnd());
+            }
+            const IntVect ext = hi - lo;
+            const Long maxext = ext.max();
+            int nbits = 1;
+            while (nbits < 64/AMREX_SPACEDIM && maxext >= (Long(1) << nbits)) {
+                ++nbits;
+            }
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxext < (Long(1) << nbits),
+                                             "SFCToken: index range too large for Hilbert keys");
+
+            for (int i = 0; i < N; ++i)
+            {
+                const Box& bx = boxes[i];
+                const uint64_t key = hilbertKey(bx.smallEnd() - lo, nbits);
+                SFCToken token;
+                token.m_box = i;
+                token.m_morton[0] = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+                token.m_morton[1] = static_cast<uint32_t>(key >> 32);
+#if (AMREX_SPACEDIM == 3)
+                token.m_morton[2] = 0;
+#endif
+                tokens.push_back(token);
+            }
+            return tokens;
+        }
+#endif
+
+        // In 1D both curves are the same.
+        for (int i = 0; i < N; ++i)
+        {
+            const Box& bx = boxes[i];
+            tokens.push_back(makeSFCToken(i, bx.smallEnd()));
+        }
+        return tokens;
+    }
 }
 
 static
@@ -1118,15 +1252,9 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
     }
 
     const int N = boxes.size();
-    std::vector<SFCToken> tokens;
-    tokens.reserve(N);
-    for (int i = 0; i < N; ++i)
-    {
-        const Box& bx = boxes[i];
-        tokens.push_back(makeSFCToken(i, bx.smallEnd()));
-    }
+    std::vector<SFCToken> tokens = makeSFCTokens(boxes);
     //
-    // Put'm in Morton space filling curve order.
+    // Put'm in space filling curve order.
     //
     std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
     //
@@ -1363,15 +1491,9 @@ DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
 #endif
 
     const int nboxes = boxes.size();
-    std::vector<SFCToken> tokens;
-    tokens.reserve(nboxes);
-    for (int i = 0; i < nboxes; ++i)
-    {
-        const Box& bx = boxes[i];
-        tokens.push_back(makeSFCToken(i, bx.smallEnd()));
-    }
+    std::vector<SFCToken> tokens = makeSFCTokens(boxes);
     //
-    // Put'm in Morton space filling curve order.
+    // Put'm in space filling curve order.
     //
     std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
 
@@ -1760,21 +1882,19 @@ DistributionMapping::makeSFC (const BoxArray& ba, bool use_box_vol, const int np
     BL_PROFILE("makeSFC");
 
     const int N = ba.size();
-    std::vector<SFCToken> tokens;
+    std::vector<SFCToken> tokens = makeSFCTokens(ba);
     std::vector<Long> wgts;
-    tokens.reserve(N);
     wgts.reserve(N);
     Long vol_sum = 0;
     for (int i = 0; i < N; ++i)
     {
         const Box& bx = ba[i];
-        tokens.push_back(makeSFCToken(i, bx.smallEnd()));
         const Long v = use_box_vol ? bx.volume() : Long(1);
         vol_sum += v;
         wgts.push_back(v);
     }
     //
-    // Put'm in Morton space filling curve order.
+    // Put'm in space filling curve order.
     //
     std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
 
@@ -83,6 +83,7 @@ FabArrayBase::CacheStats           FabArrayBase::m_CFinfo_stats("CrseFineCache")
 std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
+FabArrayBase::CommStats            FabArrayBase::m_comm_stats;
 
 std::map<std::string,FabArrayBase::meminfo> FabArrayBase::m_mem_usage;
 std::vector<std::string>                    FabArrayBase::m_region_tag;
@@ -124,6 +125,7 @@ FabArrayBase::Initialize ()
     }
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
+    pp.query("comm_stats",          FabArrayBase::m_comm_stats.on);
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -2112,6 +2114,7 @@ FabArrayBase::Finalize ()
     m_BD_count.clear();
 
     m_FA_stats = FabArrayStats();
+    m_comm_stats = CommStats();
 
     the_fa_arena = nullptr;
 
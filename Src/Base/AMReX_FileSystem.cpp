@@ -61,6 +61,22 @@ RemoveAll (std::string const& p)
     return !ec;
 }
 
+Vector<std::string>
+ListFiles (std::string const& p)
+{
+    Vector<std::string> r;
+    std::error_code ec;
+    std::filesystem::path const root{p};
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (it->is_regular_file()) {
+            r.push_back(it->path().lexically_relative(root).generic_string());
+        }
+    }
+    return r;
+}
+
 }}
 
 #else
@@ -69,6 +85,7 @@ RemoveAll (std::string const& p)
 #include <cstddef>
 #include <cstring>
 #include <unistd.h>
+#include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -210,6 +227,36 @@ RemoveAll (std::string const& p)
     return true;
 }
 
+namespace {
+void ListFilesImpl (std::string const& root, std::string const& rel,
+                    Vector<std::string>& r)
+{
+    DIR* d = opendir((rel.empty() ? root : root + "/" + rel).c_str());
+    if (d == nullptr) { return; }
+    while (struct dirent* e = readdir(d)) {
+        std::string const name(e->d_name);
+        if (name == "." || name == "..") { continue; }
+        std::string const relname = rel.empty() ? name : rel + "/" + name;
+        struct stat statbuff;
+        if (lstat((root + "/" + relname).c_str(), &statbuff) != 0) { continue; }
+        if (S_ISDIR(statbuff.st_mode)) {
+            ListFilesImpl(root, relname, r);
+        } else if (S_ISREG(statbuff.st_mode)) {
+            r.push_back(relname);
+        }
+    }
+    closedir(d);
+}
+}
+
+Vector<std::string>
+ListFiles (std::string const& p)
+{
+    Vector<std::string> r;
+    ListFilesImpl(p, std::string(), r);
+    return r;
+}
+
 }}
 
 #endif
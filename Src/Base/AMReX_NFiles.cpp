@@ -1,8 +1,10 @@
 
 #include <AMReX_Utility.H>
 #include <AMReX_NFiles.H>
+#include <cstring>
 #include <deque>
 #include <fstream>
+#include <limits>
 
 namespace amrex {
 
@@ -572,4 +574,113 @@ void NFilesIter::CleanUpMessages() {
 #endif
 }
 
+
+Long NFilesIter::AggregatedWrite(int noutfiles, const std::string &fileprefix,
+                                 const char *data, Long nbytes, int &fileNumber,
+                                 Long chunkSize)
+{
+  BL_PROFILE("NFilesIter::AggregatedWrite()");
+  AMREX_ALWAYS_ASSERT(chunkSize > 0 && chunkSize <= std::numeric_limits<int>::max());
+
+  const int myProc(ParallelDescriptor::MyProc());
+  const bool groupSets(false);   // ---- consecutive ranks share a file
+  fileNumber = FileNumber(ActualNFiles(noutfiles), myProc, groupSets);
+  const std::string fileName(FileName(fileNumber, fileprefix));
+
+  Long myOffset(0);
+
+#ifdef BL_USE_MPI
+  MPI_Comm groupComm;
+  BL_MPI_REQUIRE( MPI_Comm_split(ParallelDescriptor::Communicator(), fileNumber,
+                                 myProc, &groupComm) );
+  int groupRank(0), groupSize(0);
+  BL_MPI_REQUIRE( MPI_Comm_rank(groupComm, &groupRank) );
+  BL_MPI_REQUIRE( MPI_Comm_size(groupComm, &groupSize) );
+
+  // ---- phase one:  the aggregator lays out the file
+  const MPI_Datatype longType(ParallelDescriptor::Mpi_typemap<Long>::type());
+  Vector<Long> groupBytes(groupSize, 0), groupOffsets(groupSize, 0);
+  BL_MPI_REQUIRE( MPI_Gather(&nbytes, 1, longType, groupBytes.dataPtr(), 1, longType,
+                             0, groupComm) );
+  for(int r(1); r < groupSize; ++r) {
+    groupOffsets[r] = groupOffsets[r-1] + groupBytes[r-1];
+  }
+  BL_MPI_REQUIRE( MPI_Scatter(groupOffsets.dataPtr(), 1, longType, &myOffset, 1, longType,
+                              0, groupComm) );
+
+  // ---- phase two:  the data are sent in pieces that do not cross a
+  // ---- chunk boundary of the file, so both sides agree on the pieces
+  auto pieceSize = [chunkSize] (Long pos, Long end) {
+    return std::min(end, (pos / chunkSize + 1) * chunkSize) - pos;
+  };
+  const int tag(0);
+
+  if(groupRank == 0) {
+    const Long totalBytes(groupOffsets[groupSize-1] + groupBytes[groupSize-1]);
+    if(totalBytes > 0) {
+      std::ofstream ofs;
+      ofs.rdbuf()->pubsetbuf(nullptr, 0);    // ---- we only write whole chunks
+      ofs.open(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if( ! ofs.good()) {
+        amrex::FileOpenFailed(fileName);
+      }
+      Vector<char> chunk(std::min(chunkSize, totalBytes));
+      Long filled(0);
+      for(int r(0); r < groupSize; ++r) {
+        Long pos(groupOffsets[r]);
+        const Long end(pos + groupBytes[r]);
+        while(pos < end) {
+          const Long n(pieceSize(pos, end));
+          if(r == 0) {
+            std::memcpy(chunk.dataPtr() + filled, data + pos, n);
+          } else {
+            BL_MPI_REQUIRE( MPI_Recv(chunk.dataPtr() + filled, static_cast<int>(n), MPI_CHAR,
+                                     r, tag, groupComm, MPI_STATUS_IGNORE) );
+          }
+          filled += n;
+          pos    += n;
+          if(filled == chunkSize) {
+            ofs.write(chunk.dataPtr(), filled);
+            filled = 0;
+          }
+        }
+      }
+      if(filled > 0) {
+        ofs.write(chunk.dataPtr(), filled);
+      }
+      ofs.close();
+      if( ! ofs.good()) {
+        amrex::Abort("NFilesIter::AggregatedWrite:  error writing " + fileName);
+      }
+    }
+  } else {
+    Long pos(myOffset);
+    const Long end(myOffset + nbytes);
+    while(pos < end) {
+      const Long n(pieceSize(pos, end));
+      BL_MPI_REQUIRE( MPI_Send(const_cast<char *>(data) + (pos - myOffset), static_cast<int>(n),
+                               MPI_CHAR, 0, tag, groupComm) );
+      pos += n;
+    }
+  }
+
+  BL_MPI_REQUIRE( MPI_Comm_free(&groupComm) );
+#else
+  amrex::ignore_unused(chunkSize);
+  if(nbytes > 0) {
+    std::ofstream ofs(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+    if( ! ofs.good()) {
+      amrex::FileOpenFailed(fileName);
+    }
+    ofs.write(data, nbytes);
+    ofs.close();
+    if( ! ofs.good()) {
+      amrex::Abort("NFilesIter::AggregatedWrite:  error writing " + fileName);
+    }
+  }
+#endif
+
+  return myOffset;
+}
+
 }
@@ -142,4 +142,11 @@ PlotFileDataImpl::get (int level, std::string const& varname) noexcept
     return mf;
 }
 
+FArrayBox
+PlotFileDataImpl::getFab (int level, int gid) noexcept
+{
+    std::unique_ptr<FArrayBox> fab(m_vismf[level]->readFAB(gid, m_mf_name[level]));
+    return std::move(*fab);
+}
+
 }
@@ -0,0 +1,106 @@
+
+#include <AMReX_PlotFileFabStream.H>
+#include <AMReX_ParallelDescriptor.H>
+
+namespace amrex {
+
+namespace {
+    // VisMF keeps its open streams in a static table.
+    std::mutex read_mutex;
+}
+
+PlotFileFabStream::PlotFileFabStream (PlotFileData& pf, int level, Vector<int> gids, int nahead)
+    : m_pf(&pf), m_level(level), m_gids(std::move(gids)), m_nahead(std::max(1,nahead))
+{
+    if (!m_gids.empty()) {
+        m_thread = std::thread(&PlotFileFabStream::readLoop, this);
+    }
+}
+
+PlotFileFabStream::~PlotFileFabStream ()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void
+PlotFileFabStream::readLoop ()
+{
+    for (int gid : m_gids)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_stop || static_cast<int>(m_ready.size()) < m_nahead; });
+            if (m_stop) return;
+        }
+
+        std::unique_lock<std::mutex> read_lock(read_mutex);
+        FArrayBox fab = m_pf->getFab(m_level, gid);
+        read_lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready.emplace_back(gid, std::move(fab));
+        }
+        m_cond.notify_all();
+    }
+}
+
+std::pair<int,FArrayBox>
+PlotFileFabStream::take ()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return !m_ready.empty(); });
+    std::pair<int,FArrayBox> r(std::move(m_ready.front()));
+    m_ready.pop_front();
+    lock.unlock();
+    m_cond.notify_all();
+    ++m_ntaken;
+    return r;
+}
+
+bool
+PlotFileFabStream::next (int& gid, std::unique_ptr<FArrayBox>& fab)
+{
+    if (m_ntaken == static_cast<int>(m_gids.size())) return false;
+    auto r = take();
+    gid = r.first;
+    fab = std::make_unique<FArrayBox>(std::move(r.second));
+    return true;
+}
+
+int
+PlotFileFabStream::next (int n, Vector<int>& gids, Vector<FArrayBox>& fabs)
+{
+    n = std::min(n, static_cast<int>(m_gids.size()) - m_ntaken);
+    gids.clear();
+    fabs.clear();
+    for (int i = 0; i < n; ++i) {
+        auto r = take();
+        gids.push_back(r.first);
+        fabs.push_back(std::move(r.second));
+    }
+    return n;
+}
+
+Vector<int>
+PlotFileFabStream::LocalGrids (PlotFileData const& pf, int level)
+{
+    Vector<int> r;
+    const DistributionMapping& dm = pf.DistributionMap(level);
+    const int myproc = ParallelDescriptor::MyProc();
+    for (int i = 0, N = dm.size(); i < N; ++i) {
+        if (dm[i] == myproc) {
+            r.push_back(i);
+        }
+    }
+    return r;
+}
+
+}
@@ -4,6 +4,7 @@
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_FPC.H>
 #include <AMReX_FabArrayUtility.H>
+#include <AMReX_MultiFabUtil.H>
 
 #ifdef AMREX_USE_EB
 #include <AMReX_EBFabFactory.H>
@@ -18,6 +19,8 @@
 
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 
@@ -125,8 +128,10 @@ WriteGenericPlotfileHeader (std::ostream &HeaderFile,
             HeaderFile << geom[0].ProbHi(i) << ' ';
         }
         HeaderFile << '\n';
+        // The header has one ratio per level.  Write the largest, so that
+        // the ratio of 1 normal to a plane region does not hide the others.
         for (int i = 0; i < finest_level; ++i) {
-            HeaderFile << ref_ratio[i][0] << ' ';
+            HeaderFile << ref_ratio[i].max() << ' ';
         }
         HeaderFile << '\n';
         for (int i = 0; i <= finest_level; ++i) {
@@ -366,6 +371,232 @@ WriteSingleLevelPlotfile (const std::string& plotfilename,
                             level_steps, ref_ratio, versionName, levelPrefix, mfPrefix, extra_dirs);
 }
 
+PlotFileRegion
+PlotFileRegion::Plane (std::string a_name, const Geometry& geom, int dir, Real a_coord,
+                       Vector<IntVect> a_coarsen)
+{
+    AMREX_ALWAYS_ASSERT(dir >= 0 && dir < AMREX_SPACEDIM);
+    PlotFileRegion r(std::move(a_name), geom.Domain(), std::move(a_coarsen));
+    r.normal = dir;
+    r.coord = a_coord;
+    return r;
+}
+
+PlotFileRegion
+PlotFileRegion::Plane (std::string a_name, const Geometry& geom, int dir, Real a_coord,
+                       const Box& a_box, Vector<IntVect> a_coarsen)
+{
+    PlotFileRegion r = Plane(std::move(a_name), geom, dir, a_coord, std::move(a_coarsen));
+    r.box &= a_box;
+    return r;
+}
+
+namespace {
+
+    // The cells of domain in the layer containing coordinate x in direction dir.
+    Box planeLayer (const Geometry& geom, int dir, Real x)
+    {
+        const Box& domain = geom.Domain();
+        int i = static_cast<int>(std::floor((x - geom.ProbLo(dir)) * geom.InvCellSize(dir)))
+            + domain.smallEnd(dir);
+        i = amrex::max(domain.smallEnd(dir), amrex::min(domain.bigEnd(dir), i));
+        Box b = domain;
+        b.setRange(dir, i);
+        return b;
+    }
+
+    // Copy the part of mf inside region into a MultiFab with the same
+    // owners, with its boxes shifted by shift.
+    MultiFab extractRegion (const MultiFab& mf, const Box& region, const IntVect& shift)
+    {
+        const BoxArray& ba = mf.boxArray();
+        const DistributionMapping& dm = mf.DistributionMap();
+
+        auto isects = ba.intersections(amrex::convert(region, ba.ixType()));
+        std::sort(isects.begin(), isects.end(),
+                  [] (std::pair<int,Box> const& a, std::pair<int,Box> const& b)
+                  { return a.first < b.first; });
+
+        BoxList bl(ba.ixType());
+        bl.reserve(isects.size());
+        Vector<int> pmap, src;
+        pmap.reserve(isects.size());
+        src.reserve(isects.size());
+        for (auto const& is : isects) {
+            bl.push_back(amrex::shift(is.second, shift));
+            pmap.push_back(dm[is.first]);
+            src.push_back(is.first);
+        }
+
+        const int ncomp = mf.nComp();
+        const Dim3 sh = shift.dim3();
+        MultiFab r(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)), ncomp, 0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(r); mfi.isValid(); ++mfi) {
+            auto const& d = r.array(mfi);
+            auto const& s = mf.const_array(src[mfi.index()]);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D(mfi.validbox(), ncomp, i, j, k, n,
+            {
+                d(i,j,k,n) = s(i-sh.x,j-sh.y,k-sh.z,n);
+            });
+        }
+        return r;
+    }
+}
+
+void
+WriteMultiLevelPlotfileRegion (const std::string& plotfilename, int nlevels,
+                               const Vector<const MultiFab*>& mf,
+                               const Vector<std::string>& varnames,
+                               const Vector<Geometry>& geom, Real time,
+                               const Vector<int>& level_steps,
+                               const Vector<IntVect>& ref_ratio,
+                               const PlotFileRegion& region,
+                               const std::string &versionName,
+                               const std::string &levelPrefix,
+                               const std::string &mfPrefix)
+{
+    BL_PROFILE("WriteMultiLevelPlotfileRegion()");
+
+    BL_ASSERT(nlevels <= mf.size());
+    BL_ASSERT(nlevels <= geom.size());
+    BL_ASSERT(nlevels <= ref_ratio.size()+1);
+    BL_ASSERT(nlevels <= level_steps.size());
+
+    Vector<MultiFab> rmf;
+    Vector<Geometry> rgeom;
+    Vector<IntVect> rratio;
+    Vector<IntVect> crse;
+
+    // The region at the current level, before it is aligned for coarsening.
+    Box target = region.box & geom[0].Domain();
+    // A plane is one cell thick on every level, and these cells must nest.
+    // So every level is given the index and the physical extent of the
+    // level 0 layer in the normal direction, and a refinement ratio of 1
+    // there.  layer0 is the index of that layer.
+    int layer0 = 0;
+    for (int lev = 0; lev < nlevels; ++lev)
+    {
+        const Geometry& g = geom[lev];
+        if (lev > 0) {
+            target.refine(ref_ratio[lev-1]);
+        }
+        IntVect shift(0);
+        if (region.isPlane()) {
+            const int dir = region.normal;
+            const int layer = planeLayer(g, dir, region.coord).smallEnd(dir);
+            target.setRange(dir, layer);
+            if (lev == 0) { layer0 = layer; }
+            shift[dir] = layer0 - layer;
+        }
+        if (!target.ok()) break;
+
+        IntVect c = (lev < region.coarsen.size()) ? region.coarsen[lev] : IntVect(1);
+        if (region.isPlane()) {
+            c[region.normal] = 1;
+        }
+
+        Box rbox = amrex::refine(amrex::coarsen(target, c), c) & g.Domain();
+        if (c != 1) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mf[lev]->boxArray().coarsenable(c) &&
+                                             rbox == amrex::refine(amrex::coarsen(rbox,c),c),
+                                             "WriteMultiLevelPlotfileRegion: level cannot be coarsened by the given factor");
+        }
+
+        MultiFab fine = extractRegion(*mf[lev], rbox, shift);
+        if (fine.boxArray().empty()) break;
+
+        if (lev > 0) {
+            IntVect rr;
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                AMREX_ALWAYS_ASSERT_WITH_MESSAGE((ref_ratio[lev-1][d]*crse[lev-1][d]) % c[d] == 0,
+                                                 "WriteMultiLevelPlotfileRegion: coarsening factors do not match the refinement ratios");
+                rr[d] = ref_ratio[lev-1][d]*crse[lev-1][d] / c[d];
+            }
+            if (region.isPlane()) {
+                rr[region.normal] = 1;
+            }
+            rratio.push_back(rr);
+        }
+
+        RealBox rb;
+        const Box& dom = g.Domain();
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            rb.setLo(d, g.ProbLo(d) + (rbox.smallEnd(d)   - dom.smallEnd(d)) * g.CellSize(d));
+            rb.setHi(d, g.ProbLo(d) + (rbox.bigEnd(d) + 1 - dom.smallEnd(d)) * g.CellSize(d));
+        }
+        if (region.isPlane() && lev > 0) {
+            const int dir = region.normal;
+            rb.setLo(dir, rgeom[0].ProbLo(dir));
+            rb.setHi(dir, rgeom[0].ProbHi(dir));
+        }
+        int is_per[AMREX_SPACEDIM] = {AMREX_D_DECL(0,0,0)};
+        rgeom.emplace_back(amrex::coarsen(amrex::shift(rbox, shift), c), &rb, g.Coord(), is_per);
+
+        if (c == 1) {
+            rmf.push_back(std::move(fine));
+        } else {
+            MultiFab coarse(amrex::coarsen(fine.boxArray(), c), fine.DistributionMap(), fine.nComp(), 0);
+            amrex::average_down(fine, coarse, 0, fine.nComp(), c);
+            rmf.push_back(std::move(coarse));
+        }
+        crse.push_back(c);
+        target = rbox;
+    }
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!rmf.empty(), "WriteMultiLevelPlotfileRegion: region does not intersect the data");
+
+    const int rnlevels = rmf.size();
+    Vector<const MultiFab*> rmfp(rnlevels);
+    for (int lev = 0; lev < rnlevels; ++lev) {
+        rmfp[lev] = &rmf[lev];
+    }
+
+    WriteMultiLevelPlotfile(plotfilename, rnlevels, rmfp, varnames, rgeom, time,
+                            level_steps, rratio, versionName, levelPrefix, mfPrefix);
+}
+
+void
+WriteSingleLevelPlotfileRegion (const std::string& plotfilename,
+                                const MultiFab& mf, const Vector<std::string>& varnames,
+                                const Geometry& geom, Real time, int level_step,
+                                const PlotFileRegion& region,
+                                const std::string &versionName,
+                                const std::string &levelPrefix,
+                                const std::string &mfPrefix)
+{
+    Vector<const MultiFab*> mfarr(1,&mf);
+    Vector<Geometry> geomarr(1,geom);
+    Vector<int> level_steps(1,level_step);
+    Vector<IntVect> ref_ratio;
+
+    WriteMultiLevelPlotfileRegion(plotfilename, 1, mfarr, varnames, geomarr, time,
+                                  level_steps, ref_ratio, region, versionName, levelPrefix, mfPrefix);
+}
+
+void
+WriteMultiLevelPlotfileRegions (const std::string& plotfilename, int nlevels,
+                                const Vector<const MultiFab*>& mf,
+                                const Vector<std::string>& varnames,
+                                const Vector<Geometry>& geom, Real time,
+                                const Vector<int>& level_steps,
+                                const Vector<IntVect>& ref_ratio,
+                                const Vector<PlotFileRegion>& regions,
+                                const std::string &versionName,
+                                const std::string &levelPrefix,
+                                const std::string &mfPrefix)
+{
+    for (int i = 0; i < regions.size(); ++i) {
+        const std::string& name = regions[i].name.empty()
+            ? Concatenate("region", i, 2) : regions[i].name;
+        WriteMultiLevelPlotfileRegion(plotfilename + "_" + name, nlevels, mf, varnames, geom,
+                                      time, level_steps, ref_ratio, regions[i],
+                                      versionName, levelPrefix, mfPrefix);
+    }
+}
+
 
 #ifdef AMREX_USE_EB
 void
@@ -0,0 +1,238 @@
+
+#include <AMReX_TileSizeTuner.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <utility>
+
+namespace amrex {
+
+namespace {
+
+    struct Entry
+    {
+        Vector<IntVect> candidates;
+        Vector<double> tmin;  //!< the fastest time of each candidate
+        int ncalls = 0;
+        bool tuned = false;
+        IntVect tilesize;
+    };
+
+    using Key = std::pair<std::string,IntVect>;
+
+    std::map<Key,Entry> tuner_table;
+
+    bool initialized = false;
+    int enable = 0;
+    int nsamples = 3;
+    int verbose = 0;
+    std::string tuner_file;
+}
+
+void
+TileSizeTuner::Initialize ()
+{
+    if (initialized) return;
+    initialized = true;
+
+    ParmParse pp("tile_tuner");
+    pp.query("enable", enable);
+    pp.query("nsamples", nsamples);
+    pp.query("file", tuner_file);
+    pp.query("v", verbose);
+    nsamples = std::max(nsamples, 1);
+
+    if (!tuner_file.empty()) {
+        Read(tuner_file);
+    }
+
+    amrex::ExecOnFinalize(TileSizeTuner::Finalize);
+}
+
+void
+TileSizeTuner::Finalize ()
+{
+    if (!tuner_file.empty()) {
+        Write(tuner_file);
+    }
+    tuner_table.clear();
+    enable = 0;
+    nsamples = 3;
+    verbose = 0;
+    tuner_file.clear();
+    initialized = false;
+}
+
+TileSizeTuner::TileSizeTuner (std::string kernel, const FabArrayBase& fa)
+    : m_kernel(std::move(kernel))
+{
+    init(fa.boxArray());
+}
+
+TileSizeTuner::TileSizeTuner (std::string kernel, const BoxArray& ba)
+    : m_kernel(std::move(kernel))
+{
+    init(ba);
+}
+
+void
+TileSizeTuner::init (const BoxArray& ba)
+{
+    AMREX_ASSERT(!OpenMP::in_parallel());
+
+    m_tilesize = FabArrayBase::mfiter_tile_size;
+    if (ba.empty() || !TilingIfNotGPU()) return;
+
+    m_boxsize = ba[0].length();
+
+    auto it = tuner_table.find(Key(m_kernel, m_boxsize));
+    if (it == tuner_table.end()) {
+        if (!enable) return;
+        Entry e;
+        e.candidates = Candidates(m_boxsize);
+        e.tmin.resize(e.candidates.size(), std::numeric_limits<double>::max());
+        it = tuner_table.emplace(Key(m_kernel, m_boxsize), std::move(e)).first;
+    }
+
+    Entry& e = it->second;
+    if (e.tuned) {
+        m_tilesize = e.tilesize;
+    } else {
+        m_candidate = e.ncalls % e.candidates.size();
+        m_tilesize = e.candidates[m_candidate];
+        m_t0 = amrex::second();
+    }
+}
+
+TileSizeTuner::~TileSizeTuner ()
+{
+    if (m_candidate < 0) return;
+
+    const double dt = amrex::second() - m_t0;
+
+    Entry& e = tuner_table[Key(m_kernel, m_boxsize)];
+    e.tmin[m_candidate] = std::min(e.tmin[m_candidate], dt);
+    ++e.ncalls;
+    if (e.ncalls == nsamples * static_cast<int>(e.candidates.size())) {
+        const auto ibest = std::distance(e.tmin.begin(),
+                                         std::min_element(e.tmin.begin(), e.tmin.end()));
+        e.tilesize = e.candidates[ibest];
+        e.tuned = true;
+        if (verbose) {
+            amrex::Print() << "TileSizeTuner: " << m_kernel << " on boxes of " << m_boxsize
+                           << " uses tile size " << e.tilesize << ", "
+                           << e.tmin[ibest] << " s vs. " << e.tmin[0] << " s for "
+                           << e.candidates[0] << "\n";
+        }
+    }
+}
+
+IntVect
+TileSizeTuner::TunedTileSize (const std::string& kernel, const IntVect& boxsize)
+{
+    auto it = tuner_table.find(Key(kernel, boxsize));
+    if (it != tuner_table.end() && it->second.tuned) {
+        return it->second.tilesize;
+    } else {
+        return FabArrayBase::mfiter_tile_size;
+    }
+}
+
+Vector<IntVect>
+TileSizeTuner::Candidates (const IntVect& boxsize)
+{
+    // Tiles longer than the box are the same as the box, so they are
+    // trimmed and the duplicates removed.  The default comes first.
+    Vector<IntVect> r;
+    auto add = [&] (IntVect t) {
+        t.min(boxsize);
+        if (std::find(r.begin(), r.end(), t) == r.end()) {
+            r.push_back(t);
+        }
+    };
+    add(FabArrayBase::mfiter_tile_size);
+    constexpr int big = 1024000;
+#if (AMREX_SPACEDIM == 1)
+    for (int tx : {big, 1024, 256, 64}) {
+        add(IntVect(tx));
+    }
+#elif (AMREX_SPACEDIM == 2)
+    for (int tx : {big, 64, 32}) {
+        for (int ty : {4, 8, 16, 32}) {
+            add(IntVect(tx,ty));
+        }
+    }
+#else
+    const std::pair<int,int> tyz[] = {{4,4}, {8,4}, {8,8}, {16,8}, {16,16}, {32,32}};
+    for (int tx : {big, 64, 32}) {
+        for (auto const& yz : tyz) {
+            add(IntVect(tx,yz.first,yz.second));
+        }
+    }
+#endif
+    return r;
+}
+
+void
+TileSizeTuner::Write (const std::string& filename)
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    std::ofstream ofs(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!ofs.good()) {
+        amrex::FileOpenFailed(filename);
+    }
+    ofs << "# TileSizeTuner: tile size, box size, kernel name\n";
+    for (auto const& kv : tuner_table) {
+        if (kv.second.tuned) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                ofs << kv.second.tilesize[idim] << " ";
+            }
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                ofs << kv.first.second[idim] << " ";
+            }
+            ofs << kv.first.first << "\n";
+        }
+    }
+}
+
+void
+TileSizeTuner::Read (const std::string& filename)
+{
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(filename, buf, false);
+    if (buf.empty()) return;  // It does not exist (yet).
+
+    std::istringstream is(buf.dataPtr());
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        IntVect tilesize, boxsize;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            ls >> tilesize[idim];
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            ls >> boxsize[idim];
+        }
+        std::string kernel;
+        std::getline(ls >> std::ws, kernel);
+        if (ls.fail() || kernel.empty()) {
+            amrex::Abort("TileSizeTuner::Read: failed to read " + filename);
+        }
+        Entry& e = tuner_table[Key(kernel, boxsize)];
+        e.tuned = true;
+        e.tilesize = tilesize;
+    }
+}
+
+}
@@ -21,6 +21,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
@@ -35,10 +36,40 @@ double TinyProfiler::t_init = std::numeric_limits<double>::max();
 int TinyProfiler::device_synchronize_around_region = 0;
 int TinyProfiler::n_print_tabs = 0;
 int TinyProfiler::verbose = 0;
+int TinyProfiler::memory_profiling = 0;
 
 namespace {
     std::set<std::string> improperly_nested_timers;
     static constexpr char mainregion[] = "main";
+
+    // Bytes counted by TinyProfiler::MemoryAlloc and MemoryFree.  peak is
+    // the peak of live since the innermost running timer started.
+    std::atomic<Long> mem_nalloc{0};
+    std::atomic<Long> mem_nfree{0};
+    std::atomic<Long> mem_live{0};
+    std::atomic<Long> mem_peak{0};
+
+    void atomic_max (std::atomic<Long>& a, Long v) noexcept
+    {
+        Long old = a.load(std::memory_order_relaxed);
+        while (old < v && !a.compare_exchange_weak(old, v, std::memory_order_relaxed)) {}
+    }
+
+    std::string bytes_string (Long nbytes)
+    {
+        constexpr Long G = 1024L*1024L*1024L;
+        constexpr Long M = 1024L*1024L;
+        constexpr Long K = 1024L;
+        if (nbytes >= 10L*G) {
+            return std::to_string(nbytes/G) + " GB";
+        } else if (nbytes >= 10L*M) {
+            return std::to_string(nbytes/M) + " MB";
+        } else if (nbytes >= 10L*K) {
+            return std::to_string(nbytes/K) + " KB";
+        } else {
+            return std::to_string(nbytes) + " B";
+        }
+    }
 }
 
 TinyProfiler::TinyProfiler (std::string funcname) noexcept
@@ -93,6 +124,10 @@ TinyProfiler::start () noexcept
         ttstack.emplace_back(std::make_tuple(t, 0.0, &fname));
         global_depth = ttstack.size();
 
+        if (memory_profiling) {
+            startMemory();
+        }
+
 #ifdef AMREX_USE_GPU
             if (device_synchronize_around_region) {
                 amrex::Gpu::Device::synchronize();
@@ -145,6 +180,11 @@ TinyProfiler::stop () noexcept
             t = amrex::second();
         }
 
+        Long nalloc = 0, nfree = 0, npeak = 0;
+        if (memory_profiling) {
+            stopMemory(nalloc, nfree, npeak);
+        }
+
         while (static_cast<int>(ttstack.size()) > global_depth) {
             ttstack.pop_back();
         };
@@ -171,7 +211,10 @@ TinyProfiler::stop () noexcept
                 ++(st->n);
                 if (st->depth == 0) {
                     st->dtin += dtin;
+                    st->nbytes_alloc += nalloc;
+                    st->nbytes_free += nfree;
                 }
+                st->nbytes_peak = std::max(st->nbytes_peak, npeak);
                 st->dtex += dtex;
                 st->usesCUPTI = uCUPTI;
                 if (uCUPTI) {
@@ -228,6 +271,11 @@ TinyProfiler::stop (unsigned boxUintID) noexcept
         t = computeElapsedTimeUserdata(activityRecordUserdata);
         int nKernelCalls = activityRecordUserdata.size();
 
+        Long nalloc = 0, nfree = 0, npeak = 0;
+        if (memory_profiling) {
+            stopMemory(nalloc, nfree, npeak);
+        }
+
         for (auto& record : activityRecordUserdata)
         {
             record->setUintID(boxUintID);
@@ -257,7 +305,10 @@ TinyProfiler::stop (unsigned boxUintID) noexcept
                 if (st->depth == 0)
                 {
                     st->dtin += dtin;
+                    st->nbytes_alloc += nalloc;
+                    st->nbytes_free += nfree;
                 }
+                st->nbytes_peak = std::max(st->nbytes_peak, npeak);
                 st->dtex += dtex;
                 st->usesCUPTI = uCUPTI;
                 st->nk += nKernelCalls;
@@ -292,6 +343,44 @@ TinyProfiler::stop (unsigned boxUintID) noexcept
 }
 #endif
 
+void
+TinyProfiler::startMemory () noexcept
+{
+    nbytes_alloc_start = mem_nalloc.load(std::memory_order_relaxed);
+    nbytes_free_start = mem_nfree.load(std::memory_order_relaxed);
+    // The peak restarts from the current usage for this timer.  The
+    // parent's peak so far is restored in stopMemory.
+    nbytes_peak_parent = mem_peak.exchange(mem_live.load(std::memory_order_relaxed),
+                                           std::memory_order_relaxed);
+}
+
+void
+TinyProfiler::stopMemory (Long& nalloc, Long& nfree, Long& npeak) noexcept
+{
+    nalloc = mem_nalloc.load(std::memory_order_relaxed) - nbytes_alloc_start;
+    nfree = mem_nfree.load(std::memory_order_relaxed) - nbytes_free_start;
+    npeak = mem_peak.load(std::memory_order_relaxed);
+    atomic_max(mem_peak, nbytes_peak_parent);
+}
+
+void
+TinyProfiler::MemoryAlloc (std::size_t nbytes) noexcept
+{
+    if (!memory_profiling) return;
+    const Long n = static_cast<Long>(nbytes);
+    mem_nalloc.fetch_add(n, std::memory_order_relaxed);
+    atomic_max(mem_peak, mem_live.fetch_add(n, std::memory_order_relaxed) + n);
+}
+
+void
+TinyProfiler::MemoryFree (std::size_t nbytes) noexcept
+{
+    if (!memory_profiling) return;
+    const Long n = static_cast<Long>(nbytes);
+    mem_nfree.fetch_add(n, std::memory_order_relaxed);
+    mem_live.fetch_sub(n, std::memory_order_relaxed);
+}
+
 void
 TinyProfiler::Initialize () noexcept
 {
@@ -306,6 +395,25 @@ TinyProfiler::Initialize () noexcept
     }
 }
 
+void
+TinyProfiler::InitializeMemory () noexcept
+{
+    amrex::ParmParse pp("tiny_profiler");
+    pp.query("memory_profiling", memory_profiling);
+}
+
+bool
+TinyProfiler::GetMemoryStats (const std::string& fname, Long& nalloc, Long& nfree, Long& npeak)
+{
+    auto const& regstats = statsmap[mainregion];
+    auto it = regstats.find(fname);
+    if (it == regstats.end()) return false;
+    nalloc = it->second.nbytes_alloc;
+    nfree = it->second.nbytes_free;
+    npeak = it->second.nbytes_peak;
+    return true;
+}
+
 void
 TinyProfiler::Finalize (bool bFlushing) noexcept
 {
@@ -432,18 +540,25 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
         Long n = it->second.n;
         double dts[2] = {it->second.dtin, it->second.dtex};
 
+        Long mem[3] = {it->second.nbytes_alloc, it->second.nbytes_free, it->second.nbytes_peak};
+
         std::vector<Long> ncalls(nprocs);
         std::vector<double> dtdt(2*nprocs);
+        std::vector<Long> memmem(3*nprocs);
 
         if (ParallelDescriptor::NProcs() == 1)
         {
             ncalls[0] = n;
             dtdt[0] = dts[0];
             dtdt[1] = dts[1];
+            std::copy(mem, mem+3, memmem.begin());
         } else
         {
             ParallelDescriptor::Gather(&n, 1, &ncalls[0], 1, ioproc);
             ParallelDescriptor::Gather(dts, 2, &dtdt[0], 2, ioproc);
+            if (memory_profiling) {
+                ParallelDescriptor::Gather(mem, 3, &memmem[0], 3, ioproc);
+            }
         }
 
         if (ParallelDescriptor::IOProcessor()) {
@@ -458,6 +573,9 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
                 pst.dtexmin  = std::min(pst.dtexmin, dtdt[2*i+1]);
                 pst.dtexavg +=                       dtdt[2*i+1];
                 pst.dtexmax  = std::max(pst.dtexmax, dtdt[2*i+1]);
+                pst.allocmax = std::max(pst.allocmax, memmem[3*i]);
+                pst.freemax  = std::max(pst.freemax,  memmem[3*i+1]);
+                pst.peakmax  = std::max(pst.peakmax,  memmem[3*i+2]);
             }
             pst.navg /= nprocs;
             pst.dtinavg /= nprocs;
@@ -538,9 +656,11 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
         }
         amrex::OutStream() << hline << "\n";
 
-        // Inclusive time
+        // Inclusive time, and the memory (max across processes) if it is profiled
+        const int wm = memory_profiling ? 11 : 0;
+        const std::string hlinein = memory_profiling ? hline + std::string(3*(wm+2),'-') : hline;
         std::sort(allprocstats.begin(), allprocstats.end(), ProcStats::compin);
-        amrex::OutStream() << "\n" << hline << "\n";
+        amrex::OutStream() << "\n" << hlinein << "\n";
         amrex::OutStream() << std::left
                            << std::setw(maxfnamelen) << "Name"
                            << std::right
@@ -548,8 +668,13 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
                            << std::setw(wt+2) << "Incl. Min"
                            << std::setw(wt+2) << "Incl. Avg"
                            << std::setw(wt+2) << "Incl. Max"
-                           << std::setw(wp+2)  << "Max %"
-                           << "\n" << hline << "\n";
+                           << std::setw(wp+2)  << "Max %";
+        if (memory_profiling) {
+            amrex::OutStream() << std::setw(wm+2) << "Alloc Max"
+                               << std::setw(wm+2) << "Free Max"
+                               << std::setw(wm+2) << "Peak Max";
+        }
+        amrex::OutStream() << "\n" << hlinein << "\n";
         for (auto it = allprocstats.cbegin(); it != allprocstats.cend(); ++it)
         {
 #ifdef AMREX_USE_CUPTI
@@ -568,6 +693,11 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
                                << std::setprecision(2) << std::setw(wp+1) << std::fixed
                                << it->dtinmax*(100.0/dt_max) << "%";
             amrex::OutStream().unsetf(std::ios_base::fixed);
+            if (memory_profiling) {
+                amrex::OutStream() << std::setw(wm+2) << bytes_string(it->allocmax)
+                                   << std::setw(wm+2) << bytes_string(it->freemax)
+                                   << std::setw(wm+2) << bytes_string(it->peakmax);
+            }
             amrex::OutStream() << "\n";
 #ifdef AMREX_USE_CUPTI
             if (it->usesCUPTI)
@@ -586,7 +716,7 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
             }
 #endif
         }
-        amrex::OutStream() << hline << "\n";
+        amrex::OutStream() << hlinein << "\n";
         amrex::OutStream() << std::endl;
     }
 }
@@ -39,6 +39,8 @@ bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
+bool VisMF::useAggregatedWrites(false);
+Long VisMF::aggregateChunkSize(16*1024*1024);
 
 Long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -87,6 +89,8 @@ VisMF::Initialize ()
     pp.query("usedynamicsetselection", useDynamicSetSelection);
     pp.query("iobuffersize", ioBufferSize);
     pp.query("allowsparsewrites", allowSparseWrites);
+    pp.query("useaggregatedwrites", useAggregatedWrites);
+    pp.query("aggregatechunksize", aggregateChunkSize);
 
     initialized = true;
 }
@@ -925,6 +929,45 @@ VisMF::WriteHeader (const std::string &mf_name, VisMF::Header &hdr,
 }
 
 
+// ---- copy fab, preceded by its header if writeHeader, into dst in the
+// ---- format of rd.  returns the number of bytes copied.
+static Long
+CopyFabToBuffer (const FArrayBox &fab, bool writeHeader, bool doConvert,
+                 const RealDescriptor &rd, char *dst)
+{
+    int hLength(0);
+    const Long writeDataItems(fab.box().numPts() * fab.nComp());
+    const Long writeDataSize(writeDataItems * rd.numBytes());
+    if(writeHeader) {
+        std::stringstream hss;
+        FArrayBox::getFABio().write_header(hss, fab, fab.nComp());
+        hLength = static_cast<std::streamoff>(hss.tellp());
+        auto tstr = hss.str();
+        memcpy(dst, tstr.c_str(), hLength);  // ---- the fab header
+    }
+    Real const* fabdata = fab.dataPtr();
+#ifdef AMREX_USE_GPU
+    std::unique_ptr<FArrayBox> hostfab;
+    if (fab.arena()->isManaged() || fab.arena()->isDevice()) {
+        hostfab = std::make_unique<FArrayBox>(fab.box(), fab.nComp(),
+                                              The_Pinned_Arena());
+        Gpu::dtoh_memcpy_async(hostfab->dataPtr(), fab.dataPtr(),
+                               fab.size()*sizeof(Real));
+        Gpu::streamSynchronize();
+        fabdata = hostfab->dataPtr();
+    }
+#endif
+    if(doConvert) {
+        RealDescriptor::convertFromNativeFormat(static_cast<void *> (dst + hLength),
+                                                writeDataItems,
+                                                fabdata, rd);
+    } else {    // ---- copy from the fab
+        memcpy(dst + hLength, fabdata, writeDataSize);
+    }
+    return hLength + writeDataSize;
+}
+
+
 Long
 VisMF::Write (const FabArray<FArrayBox>&    mf,
               const std::string& mf_name,
@@ -995,10 +1038,53 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 
     std::string filePrefix(mf_name + FabFileSuffix);
 
-    NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
-
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
 
+    if(useAggregatedWrites) {
+        // ---- pack the local fabs, then let the aggregators write them
+        Long localBytes(0);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            const FArrayBox &fab = mf[mfi];
+            hdr.m_fod[mfi.index()].m_head = localBytes;
+            if(oldHeader) {
+                std::stringstream hss;
+                FArrayBox::getFABio().write_header(hss, fab, fab.nComp());
+                localBytes += static_cast<std::streamoff>(hss.tellp());
+            }
+            localBytes += fab.box().numPts() * mf.nComp() * whichRD->numBytes();
+        }
+        Vector<char> allFabData(localBytes);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            CopyFabToBuffer(mf[mfi], oldHeader, doConvert, *whichRD,
+                            allFabData.dataPtr() + hdr.m_fod[mfi.index()].m_head);
+        }
+
+        int fileNumber(-1);
+        const Long fileOffset = NFilesIter::AggregatedWrite(nOutFiles, filePrefix,
+                                                            allFabData.dataPtr(), localBytes,
+                                                            fileNumber, aggregateChunkSize);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            hdr.m_fod[mfi.index()].m_head += fileOffset;
+        }
+        bytesWritten += localBytes;
+
+        if(currentVersion == VisMF::Header::Version_v1 ||
+           currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+        {
+            hdr.CalculateMinMax(mf, coordinatorProc);
+        }
+
+        VisMF::GatherOffsets(mf, filePrefix, hdr, fileNumber, coordinatorProc);
+
+        bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+
+        delete whichRD;
+
+        return bytesWritten;
+    }
+
+    NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
+
     if(useSparseFPP) {
         nfi.SetSparseFPP(procsWithDataVector);
     } else if(useDynamicSetSelection) {
@@ -1033,38 +1119,8 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         if(canCombineFABs) {
             Long writePosition(0);
             for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                int hLength(0);
-                const FArrayBox &fab = mf[mfi];
-                writeDataItems = fab.box().numPts() * mf.nComp();
-                writeDataSize = writeDataItems * whichRDBytes;
-                char *afPtr = allFabData + writePosition;
-                if(oldHeader) {
-                    std::stringstream hss;
-                    fio.write_header(hss, fab, fab.nComp());
-                    hLength = static_cast<std::streamoff>(hss.tellp());
-                    auto tstr = hss.str();
-                    memcpy(afPtr, tstr.c_str(), hLength);  // ---- the fab header
-                }
-                Real const* fabdata = fab.dataPtr();
-#ifdef AMREX_USE_GPU
-                std::unique_ptr<FArrayBox> hostfab;
-                if (fab.arena()->isManaged() || fab.arena()->isDevice()) {
-                    hostfab = std::make_unique<FArrayBox>(fab.box(), fab.nComp(),
-                                                          The_Pinned_Arena());
-                    Gpu::dtoh_memcpy_async(hostfab->dataPtr(), fab.dataPtr(),
-                                           fab.size()*sizeof(Real));
-                    Gpu::streamSynchronize();
-                    fabdata = hostfab->dataPtr();
-                }
-#endif
-                if(doConvert) {
-                    RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
-                                                            writeDataItems,
-                                                            fabdata, *whichRD);
-                } else {    // ---- copy from the fab
-                    memcpy(afPtr + hLength, fabdata, writeDataSize);
-                }
-                writePosition += hLength + writeDataSize;
+                writePosition += CopyFabToBuffer(mf[mfi], oldHeader, doConvert, *whichRD,
+                                                 allFabData + writePosition);
             }
             nfi.Stream().write(allFabData, bytesWritten);
             nfi.Stream().flush();
@@ -1333,6 +1389,62 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 }
 
 
+void
+VisMF::GatherOffsets (const FabArray<FArrayBox> &mf,
+                      const std::string &filePrefix,
+                      VisMF::Header &hdr,
+                      int fileNumber, int coordinatorProc,
+                      MPI_Comm comm)
+{
+#ifdef BL_USE_MPI
+    const int myProc(ParallelDescriptor::MyProc(comm));
+    const int nProcs(ParallelDescriptor::NProcs(comm));
+    const Vector<int> &pmap = mf.DistributionMap().ProcessorMap();
+
+    Vector<int> nmtags(nProcs,0);
+    Vector<int> offset(nProcs,0);
+    for(int i(0), N(mf.size()); i < N; ++i) {
+        ++nmtags[pmap[i]];
+    }
+    for(int i(1); i < nProcs; ++i) {
+        offset[i] = offset[i-1] + nmtags[i-1];
+    }
+
+    Vector<Long> senddata(std::max(1, nmtags[myProc]));
+    int ioffset(0);
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      senddata[ioffset++] = hdr.m_fod[mfi.index()].m_head;
+    }
+
+    Vector<Long> recvdata(std::max(1, mf.size()));
+    BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(), nmtags[myProc],
+                                ParallelDescriptor::Mpi_typemap<Long>::type(),
+                                recvdata.dataPtr(), nmtags.dataPtr(), offset.dataPtr(),
+                                ParallelDescriptor::Mpi_typemap<Long>::type(),
+                                coordinatorProc, comm) );
+
+    Vector<int> fileNumbers(nProcs, -1);
+    BL_MPI_REQUIRE( MPI_Gather(&fileNumber, 1, MPI_INT, fileNumbers.dataPtr(), 1, MPI_INT,
+                               coordinatorProc, comm) );
+
+    if(myProc == coordinatorProc) {
+        Vector<int> cnt(nProcs,0);
+        for(int j(0), N(mf.size()); j < N; ++j) {
+            const int i(pmap[j]);
+            hdr.m_fod[j].m_head = recvdata[offset[i]+cnt[i]];
+            hdr.m_fod[j].m_name = VisMF::BaseName(NFilesIter::FileName(fileNumbers[i], filePrefix));
+            ++cnt[i];
+        }
+    }
+#else
+    amrex::ignore_unused(coordinatorProc, comm);
+    for(int j(0), N(mf.size()); j < N; ++j) {
+        hdr.m_fod[j].m_name = VisMF::BaseName(NFilesIter::FileName(fileNumber, filePrefix));
+    }
+#endif
+}
+
+
 void
 VisMF::RemoveFiles(const std::string &mf_name, bool a_verbose)
 {
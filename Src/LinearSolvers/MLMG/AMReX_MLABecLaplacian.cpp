@@ -410,6 +410,9 @@ MLABecLaplacian::prepareForSolve ()
 
     averageDownCoeffs();
 
+    m_halo_a_coeffs.clear();
+    m_halo_b_coeffs.clear();
+
     m_is_singular.clear();
     m_is_singular.resize(m_num_amr_levels, false);
     auto itlo = std::find(m_lobc[0].begin(), m_lobc[0].end(), BCType::Dirichlet);
@@ -652,6 +655,141 @@ MLABecLaplacian::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab&
     }
 }
 
+bool
+MLABecLaplacian::supportsSmoothHalo (int amrlev, int mglev) const
+{
+    bool regular_coarsening = true;
+    if (amrlev == 0 && mglev > 0) {
+        regular_coarsening = mg_coarsen_ratio_vec[mglev-1] == mg_coarsen_ratio;
+    }
+    return regular_coarsening && !m_overset_mask[amrlev][mglev];
+}
+
+void
+MLABecLaplacian::FsmoothHalo (int amrlev, int mglev, MultiFab& solrhs, int redblack, int ngrow) const
+{
+    BL_PROFILE("MLABecLaplacian::FsmoothHalo()");
+
+    AMREX_ALWAYS_ASSERT(amrlev == 0);
+
+    // The coefficients are needed in the ghost cells too.
+    if (m_halo_a_coeffs.size() <= mglev) {
+        m_halo_a_coeffs.resize(mglev+1);
+        m_halo_b_coeffs.resize(mglev+1);
+    }
+    if (m_halo_a_coeffs[mglev] == nullptr)
+    {
+        const int ng = solrhs.nGrow();
+        const auto& period = m_geom[amrlev][mglev].periodicity();
+        auto make_halo = [&] (MultiFab const& mf) {
+            auto r = std::make_unique<MultiFab>(mf.boxArray(), mf.DistributionMap(),
+                                                mf.nComp(), ng);
+            MultiFab::Copy(*r, mf, 0, 0, mf.nComp(), 0);
+            r->FillBoundary(period);
+            return r;
+        };
+        m_halo_a_coeffs[mglev] = make_halo(m_a_coeffs[amrlev][mglev]);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            m_halo_b_coeffs[mglev][idim] = make_halo(m_b_coeffs[amrlev][mglev][idim]);
+        }
+    }
+
+    const MultiFab& acoef = *m_halo_a_coeffs[mglev];
+    AMREX_D_TERM(const MultiFab& bxcoef = *m_halo_b_coeffs[mglev][0];,
+                 const MultiFab& bycoef = *m_halo_b_coeffs[mglev][1];,
+                 const MultiFab& bzcoef = *m_halo_b_coeffs[mglev][2];);
+
+    const int nc = getNComp();
+    const Real* h = m_geom[amrlev][mglev].CellSize();
+    AMREX_D_TERM(const Real dhx = m_b_scalar/(h[0]*h[0]);,
+                 const Real dhy = m_b_scalar/(h[1]*h[1]);,
+                 const Real dhz = m_b_scalar/(h[2]*h[2]));
+    const Real alpha = m_a_scalar;
+
+    // The valid box passed to the kernel is larger than the region
+    // relaxed, so the boundary terms, and the masks, are not used.
+    const Array4<Real const> f;
+    const Array4<int const> m;
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(solrhs,mfi_info); mfi.isValid(); ++mfi)
+    {
+        const Box& tbx = mfi.growntilebox(ngrow);
+        const Box& vbx = amrex::grow(mfi.validbox(), ngrow+1);
+        const auto& solnfab = solrhs.array(mfi);
+        const auto rhsfab = Array4<Real const>(solrhs.const_array(mfi), nc);
+        const auto& afab = acoef.const_array(mfi);
+        AMREX_D_TERM(const auto& bxfab = bxcoef.const_array(mfi);,
+                     const auto& byfab = bycoef.const_array(mfi);,
+                     const auto& bzfab = bzcoef.const_array(mfi););
+
+        AMREX_LAUNCH_HOST_DEVICE_FUSIBLE_LAMBDA ( tbx, thread_box,
+        {
+            abec_gsrb(thread_box, solnfab, rhsfab, alpha, afab,
+                      AMREX_D_DECL(dhx, dhy, dhz),
+                      AMREX_D_DECL(bxfab, byfab, bzfab),
+                      AMREX_D_DECL(m,m,m),
+                      AMREX_D_DECL(m,m,m),
+                      AMREX_D_DECL(f,f,f),
+                      AMREX_D_DECL(f,f,f),
+                      vbx, redblack, nc);
+        });
+    }
+}
+
+bool
+MLABecLaplacian::supportsResidualRestriction (int amrlev, int mglev) const
+{
+    // The fused kernel knows only the plain ABecLaplacian stencil, not the
+    // extra terms of derived operators such as MLTensorOp.
+    return !isTensorOp() && !hasHiddenDimension() && !m_overset_mask[amrlev][mglev];
+}
+
+void
+MLABecLaplacian::FresidualRestriction (int amrlev, int mglev, MultiFab& crse, const MultiFab& x,
+                                       const MultiFab& b, const IntVect& ratio) const
+{
+    BL_PROFILE("MLABecLaplacian::FresidualRestriction()");
+
+    const MultiFab& acoef = m_a_coeffs[amrlev][mglev];
+    AMREX_D_TERM(const MultiFab& bxcoef = m_b_coeffs[amrlev][mglev][0];,
+                 const MultiFab& bycoef = m_b_coeffs[amrlev][mglev][1];,
+                 const MultiFab& bzcoef = m_b_coeffs[amrlev][mglev][2];);
+
+    const auto dxinv = m_geom[amrlev][mglev].InvCellSizeArray();
+
+    const Real ascalar = m_a_scalar;
+    const Real bscalar = m_b_scalar;
+
+    const int ncomp = getNComp();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(crse, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& cfab = crse.array(mfi);
+        const auto& xfab = x.const_array(mfi);
+        const auto& bfab = b.const_array(mfi);
+        const auto& afab = acoef.const_array(mfi);
+        AMREX_D_TERM(const auto& bxfab = bxcoef.const_array(mfi);,
+                     const auto& byfab = bycoef.const_array(mfi);,
+                     const auto& bzfab = bzcoef.const_array(mfi););
+        AMREX_HOST_DEVICE_PARALLEL_FOR_4D_FUSIBLE (bx, ncomp, i, j, k, n,
+        {
+            mlabeclap_resid_restriction(i, j, k, n, cfab, xfab, bfab, afab,
+                                        AMREX_D_DECL(bxfab,byfab,bzfab),
+                                        dxinv, ascalar, bscalar, ratio);
+        });
+    }
+}
+
 void
 MLABecLaplacian::FFlux (int amrlev, const MFIter& mfi,
                         const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
@@ -750,6 +888,9 @@ MLABecLaplacian::update ()
 
     averageDownCoeffs();
 
+    m_halo_a_coeffs.clear();
+    m_halo_b_coeffs.clear();
+
     m_is_singular.clear();
     m_is_singular.resize(m_num_amr_levels, false);
     auto itlo = std::find(m_lobc[0].begin(), m_lobc[0].end(), BCType::Dirichlet);
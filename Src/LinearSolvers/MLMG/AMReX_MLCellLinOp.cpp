@@ -414,6 +414,88 @@ MLCellLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
     }
 }
 
+bool
+MLCellLinOp::useSmoothHalo (int amrlev, int mglev) const
+{
+    // Without coarse/fine or physical boundaries, the ghost cells are
+    // filled by FillBoundary alone, and the relaxation can be redone in
+    // them.  FillBoundary does not fill more ghost cells than a period.
+    // The red/black coloring of a ghost cell is that of its periodic image
+    // only if the domain has an even number of cells in every direction.
+    const Box& domain = m_geom[amrlev][mglev].Domain();
+    bool even_domain = true;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        even_domain = even_domain && (domain.length(idim) % 2 == 0);
+    }
+    return info.smooth_halo_depth > 1
+        && mglev >= info.smooth_halo_mglev
+        && amrlev == 0
+        && m_geom[amrlev][mglev].isAllPeriodic()
+        && info.smooth_halo_depth <= domain.shortside()
+        && even_domain
+        && !hasHiddenDimension()
+        && supportsSmoothHalo(amrlev, mglev);
+}
+
+void
+MLCellLinOp::smoothSweeps (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
+                           int nsweeps, bool skip_fillboundary) const
+{
+    if (!useSmoothHalo(amrlev, mglev)) {
+        MLLinOp::smoothSweeps(amrlev, mglev, sol, rhs, nsweeps, skip_fillboundary);
+        return;
+    }
+
+    BL_PROFILE("MLCellLinOp::smoothSweeps()");
+
+    // The solution and the right-hand side are copied into a MultiFab with
+    // depth ghost cells.  After one FillBoundary, depth red or black
+    // half-sweeps are done on the valid region grown by depth-1, depth-2,
+    // ..., 0 cells.  The results in the valid region are the same as
+    // those of smooth.
+    const int ncomp = getNComp();
+    const int depth = info.smooth_halo_depth;
+    if (m_smooth_halo.size() <= mglev) m_smooth_halo.resize(mglev+1);
+    auto& halo = m_smooth_halo[mglev];
+    if (halo == nullptr || halo->boxArray() != sol.boxArray()
+        || halo->DistributionMap() != sol.DistributionMap())
+    {
+        halo = std::make_unique<MultiFab>(sol.boxArray(), sol.DistributionMap(), 2*ncomp, depth,
+                                          MFInfo(), *m_factory[amrlev][mglev]);
+    }
+
+    MultiFab::Copy(*halo, sol, 0, 0, ncomp, 0);
+    MultiFab::Copy(*halo, rhs, 0, ncomp, ncomp, 0);
+
+    // The ghost cells of sol, filled or not, are not deep enough, so the
+    // first FillBoundary is done even with skip_fillboundary.
+    amrex::ignore_unused(skip_fillboundary);
+    const auto& period = m_geom[amrlev][mglev].periodicity();
+    int nhalf = 2*nsweeps;
+    int redblack = 0;
+    bool first = true;
+    while (nhalf > 0)
+    {
+        const int n = std::min(depth, nhalf);
+        if (first) {
+            halo->FillBoundary(0, 2*ncomp, IntVect(depth), period);
+        } else {
+            halo->FillBoundary(0, ncomp, IntVect(n), period);
+        }
+        for (int i = n-1; i >= 0; --i) {
+#ifdef AMREX_SOFT_PERF_COUNTERS
+            perf_counters.smooth(sol);
+#endif
+            FsmoothHalo(amrlev, mglev, *halo, redblack, i);
+            redblack = 1 - redblack;
+        }
+        nhalf -= n;
+        first = false;
+    }
+
+    MultiFab::Copy(sol, *halo, 0, 0, ncomp, 0);
+}
+
 void
 MLCellLinOp::updateSolBC (int amrlev, const MultiFab& crse_bcdata) const
 {
@@ -490,6 +572,40 @@ MLCellLinOp::correctionResidual (int amrlev, int mglev, MultiFab& resid, MultiFa
     MultiFab::Xpay(resid, Real(-1.0), b, 0, 0, ncomp, 0);
 }
 
+void
+MLCellLinOp::correctionResidualRestriction (int amrlev, int cmglev, MultiFab& crse,
+                                            MultiFab& resid, MultiFab& x, const MultiFab& b)
+{
+    const int fmglev = cmglev-1;
+    if (!supportsResidualRestriction(amrlev, fmglev)) {
+        MLLinOp::correctionResidualRestriction(amrlev, cmglev, crse, resid, x, b);
+        return;
+    }
+
+    BL_PROFILE("MLCellLinOp::correctionResidualRestriction()");
+
+    // The residual is computed fine cell by fine cell as the coarse cells
+    // are averaged, so it is never stored.
+    applyBC(amrlev, fmglev, x, BCMode::Homogeneous, StateMode::Correction, nullptr);
+#ifdef AMREX_SOFT_PERF_COUNTERS
+    perf_counters.apply(resid);
+    perf_counters.restrict(crse);
+#endif
+
+    const IntVect ratio = (amrlev > 0) ? IntVect(2) : mg_coarsen_ratio_vec[fmglev];
+    const BoxArray& cba = amrex::coarsen(x.boxArray(), ratio);
+    if (cba == crse.boxArray() && x.DistributionMap() == crse.DistributionMap())
+    {
+        FresidualRestriction(amrlev, fmglev, crse, x, b, ratio);
+    }
+    else
+    {
+        MultiFab cfine(cba, x.DistributionMap(), crse.nComp(), 0);
+        FresidualRestriction(amrlev, fmglev, cfine, x, b, ratio);
+        crse.ParallelCopy(cfine);
+    }
+}
+
 void
 MLCellLinOp::applyBC (int amrlev, int mglev, MultiFab& in, BCMode bc_mode, StateMode,
                       const MLMGBndry* bndry, bool skip_fillboundary) const
@@ -80,8 +80,16 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     m_niters_cg.clear();
     m_iter_fine_resnorm0.clear();
 
+    telemetryStart();
+
     prepareForSolve(a_sol, a_rhs);
 
+    const bool use_history = !is_nsolve && sol_history_size > 0
+        && cf_strategy == CFStrategy::none;
+    if (use_history) {
+        historyInitialGuess();
+    }
+
     computeMLResidual(finest_amr_lev);
 
     int ncomp = linop.getNComp();
@@ -118,6 +126,14 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         if (verbose >= 1) {
             amrex::Print() << "MLMG: No iterations needed\n";
         }
+    } else if (!is_nsolve && outer_solver != OuterSolver::mlmg) {
+        auto iter_start_time = amrex::second();
+        if (outer_solver == OuterSolver::fgmres) {
+            composite_norminf = solveWithFGMRES(res_target, max_norm, norm_name);
+        } else {
+            composite_norminf = solveWithPCG(res_target, max_norm, norm_name);
+        }
+        timer[iter_time] = amrex::second() - iter_start_time;
     } else {
         auto iter_start_time = amrex::second();
         bool converged = false;
@@ -194,6 +210,10 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
         timer[iter_time] = amrex::second() - iter_start_time;
     }
 
+    if (use_history) {
+        historyRecord();
+    }
+
     IntVect ng_back = final_fill_bc ? IntVect(1) : IntVect(0);
     if (linop.hasHiddenDimension()) {
         ng_back[linop.hiddenDirection()] = 0;
@@ -207,6 +227,10 @@ MLMG::solve (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>& a_rh
     }
 
     timer[solve_time] = amrex::second() - solve_start_time;
+    if (!telemetry_file.empty()) {
+        --FabArrayBase::m_comm_stats.on;
+        telemetryWrite();
+    }
     if (verbose >= 1) {
         ParallelReduce::Max<double>(timer.data(), timer.size(), 0,
                                     ParallelContext::CommunicatorSub());
@@ -298,6 +322,7 @@ MLMG::computeMLResidual (int amrlevmax)
 
     const int mglev = 0;
     for (int alev = amrlevmax; alev >= 0; --alev) {
+        TelemetryRegion tr(*this, alev, mglev, tel_residual);
         const MultiFab* crse_bcdata = (alev > 0) ? sol[alev-1] : nullptr;
         linop.solutionResidual(alev, res[alev][mglev], *sol[alev], rhs[alev], crse_bcdata);
         if (alev < finest_amr_lev) {
@@ -312,6 +337,7 @@ void
 MLMG::computeResidual (int alev)
 {
     BL_PROFILE("MLMG::computeResidual()");
+    TelemetryRegion tr(*this, alev, 0, tel_residual);
 
     MultiFab& x = *sol[alev];
     const MultiFab& b = rhs[alev];
@@ -329,6 +355,7 @@ void
 MLMG::computeResWithCrseSolFineCor (int calev, int falev)
 {
     BL_PROFILE("MLMG::computeResWithCrseSolFineCor()");
+    TelemetryRegion tr(*this, falev, 0, tel_residual);
 
     int ncomp = linop.getNComp();
     int nghost = 0;
@@ -370,6 +397,7 @@ void
 MLMG::computeResWithCrseCorFineCor (int falev)
 {
     BL_PROFILE("MLMG::computeResWithCrseCorFineCor()");
+    TelemetryRegion tr(*this, falev, 0, tel_residual);
 
     int ncomp = linop.getNComp();
     int nghost = 0;
@@ -415,26 +443,29 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
                            << "   DN: Norm before smooth " << norm << "\n";
         }
 
-        cor[amrlev][mglev]->setVal(0.0);
-        bool skip_fillboundary = true;
-        for (int i = 0; i < nu1; ++i) {
-            linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
-                         skip_fillboundary);
-            skip_fillboundary = false;
+        {
+            TelemetryRegion tr(*this, amrlev, mglev, tel_smooth);
+            cor[amrlev][mglev]->setVal(0.0);
+            linop.smoothSweeps(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev],
+                               nu1, true);
         }
 
-        // rescor = res - L(cor)
-        computeResOfCorrection(amrlev, mglev);
-
         if (verbose >= 4)
         {
+            computeResOfCorrection(amrlev, mglev);
             Real norm = rescor[amrlev][mglev].norm0();
             amrex::Print() << "AT LEVEL "  << amrlev << " " << mglev
                            << "   DN: Norm after  smooth " << norm << "\n";
         }
 
-        // res_crse = R(rescor_fine); this provides res/b to the level below
-        linop.restriction(amrlev, mglev+1, res[amrlev][mglev+1], rescor[amrlev][mglev]);
+        // res_crse = R(res - L(cor)); this provides res/b to the level below.
+        // rescor = res - L(cor) is not computed if the operator fuses them.
+        {
+            TelemetryRegion tr(*this, amrlev, mglev, tel_restriction);
+            linop.correctionResidualRestriction(amrlev, mglev+1, res[amrlev][mglev+1],
+                                                rescor[amrlev][mglev], *cor[amrlev][mglev],
+                                                res[amrlev][mglev]);
+        }
 
     }
 
@@ -465,12 +496,11 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
             amrex::Print() << "AT LEVEL "  << amrlev << " " << mglev_bottom
                            << "       Norm before smooth " << norm << "\n";
         }
-        cor[amrlev][mglev_bottom]->setVal(0.0);
-        bool skip_fillboundary = true;
-        for (int i = 0; i < nu1; ++i) {
-            linop.smooth(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom], res[amrlev][mglev_bottom],
-                         skip_fillboundary);
-            skip_fillboundary = false;
+        {
+            TelemetryRegion tr(*this, amrlev, mglev_bottom, tel_smooth);
+            cor[amrlev][mglev_bottom]->setVal(0.0);
+            linop.smoothSweeps(amrlev, mglev_bottom, *cor[amrlev][mglev_bottom],
+                               res[amrlev][mglev_bottom], nu1, true);
         }
         if (verbose >= 4)
         {
@@ -494,8 +524,9 @@ MLMG::mgVcycle (int amrlev, int mglev_top)
             amrex::Print() << "AT LEVEL "  << amrlev << " " << mglev
                            << "   UP: Norm before smooth " << norm << "\n";
         }
-        for (int i = 0; i < nu2; ++i) {
-            linop.smooth(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev]);
+        {
+            TelemetryRegion tr(*this, amrlev, mglev, tel_smooth);
+            linop.smoothSweeps(amrlev, mglev, *cor[amrlev][mglev], res[amrlev][mglev], nu2);
         }
 
         if (cf_strategy == CFStrategy::ghostnodes) computeResOfCorrection(amrlev, mglev);
@@ -526,6 +557,7 @@ MLMG::mgFcycle ()
 
     for (int mglev = 1; mglev <= mg_bottom_lev; ++mglev)
     {
+        TelemetryRegion tr(*this, amrlev, mglev-1, tel_restriction);
 #ifdef AMREX_USE_EB
         amrex::EB_average_down(res[amrlev][mglev-1], res[amrlev][mglev], 0, ncomp,
                                linop.mg_coarsen_ratio_vec[mglev-1]);
@@ -559,6 +591,7 @@ void
 MLMG::interpCorrection (int alev)
 {
     BL_PROFILE("MLMG::interpCorrection_1");
+    TelemetryRegion tr(*this, alev, 0, tel_interpolation);
 
     const int ncomp = linop.getNComp();
     int nghost = 0;
@@ -705,6 +738,7 @@ void
 MLMG::interpCorrection (int alev, int mglev)
 {
     BL_PROFILE("MLMG::interpCorrection_2");
+    TelemetryRegion tr(*this, alev, mglev, tel_interpolation);
 
     MultiFab& crse_cor = *cor[alev][mglev+1];
     MultiFab& fine_cor = *cor[alev][mglev  ];
@@ -826,6 +860,7 @@ void
 MLMG::addInterpCorrection (int alev, int mglev)
 {
     BL_PROFILE("MLMG::addInterpCorrection()");
+    TelemetryRegion tr(*this, alev, mglev, tel_interpolation);
 
     const int ncomp = linop.getNComp();
 
@@ -862,6 +897,7 @@ void
 MLMG::computeResOfCorrection (int amrlev, int mglev)
 {
     BL_PROFILE("MLMG:computeResOfCorrection()");
+    TelemetryRegion tr(*this, amrlev, mglev, tel_residual);
     MultiFab& x = *cor[amrlev][mglev];
     const MultiFab& b = res[amrlev][mglev];
     MultiFab& r = rescor[amrlev][mglev];
@@ -874,6 +910,7 @@ MLMG::computeResOfCorrection (int amrlev, int mglev)
 void
 MLMG::bottomSolve ()
 {
+    TelemetryRegion tr(*this, 0, linop.NMGLevels(0)-1, tel_bottom);
     if (do_nsolve)
     {
         NSolve(*ns_mlmg, *ns_sol, *ns_rhs);
@@ -928,11 +965,7 @@ MLMG::actualBottomSolve ()
 
     if (bottom_solver == BottomSolver::smoother)
     {
-        bool skip_fillboundary = true;
-        for (int i = 0; i < nuf; ++i) {
-            linop.smooth(amrlev, mglev, x, b, skip_fillboundary);
-            skip_fillboundary = false;
-        }
+        linop.smoothSweeps(amrlev, mglev, x, b, nuf, true);
     }
     else
     {
@@ -991,9 +1024,7 @@ MLMG::actualBottomSolve ()
                 }
             }
             const int n = (ret==0) ? nub : nuf;
-            for (int i = 0; i < n; ++i) {
-                linop.smooth(amrlev, mglev, x, b);
-            }
+            linop.smoothSweeps(amrlev, mglev, x, b, n);
         }
     }
 
@@ -1641,6 +1672,7 @@ MLMG::averageDownAndSync ()
     {
         for (int falev = finest_amr_lev; falev > 0; --falev)
         {
+            TelemetryRegion tr(*this, falev, 0, tel_restriction);
 #ifdef AMREX_USE_EB
             amrex::EB_average_down(*sol[falev], *sol[falev-1], 0, ncomp, amrrr[falev-1]);
 #else
@@ -1650,10 +1682,14 @@ MLMG::averageDownAndSync ()
     }
     else
     {
-        linop.nodalSync(finest_amr_lev, 0, *sol[finest_amr_lev]);
+        {
+            TelemetryRegion tr(*this, finest_amr_lev, 0, tel_restriction);
+            linop.nodalSync(finest_amr_lev, 0, *sol[finest_amr_lev]);
+        }
 
         for (int falev = finest_amr_lev; falev > 0; --falev)
         {
+            TelemetryRegion tr(*this, falev, 0, tel_restriction);
             const auto& fmf = *sol[falev];
             auto&       cmf = *sol[falev-1];
 
@@ -2001,4 +2037,143 @@ MLMG::checkPoint (const Vector<MultiFab*>& a_sol, const Vector<MultiFab const*>&
     linop.checkPoint(file_name+"/linop");
 }
 
+MLMG::TelemetryRegion::TelemetryRegion (MLMG& a_mlmg, int a_amrlev, int a_mglev,
+                                        int a_type) noexcept
+    : m_type(a_type)
+{
+    if (!a_mlmg.m_telemetry.empty()) {
+        // Kernels are asynchronous on GPUs.  Without the synchronizations,
+        // their time would be charged to whichever region waits for them.
+        Gpu::streamSynchronize();
+        m_lev = &(a_mlmg.m_telemetry[a_amrlev][a_mglev]);
+        const auto& cs = FabArrayBase::m_comm_stats;
+        m_fb_time0 = cs.fb_time;
+        m_num_sends0 = cs.num_sends;
+        m_send_bytes0 = cs.send_bytes;
+        m_t0 = amrex::second();
+    }
+}
+
+MLMG::TelemetryRegion::~TelemetryRegion ()
+{
+    if (m_lev) {
+        Gpu::streamSynchronize();
+        const double dt = amrex::second() - m_t0;
+        const auto& cs = FabArrayBase::m_comm_stats;
+        const double dt_fb = cs.fb_time - m_fb_time0;
+        m_lev->time[m_type] += dt - dt_fb;
+        m_lev->time[tel_fillboundary] += dt_fb;
+        m_lev->num_sends += cs.num_sends - m_num_sends0;
+        m_lev->send_bytes += cs.send_bytes - m_send_bytes0;
+    }
+}
+
+void
+MLMG::telemetryStart ()
+{
+    m_telemetry.clear();
+    if (telemetry_file.empty()) return;
+
+    // The communication is counted during the solve only.
+    ++FabArrayBase::m_comm_stats.on;
+
+    m_telemetry.resize(namrlevs);
+    for (int alev = 0; alev < namrlevs; ++alev) {
+        m_telemetry[alev].resize(linop.NMGLevels(alev));
+    }
+}
+
+namespace {
+    void telemetry_number (std::ostream& os, double x)
+    {
+        if (std::isfinite(x)) {
+            os << x;
+        } else {
+            os << "null";
+        }
+    }
+}
+
+void
+MLMG::telemetryWrite ()
+{
+    BL_PROFILE("MLMG::telemetryWrite()");
+
+    static const char* names[ntelemetry] = {"smooth", "residual", "restriction",
+                                            "interpolation", "bottom", "fillboundary"};
+
+    Vector<double> times;
+    Vector<Long> counts;
+    for (auto const& amrlev : m_telemetry) {
+        for (auto const& lev : amrlev) {
+            times.insert(times.end(), lev.time.begin(), lev.time.end());
+            counts.push_back(lev.num_sends);
+            counts.push_back(lev.send_bytes);
+        }
+    }
+    Vector<double> tm(timer);
+
+    bool writer = true;
+    if (!telemetry_per_rank) {
+        MPI_Comm comm = ParallelContext::CommunicatorSub();
+        ParallelReduce::Max<double>(times.data(), times.size(), 0, comm);
+        ParallelReduce::Max<double>(tm.data(), tm.size(), 0, comm);
+        ParallelReduce::Sum<Long>(counts.data(), counts.size(), 0, comm);
+        writer = (ParallelContext::MyProcSub() == 0);
+    }
+    if (!writer) return;
+
+    std::ostringstream os;
+    os.precision(8);
+    os << "{\"solve\":" << solve_called
+       << ",\"operator\":\"" << linop.name() << "\""
+       << ",\"nprocs\":" << ParallelContext::NProcsSub();
+    if (telemetry_per_rank) {
+        os << ",\"rank\":" << ParallelDescriptor::MyProc();
+    }
+    os << ",\"outer_solver\":" << static_cast<int>(outer_solver)
+       << ",\"bottom_solver\":" << static_cast<int>(bottom_solver)
+       << ",\"agglomeration\":" << linop.info.do_agglomeration
+       << ",\"consolidation\":" << linop.info.do_consolidation
+       << ",\"niters\":" << m_iter_fine_resnorm0.size()
+       << ",\"rhs\":";
+    telemetry_number(os, m_rhsnorm0);
+    os << ",\"resid0\":";
+    telemetry_number(os, m_init_resnorm0);
+    os << ",\"resid\":";
+    telemetry_number(os, m_final_resnorm0);
+    os << ",\"resid_history\":[";
+    for (int i = 0; i < m_iter_fine_resnorm0.size(); ++i) {
+        if (i > 0) os << ",";
+        telemetry_number(os, m_iter_fine_resnorm0[i]);
+    }
+    os << "],\"time\":{\"solve\":" << tm[solve_time]
+       << ",\"iter\":" << tm[iter_time]
+       << ",\"bottom\":" << tm[bottom_time]
+       << "},\"levels\":[";
+    int ilev = 0;
+    for (int alev = 0; alev < m_telemetry.size(); ++alev) {
+        for (int mglev = 0; mglev < m_telemetry[alev].size(); ++mglev, ++ilev) {
+            if (ilev > 0) os << ",";
+            os << "{\"amrlev\":" << alev << ",\"mglev\":" << mglev;
+            for (int t = 0; t < ntelemetry; ++t) {
+                os << ",\"" << names[t] << "\":" << times[ilev*ntelemetry+t];
+            }
+            os << ",\"nsends\":" << counts[2*ilev]
+               << ",\"send_bytes\":" << counts[2*ilev+1] << "}";
+        }
+    }
+    os << "]}\n";
+
+    std::string file_name = telemetry_file;
+    if (telemetry_per_rank) {
+        file_name += "." + std::to_string(ParallelDescriptor::MyProc());
+    }
+    std::ofstream ofs(file_name, std::ofstream::out | std::ofstream::app);
+    if (!ofs.good()) {
+        FileOpenFailed(file_name);
+    }
+    ofs << os.str();
+}
+
 }
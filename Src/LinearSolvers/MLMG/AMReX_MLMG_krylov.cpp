@@ -0,0 +1,667 @@
+#include <AMReX_MLMG.H>
+#include <AMReX_MLNodeLinOp.H>
+
+#ifdef AMREX_USE_EB
+#include <AMReX_EBFabFactory.H>
+#endif
+
+// Krylov methods over the composite operator of all the AMR levels, with
+// one MLMG iteration (oneIter) as the preconditioner.
+//
+// The vectors live on level 0 of the MG hierarchy of each AMR level, like
+// rhs.  The operator and the preconditioner are evaluated with the MLMG
+// data by loading the vectors into sol and rhs.  MLMG always works with the
+// inhomogeneous boundary conditions of the original equation, so that
+// L(x) = Lh(x) + bcterm, where Lh is the linear part and bcterm = L(0) comes
+// from the boundary data.  Lh(x) is then -(bcterm - L(x)), and oneIter
+// applied to v + bcterm with a zero initial guess is linear in v.
+//
+// The same operations give the initial guess from the history of previous
+// solves (setSolutionHistorySize).
+
+namespace amrex {
+
+namespace {
+
+void krylov_saxpy (Vector<MultiFab>& y, Real a, const Vector<MultiFab>& x)
+{
+    for (int alev = 0; alev < y.size(); ++alev) {
+        MultiFab::Saxpy(y[alev], a, x[alev], 0, 0, y[alev].nComp(), 0);
+    }
+}
+
+void krylov_xpay (Vector<MultiFab>& y, Real a, const Vector<MultiFab>& x)
+{
+    for (int alev = 0; alev < y.size(); ++alev) {
+        MultiFab::Xpay(y[alev], a, x[alev], 0, 0, y[alev].nComp(), 0);
+    }
+}
+
+void krylov_copy (Vector<MultiFab>& y, const Vector<MultiFab>& x)
+{
+    for (int alev = 0; alev < y.size(); ++alev) {
+        MultiFab::Copy(y[alev], x[alev], 0, 0, y[alev].nComp(), 0);
+    }
+}
+
+void krylov_scale (Vector<MultiFab>& y, Real a)
+{
+    for (auto& mf : y) {
+        mf.mult(a, 0);
+    }
+}
+
+}
+
+void
+MLMG::makeKrylovVector (Vector<MultiFab>& v) const
+{
+    const int ncomp = linop.getNComp();
+    v.resize(namrlevs);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        v[alev].define(rhs[alev].boxArray(), rhs[alev].DistributionMap(), ncomp, 0,
+                       MFInfo(), *linop.Factory(alev));
+    }
+}
+
+// bcterm = L(0), i.e., the contribution of the boundary data.
+void
+MLMG::krylovBoundaryTerm (Vector<MultiFab>& bcterm)
+{
+    BL_PROFILE("MLMG::krylovBoundaryTerm()");
+
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        sol[alev]->setVal(0.0);
+        rhs[alev].setVal(0.0);
+    }
+    computeMLResidual(finest_amr_lev);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(bcterm[alev], res[alev][0], 0, 0, bcterm[alev].nComp(), 0);
+        bcterm[alev].negate(0);
+    }
+}
+
+// r = b - L(x).  This leaves x in sol and b in rhs.
+void
+MLMG::krylovResidual (Vector<MultiFab>& r, const Vector<MultiFab>& x,
+                      const Vector<MultiFab>& b)
+{
+    BL_PROFILE("MLMG::krylovResidual()");
+
+    const int ncomp = linop.getNComp();
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(*sol[alev], x[alev], 0, 0, ncomp, 0);
+        MultiFab::Copy(rhs[alev], b[alev], 0, 0, ncomp, 0);
+    }
+    computeMLResidual(finest_amr_lev);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(r[alev], res[alev][0], 0, 0, ncomp, 0);
+    }
+}
+
+// out = Lh(in) = -(bcterm - L(in))
+void
+MLMG::krylovApply (Vector<MultiFab>& out, const Vector<MultiFab>& in,
+                   const Vector<MultiFab>& bcterm)
+{
+    BL_PROFILE("MLMG::krylovApply()");
+
+    krylovResidual(out, in, bcterm);
+    for (auto& mf : out) {
+        mf.negate(0);
+    }
+}
+
+// z = M^{-1} v with one MLMG iteration
+void
+MLMG::krylovPrecond (Vector<MultiFab>& z, const Vector<MultiFab>& v,
+                     const Vector<MultiFab>& bcterm, int iter)
+{
+    BL_PROFILE("MLMG::krylovPrecond()");
+
+    const int ncomp = linop.getNComp();
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        sol[alev]->setVal(0.0);
+        MultiFab::LinComb(rhs[alev], Real(1.0), v[alev], 0, Real(1.0), bcterm[alev], 0,
+                          0, ncomp, 0);
+    }
+    computeResidual(finest_amr_lev);
+    oneIter(iter);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(z[alev], *sol[alev], 0, 0, ncomp, 0);
+    }
+}
+
+// Composite dot product.  The cells covered by finer AMR levels are masked
+// out, and the levels are weighted by their cell volumes.
+Real
+MLMG::krylovDot (const Vector<MultiFab>& x, const Vector<MultiFab>& y)
+{
+    BL_PROFILE("MLMG::krylovDot()");
+
+    const int ncomp = linop.getNComp();
+    Real result = 0.0;
+    Real weight = 1.0;
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        if (alev > 0) {
+            const Real rr = linop.AMRRefRatio(alev-1);
+            weight /= AMREX_D_TERM(rr, *rr, *rr);
+        }
+        const MultiFab* px = &(x[alev]);
+        MultiFab ntmp;
+        if (!linop.isCellCentered()) {
+            // Nodes shared by several boxes are counted once.
+            const auto& nodelinop = dynamic_cast<MLNodeLinOp const&>(linop);
+            const iMultiFab& omask = *nodelinop.m_owner_mask[alev][0];
+            ntmp.define(x[alev].boxArray(), x[alev].DistributionMap(), ncomp, 0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(ntmp,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+                Array4<Real> const& t = ntmp.array(mfi);
+                Array4<Real const> const& xa = x[alev].const_array(mfi);
+                Array4<int const> const& m = omask.const_array(mfi);
+                AMREX_HOST_DEVICE_PARALLEL_FOR_4D(bx, ncomp, i, j, k, n,
+                {
+                    t(i,j,k,n) = m(i,j,k) ? xa(i,j,k,n) : Real(0.0);
+                });
+            }
+            px = &ntmp;
+        }
+#ifdef AMREX_USE_EB
+        if (linop.isCellCentered() && scratch[alev]) {
+            MultiFab& tmp = *scratch[alev];
+            MultiFab::Copy(tmp, x[alev], 0, 0, ncomp, 0);
+            auto factory = dynamic_cast<EBFArrayBoxFactory const*>(linop.Factory(alev));
+            if (factory) {
+                const MultiFab& vfrac = factory->getVolFrac();
+                for (int n = 0; n < ncomp; ++n) {
+                    MultiFab::Multiply(tmp, vfrac, 0, n, 1, 0);
+                }
+            } else {
+                amrex::Abort("MLMG::krylovDot: not EB Factory");
+            }
+            px = &tmp;
+        }
+#endif
+        Real d;
+        if (fine_mask[alev]) {
+            d = MultiFab::Dot(*fine_mask[alev], *px, 0, y[alev], 0, ncomp, 0, true);
+        } else {
+            d = MultiFab::Dot(*px, 0, y[alev], 0, ncomp, 0, true);
+        }
+        result += weight * d;
+    }
+    ParallelAllReduce::Sum(result, ParallelContext::CommunicatorSub());
+    return result;
+}
+
+// Composite inf-norm, the same as the one used by the MLMG iterations.
+Real
+MLMG::krylovNormInf (const Vector<MultiFab>& r)
+{
+    const int ncomp = linop.getNComp();
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(res[alev][0], r[alev], 0, 0, ncomp, 0);
+    }
+    return MLResNormInf(finest_amr_lev);
+}
+
+Real
+MLMG::solveWithFGMRES (Real a_res_target, Real a_max_norm, const std::string& a_norm_name)
+{
+    BL_PROFILE("MLMG::solveWithFGMRES()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(cf_strategy == CFStrategy::none,
+                                     "MLMG: FGMRES does not support CFStrategy::ghostnodes");
+
+    const int ncomp = linop.getNComp();
+    const int m = std::max(fgmres_restart, 1);
+
+    Vector<MultiFab> b, x, bcterm;
+    makeKrylovVector(b);
+    makeKrylovVector(x);
+    makeKrylovVector(bcterm);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(b[alev], rhs[alev], 0, 0, ncomp, 0);
+        MultiFab::Copy(x[alev], *sol[alev], 0, 0, ncomp, 0);
+    }
+    krylovBoundaryTerm(bcterm);
+
+    // Arnoldi vectors and preconditioned vectors, allocated as needed
+    Vector<Vector<MultiFab> > v(m+1), z(m);
+    makeKrylovVector(v[0]);
+
+    // Hessenberg matrix, Givens rotations and right-hand side of the least
+    // squares problem
+    Vector<Real> h((m+1)*m), cs(m), sn(m), g(m+1), y(m);
+    auto H = [&] (int i, int j) -> Real& { return h[i+j*(m+1)]; };
+
+    const int niters = do_fixed_number_of_iters ? do_fixed_number_of_iters : max_iters;
+    Real composite_norminf = 0.0;
+    Real beta0 = -1.0;
+    bool converged = false;
+    int iter = 0;
+    bool cycle_has_iters = false;
+    for (int restart = 0; ; ++restart)
+    {
+        krylovResidual(v[0], x, b);
+        composite_norminf = krylovNormInf(v[0]);
+        converged = (composite_norminf <= a_res_target);
+        if (cycle_has_iters) {
+            // The last iteration of the previous cycle has the true residual.
+            m_iter_fine_resnorm0.back() = composite_norminf;
+        }
+        if (restart > 0 && verbose >= 2) {
+            amrex::Print() << "MLMG: FGMRES restart " << restart << " after iteration "
+                           << std::setw(3) << iter << " resid/" << a_norm_name << " = "
+                           << composite_norminf/a_max_norm << "\n";
+        }
+        if (converged || iter >= niters) break;
+
+        if (composite_norminf > Real(1.e20)*a_max_norm)
+        {
+            if (verbose > 0) {
+                amrex::Print() << "MLMG: FGMRES failing to converge after " << iter
+                               << " iterations. resid, resid/" << a_norm_name << " = "
+                               << composite_norminf << ", "
+                               << composite_norminf/a_max_norm << "\n";
+            }
+            amrex::Abort("MLMG failing so lets stop here");
+        }
+
+        const Real beta = std::sqrt(krylovDot(v[0], v[0]));
+        if (beta0 < 0.0) beta0 = beta;
+        krylov_scale(v[0], Real(1.0)/beta);
+
+        // Inner iterations stop when the estimate of the 2-norm of the
+        // residual has dropped as much as the inf-norm needs to.
+        const Real target2 = beta * (a_res_target / composite_norminf);
+
+        // The residual history holds inf-norms, like that of the MLMG
+        // iterations.  Within a cycle it is estimated from the 2-norm with
+        // the ratio of the two norms at the start of the cycle.
+        const Real norm_ratio = composite_norminf / beta;
+
+        std::fill(g.begin(), g.end(), Real(0.0));
+        g[0] = beta;
+        int k = 0;
+        bool breakdown = false;
+        cycle_has_iters = false;
+        for (int j = 0; j < m && iter < niters; ++j)
+        {
+            if (z[j].empty()) makeKrylovVector(z[j]);
+            if (v[j+1].empty()) makeKrylovVector(v[j+1]);
+
+            krylovPrecond(z[j], v[j], bcterm, iter);
+            krylovApply(v[j+1], z[j], bcterm);
+
+            // Modified Gram-Schmidt
+            for (int i = 0; i <= j; ++i) {
+                H(i,j) = krylovDot(v[j+1], v[i]);
+                krylov_saxpy(v[j+1], -H(i,j), v[i]);
+            }
+            H(j+1,j) = std::sqrt(krylovDot(v[j+1], v[j+1]));
+            const bool happy_breakdown = (H(j+1,j) == Real(0.0));
+            if (!happy_breakdown) {
+                krylov_scale(v[j+1], Real(1.0)/H(j+1,j));
+            }
+
+            for (int i = 0; i < j; ++i) {
+                const Real t = cs[i]*H(i,j) + sn[i]*H(i+1,j);
+                H(i+1,j) = -sn[i]*H(i,j) + cs[i]*H(i+1,j);
+                H(i,j) = t;
+            }
+            const Real denom = std::sqrt(H(j,j)*H(j,j) + H(j+1,j)*H(j+1,j));
+            if (denom == Real(0.0)) {
+                // Breakdown: the preconditioned vector z[j] adds nothing to
+                // the search space, and H is singular with column j.  The
+                // update uses the previous columns only.
+                cs[j] = 1.0;
+                sn[j] = 0.0;
+                breakdown = true;
+                ++iter;
+                // The step counts as an iteration that left the residual
+                // unchanged.
+                m_iter_fine_resnorm0.push_back(std::abs(g[j])*norm_ratio);
+                cycle_has_iters = true;
+                if (verbose >= 1) {
+                    amrex::Print() << "MLMG: FGMRES breakdown at iteration " << iter << "\n";
+                }
+                break;
+            }
+            cs[j] = H(j,j) / denom;
+            sn[j] = H(j+1,j) / denom;
+            H(j,j) = denom;
+            H(j+1,j) = 0.0;
+            g[j+1] = -sn[j]*g[j];
+            g[j] = cs[j]*g[j];
+
+            ++iter;
+            k = j+1;
+
+            const Real resnorm2 = std::abs(g[j+1]);
+            m_iter_fine_resnorm0.push_back(resnorm2*norm_ratio);
+            cycle_has_iters = true;
+            if (verbose >= 2) {
+                amrex::Print() << "MLMG: FGMRES iteration " << std::setw(3) << iter
+                               << " resid/resid0 (2-norm) = " << resnorm2/beta0 << "\n";
+            }
+
+            if (resnorm2 <= target2 || happy_breakdown) break;
+        }
+
+        // x += Z y, where H y = g
+        for (int i = k-1; i >= 0; --i) {
+            Real t = g[i];
+            for (int l = i+1; l < k; ++l) {
+                t -= H(i,l)*y[l];
+            }
+            y[i] = t / H(i,i);
+        }
+        for (int i = 0; i < k; ++i) {
+            krylov_saxpy(x, y[i], z[i]);
+        }
+
+        // Restarting from an unchanged x would break down again.  z[0] and
+        // the Krylov operators have overwritten sol and rhs, so x and b are
+        // loaded back.
+        if (breakdown && k == 0) {
+            krylovResidual(v[0], x, b);
+            composite_norminf = krylovNormInf(v[0]);
+            converged = (composite_norminf <= a_res_target);
+            m_iter_fine_resnorm0.back() = composite_norminf;
+            break;
+        }
+    }
+
+    if (converged) {
+        if (verbose >= 1) {
+            amrex::Print() << "MLMG: FGMRES Final Iter. " << iter
+                           << " resid, resid/" << a_norm_name << " = "
+                           << composite_norminf << ", "
+                           << composite_norminf/a_max_norm << "\n";
+        }
+    } else if (do_fixed_number_of_iters == 0) {
+        if (verbose > 0) {
+            amrex::Print() << "MLMG: FGMRES failed to converge after " << iter << " iterations."
+                           << " resid, resid/" << a_norm_name << " = "
+                           << composite_norminf << ", "
+                           << composite_norminf/a_max_norm << "\n";
+        }
+        amrex::Abort("MLMG failed");
+    }
+
+    return composite_norminf;
+}
+
+// Flexible PCG, with the Polak-Ribiere formula for beta, because the MLMG
+// preconditioner is not exactly symmetric.
+Real
+MLMG::solveWithPCG (Real a_res_target, Real a_max_norm, const std::string& a_norm_name)
+{
+    BL_PROFILE("MLMG::solveWithPCG()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(cf_strategy == CFStrategy::none,
+                                     "MLMG: PCG does not support CFStrategy::ghostnodes");
+
+    const int ncomp = linop.getNComp();
+
+    Vector<MultiFab> b, x, bcterm, r, rold, z, p, q;
+    makeKrylovVector(b);
+    makeKrylovVector(x);
+    makeKrylovVector(bcterm);
+    makeKrylovVector(r);
+    makeKrylovVector(rold);
+    makeKrylovVector(z);
+    makeKrylovVector(p);
+    makeKrylovVector(q);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(b[alev], rhs[alev], 0, 0, ncomp, 0);
+        MultiFab::Copy(x[alev], *sol[alev], 0, 0, ncomp, 0);
+    }
+    krylovBoundaryTerm(bcterm);
+
+    const int niters = do_fixed_number_of_iters ? do_fixed_number_of_iters : max_iters;
+
+    krylovResidual(r, x, b);
+    Real composite_norminf = krylovNormInf(r);
+    bool converged = (composite_norminf <= a_res_target);
+    bool restart = true;
+    bool sol_is_x = true;
+    Real rz = 0.0;
+    int iter = 0;
+    while (!converged && iter < niters)
+    {
+        if (restart) {
+            krylovPrecond(z, r, bcterm, iter);
+            krylov_copy(p, z);
+            rz = krylovDot(r, z);
+            restart = false;
+        }
+
+        krylovApply(q, p, bcterm);
+        const Real pq = krylovDot(p, q);
+        // The operator may be negative definite (e.g., MLNodeLaplacian),
+        // in which case both rz and pq are negative.
+        if (!(rz*pq > Real(0.0))) {
+            amrex::Abort("MLMG: PCG needs a symmetric definite operator");
+        }
+        const Real alpha = rz / pq;
+        krylov_saxpy(x, alpha, p);
+        krylov_copy(rold, r);
+        krylov_saxpy(r, -alpha, q);
+        sol_is_x = false;
+        ++iter;
+
+        composite_norminf = krylovNormInf(r);
+        m_iter_fine_resnorm0.push_back(composite_norminf);
+        if (verbose >= 2) {
+            amrex::Print() << "MLMG: PCG iteration " << std::setw(3) << iter
+                           << " resid/" << a_norm_name << " = "
+                           << composite_norminf/a_max_norm << "\n";
+        }
+
+        if (composite_norminf <= a_res_target) {
+            // Check with the true residual, from which the updated one
+            // may have drifted, and restart if needed.
+            krylovResidual(r, x, b);
+            sol_is_x = true;
+            composite_norminf = krylovNormInf(r);
+            converged = (composite_norminf <= a_res_target);
+            restart = true;
+            continue;
+        }
+
+        if (composite_norminf > Real(1.e20)*a_max_norm)
+        {
+            if (verbose > 0) {
+                amrex::Print() << "MLMG: PCG failing to converge after " << iter
+                               << " iterations. resid, resid/" << a_norm_name << " = "
+                               << composite_norminf << ", "
+                               << composite_norminf/a_max_norm << "\n";
+            }
+            amrex::Abort("MLMG failing so lets stop here");
+        }
+
+        krylovPrecond(z, r, bcterm, iter);
+        const Real rz_new = krylovDot(r, z);
+        const Real beta = (rz_new - krylovDot(rold, z)) / rz;
+        rz = rz_new;
+        krylov_xpay(p, beta, z);
+    }
+
+    if (!sol_is_x) {
+        krylovResidual(r, x, b);
+        composite_norminf = krylovNormInf(r);
+    }
+
+    if (converged) {
+        if (verbose >= 1) {
+            amrex::Print() << "MLMG: PCG Final Iter. " << iter
+                           << " resid, resid/" << a_norm_name << " = "
+                           << composite_norminf << ", "
+                           << composite_norminf/a_max_norm << "\n";
+        }
+    } else if (do_fixed_number_of_iters == 0) {
+        if (verbose > 0) {
+            amrex::Print() << "MLMG: PCG failed to converge after " << iter << " iterations."
+                           << " resid, resid/" << a_norm_name << " = "
+                           << composite_norminf << ", "
+                           << composite_norminf/a_max_norm << "\n";
+        }
+        amrex::Abort("MLMG failed");
+    }
+
+    return composite_norminf;
+}
+
+void
+MLMG::setSolutionHistorySize (int n)
+{
+    sol_history_size = std::max(n, 0);
+    if (static_cast<int>(sol_history.size()) > sol_history_size) {
+        sol_history.clear();
+    }
+}
+
+// Replace the initial guess x_u in sol by x_u + sum_i c_i d_i, where d_i are
+// the corrections of the previous solves.  The c_i minimize
+// |b - L(x_u) - sum_i c_i Lh(d_i)|, found with modified Gram-Schmidt on
+// Lh(d_i).  Because the d_i are corrections, they are zero at the nodes
+// with Dirichlet values in sol, and the boundary data in x_u are kept.
+void
+MLMG::historyInitialGuess ()
+{
+    BL_PROFILE("MLMG::historyInitialGuess()");
+
+    const int ncomp = linop.getNComp();
+
+    if (!sol_history.empty()) {
+        const auto& d0 = sol_history.back();
+        bool same = (static_cast<int>(d0.size()) == namrlevs);
+        for (int alev = 0; same && alev < namrlevs; ++alev) {
+            same = d0[alev].nComp() == ncomp
+                && d0[alev].boxArray() == rhs[alev].boxArray()
+                && d0[alev].DistributionMap() == rhs[alev].DistributionMap();
+        }
+        if (!same) sol_history.clear();
+    }
+
+    makeKrylovVector(sol_history_guess);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(sol_history_guess[alev], *sol[alev], 0, 0, ncomp, 0);
+    }
+
+    const int nh = sol_history.size();
+    sol_history_coef.clear();
+    if (nh == 0) return;
+
+    Vector<MultiFab> b, r, bcterm;
+    makeKrylovVector(b);
+    makeKrylovVector(r);
+    makeKrylovVector(bcterm);
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(b[alev], rhs[alev], 0, 0, ncomp, 0);
+    }
+    krylovBoundaryTerm(bcterm);
+    krylovResidual(r, sol_history_guess, b);
+
+    // Lh(d_i) = Q R, with the dependent columns dropped
+    Vector<Vector<MultiFab> > q(nh);
+    Vector<Real> R(nh*nh, Real(0.0));
+    Vector<int> keep(nh, 0);
+    for (int i = 0; i < nh; ++i)
+    {
+        makeKrylovVector(q[i]);
+        krylovApply(q[i], sol_history[i], bcterm);
+        const Real norm0 = std::sqrt(krylovDot(q[i], q[i]));
+        for (int j = 0; j < i; ++j) {
+            if (keep[j]) {
+                R[j*nh+i] = krylovDot(q[j], q[i]);
+                krylov_saxpy(q[i], -R[j*nh+i], q[j]);
+            }
+        }
+        const Real norm = std::sqrt(krylovDot(q[i], q[i]));
+        if (norm > Real(1.e-10)*norm0) {
+            R[i*nh+i] = norm;
+            krylov_scale(q[i], Real(1.0)/norm);
+            keep[i] = 1;
+        }
+    }
+
+    Vector<Real>& c = sol_history_coef;
+    c.assign(nh, Real(0.0));
+    for (int i = 0; i < nh; ++i) {
+        if (keep[i]) c[i] = krylovDot(q[i], r);
+    }
+    for (int i = nh-1; i >= 0; --i) {
+        if (keep[i]) {
+            for (int j = i+1; j < nh; ++j) {
+                c[i] -= R[i*nh+j] * c[j];
+            }
+            c[i] /= R[i*nh+i];
+        }
+    }
+
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Copy(*sol[alev], sol_history_guess[alev], 0, 0, ncomp, 0);
+        for (int i = 0; i < nh; ++i) {
+            if (keep[i]) {
+                MultiFab::Saxpy(*sol[alev], c[i], sol_history[i][alev], 0, 0, ncomp, 0);
+            }
+        }
+        MultiFab::Copy(rhs[alev], b[alev], 0, 0, ncomp, 0);
+        MultiFab::Copy(sol_history_guess[alev], *sol[alev], 0, 0, ncomp, 0);
+    }
+
+    if (verbose >= 1) {
+        amrex::Print() << "MLMG: Initial guess from " << nh << " previous solves\n";
+    }
+}
+
+// Save the correction of this solve, sol - (x_u + sum_i c_i d_i).  These
+// are much less alike than the solutions, which keeps the least squares
+// problem well conditioned.  When the history is full, it is restarted with
+// the correction from the caller's initial guess, sol - x_u, because
+// dropping the oldest correction would lose most of the solution.
+void
+MLMG::historyRecord ()
+{
+    BL_PROFILE("MLMG::historyRecord()");
+
+    const int ncomp = linop.getNComp();
+    Vector<MultiFab> d = std::move(sol_history_guess);
+    sol_history_guess.clear();
+    for (int alev = 0; alev < namrlevs; ++alev)
+    {
+        MultiFab::Xpay(d[alev], Real(-1.0), *sol[alev], 0, 0, ncomp, 0);
+    }
+    if (static_cast<int>(sol_history.size()) >= sol_history_size) {
+        for (int i = 0; i < static_cast<int>(sol_history_coef.size()); ++i) {
+            if (sol_history_coef[i] != Real(0.0)) {
+                krylov_saxpy(d, sol_history_coef[i], sol_history[i]);
+            }
+        }
+        sol_history.clear();
+    }
+    sol_history.push_back(std::move(d));
+}
+
+}
@@ -289,6 +289,21 @@ MLNodeLaplacian::restriction (int amrlev, int cmglev, MultiFab& crse, MultiFab&
     }
 }
 
+void
+MLNodeLaplacian::correctionResidualRestriction (int amrlev, int cmglev, MultiFab& crse,
+                                                MultiFab& resid, MultiFab& x, const MultiFab& b)
+{
+    BL_PROFILE("MLNodeLaplacian::correctionResidualRestriction()");
+
+    // The full-weighting restriction needs the residual on the nodes
+    // around each coarse node, so it is still stored, but b - L(x) is
+    // computed in one pass.
+    const int fmglev = cmglev-1;
+    applyBC(amrlev, fmglev, x, BCMode::Homogeneous, StateMode::Correction);
+    adotx(amrlev, fmglev, resid, x, &b);
+    restriction(amrlev, cmglev, crse, resid);
+}
+
 void
 MLNodeLaplacian::interpolation (int amrlev, int fmglev, MultiFab& fine, const MultiFab& crse) const
 {
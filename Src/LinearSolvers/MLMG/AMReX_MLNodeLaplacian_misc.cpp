@@ -181,7 +181,13 @@ void
 MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& in) const
 {
     BL_PROFILE("MLNodeLaplacian::Fapply()");
+    adotx(amrlev, mglev, out, in, nullptr);
+}
 
+void
+MLNodeLaplacian::adotx (int amrlev, int mglev, MultiFab& out, const MultiFab& in,
+                        const MultiFab* rhs) const
+{
     const auto& sigma = m_sigma[amrlev][mglev];
     const auto& stencil = m_stencil[amrlev][mglev];
     const auto dxinvarr = m_geom[amrlev][mglev].InvCellSizeArray();
@@ -190,6 +196,7 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
 #endif
 
     const iMultiFab& dmsk = *m_dirichlet_mask[amrlev][mglev];
+    const bool has_rhs = rhs != nullptr;
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -200,13 +207,15 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
         Array4<Real const> const& xarr = in.const_array(mfi);
         Array4<Real> const& yarr = out.array(mfi);
         Array4<int const> const& dmskarr = dmsk.const_array(mfi);
+        Array4<Real const> const& barr = has_rhs ? rhs->const_array(mfi) : Array4<Real const>{};
 
         if (m_coarsening_strategy == CoarseningStrategy::RAP)
         {
             Array4<Real const> const& stenarr = stencil->const_array(mfi);
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_sten(i,j,k,xarr,stenarr,dmskarr);
+                Real y = mlndlap_adotx_sten(i,j,k,xarr,stenarr,dmskarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
         }
         else if (sigma[0] == nullptr)
@@ -215,12 +224,14 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
 #if (AMREX_SPACEDIM == 2)
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_c(i,j,k,xarr,const_sigma,dmskarr, is_rz, dxinvarr);
+                Real y = mlndlap_adotx_c(i,j,k,xarr,const_sigma,dmskarr, is_rz, dxinvarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
 #else
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_c(i,j,k,xarr,const_sigma,dmskarr, dxinvarr);
+                Real y = mlndlap_adotx_c(i,j,k,xarr,const_sigma,dmskarr, dxinvarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
 #endif
         }
@@ -232,14 +243,16 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
 #if (AMREX_SPACEDIM == 2)
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_ha(i,j,k,xarr,AMREX_D_DECL(sxarr,syarr,szarr), dmskarr,
-                                               is_rz, dxinvarr);
+                Real y = mlndlap_adotx_ha(i,j,k,xarr,AMREX_D_DECL(sxarr,syarr,szarr), dmskarr,
+                                          is_rz, dxinvarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
 #else
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_ha(i,j,k,xarr,AMREX_D_DECL(sxarr,syarr,szarr), dmskarr,
-                                               dxinvarr);
+                Real y = mlndlap_adotx_ha(i,j,k,xarr,AMREX_D_DECL(sxarr,syarr,szarr), dmskarr,
+                                          dxinvarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
 #endif
         }
@@ -249,12 +262,14 @@ MLNodeLaplacian::Fapply (int amrlev, int mglev, MultiFab& out, const MultiFab& i
 #if (AMREX_SPACEDIM == 2)
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_aa(i,j,k,xarr,sarr,dmskarr, is_rz, dxinvarr);
+                Real y = mlndlap_adotx_aa(i,j,k,xarr,sarr,dmskarr, is_rz, dxinvarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
 #else
             AMREX_HOST_DEVICE_PARALLEL_FOR_3D ( bx, i, j, k,
             {
-                yarr(i,j,k) = mlndlap_adotx_aa(i,j,k,xarr,sarr,dmskarr, dxinvarr);
+                Real y = mlndlap_adotx_aa(i,j,k,xarr,sarr,dmskarr, dxinvarr);
+                yarr(i,j,k) = has_rhs ? barr(i,j,k) - y : y;
             });
 #endif
        }
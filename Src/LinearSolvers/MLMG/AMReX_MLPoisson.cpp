@@ -402,6 +402,97 @@ MLPoisson::Fsmooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs, i
     }
 }
 
+bool
+MLPoisson::supportsSmoothHalo (int amrlev, int mglev) const
+{
+    return !m_has_metric_term && !m_overset_mask[amrlev][mglev];
+}
+
+void
+MLPoisson::FsmoothHalo (int amrlev, int mglev, MultiFab& solrhs, int redblack, int ngrow) const
+{
+    BL_PROFILE("MLPoisson::FsmoothHalo()");
+
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    AMREX_D_TERM(const Real dhx = dxinv[0]*dxinv[0];,
+                 const Real dhy = dxinv[1]*dxinv[1];,
+                 const Real dhz = dxinv[2]*dxinv[2];);
+
+    // The valid box passed to the kernel is larger than the region
+    // relaxed, so the boundary terms, and the masks, are not used.
+    const Array4<Real const> f;
+    const Array4<int const> m;
+
+    MFItInfo mfi_info;
+    if (Gpu::notInLaunchRegion()) mfi_info.EnableTiling().SetDynamic(true);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(solrhs,mfi_info); mfi.isValid(); ++mfi)
+    {
+        const Box& tbx = mfi.growntilebox(ngrow);
+        const Box& vbx = amrex::grow(mfi.validbox(), ngrow+1);
+        const auto& solnfab = solrhs.array(mfi);
+        const auto rhsfab = Array4<Real const>(solrhs.const_array(mfi), 1);
+
+#if (AMREX_SPACEDIM == 1)
+        AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
+        {
+            mlpoisson_gsrb(thread_box, solnfab, rhsfab, dhx,
+                           f, m, f, m, vbx, redblack);
+        });
+#elif (AMREX_SPACEDIM == 2)
+        AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
+        {
+            mlpoisson_gsrb(thread_box, solnfab, rhsfab, dhx, dhy,
+                           f, m, f, m, f, m, f, m, vbx, redblack);
+        });
+#else
+        AMREX_LAUNCH_HOST_DEVICE_LAMBDA ( tbx, thread_box,
+        {
+            mlpoisson_gsrb(thread_box, solnfab, rhsfab, dhx, dhy, dhz,
+                           f, m, f, m, f, m, f, m, f, m, f, m, vbx, redblack);
+        });
+#endif
+    }
+}
+
+bool
+MLPoisson::supportsResidualRestriction (int amrlev, int mglev) const
+{
+    return !m_has_metric_term && !hasHiddenDimension() && !m_overset_mask[amrlev][mglev];
+}
+
+void
+MLPoisson::FresidualRestriction (int amrlev, int mglev, MultiFab& crse, const MultiFab& x,
+                                 const MultiFab& b, const IntVect& ratio) const
+{
+    BL_PROFILE("MLPoisson::FresidualRestriction()");
+
+    const Real* dxinv = m_geom[amrlev][mglev].InvCellSize();
+    AMREX_D_TERM(const Real dhx = dxinv[0]*dxinv[0];,
+                 const Real dhy = dxinv[1]*dxinv[1];,
+                 const Real dhz = dxinv[2]*dxinv[2];);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(crse, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const auto& cfab = crse.array(mfi);
+        const auto& xfab = x.const_array(mfi);
+        const auto& bfab = b.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_3D_FUSIBLE (bx, i, j, k,
+        {
+            amrex::ignore_unused(j,k);
+            mlpoisson_resid_restriction(AMREX_D_DECL(i,j,k), cfab, xfab, bfab,
+                                        AMREX_D_DECL(dhx,dhy,dhz), ratio);
+        });
+    }
+}
+
 void
 MLPoisson::FFlux (int amrlev, const MFIter& mfi,
                   const Array<FArrayBox*,AMREX_SPACEDIM>& flux,
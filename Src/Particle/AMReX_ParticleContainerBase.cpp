@@ -3,12 +3,17 @@
 #include <AMReX.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
 #include <AMReX_iMultiFab.H>
 
 using namespace amrex;
 
 bool    ParticleContainerBase::do_tiling = false;
 IntVect ParticleContainerBase::tile_size { AMREX_D_DECL(1024000,8,8) };
+int     ParticleContainerBase::load_balance_int = 0;
+Real    ParticleContainerBase::load_balance_mesh_weight = 0.0;
+Real    ParticleContainerBase::load_balance_threshold = 1.1;
+std::string ParticleContainerBase::load_balance_strategy = "knapsack";
 
 void ParticleContainerBase::Define (const Geometry            & geom,
                                     const DistributionMapping & dmap,
@@ -84,6 +89,47 @@ void ParticleContainerBase::SetParticleDistributionMap (int lev, const Distribut
     m_gdb->SetParticleDistributionMap(lev, new_dmap);
 }
 
+bool ParticleContainerBase::BalanceParticleLoad (int lev, const Vector<Long>& np_per_grid)
+{
+    BL_PROFILE("ParticleContainer::BalanceParticleLoad()");
+
+    const BoxArray& ba = ParticleBoxArray(lev);
+    const DistributionMapping& dm = ParticleDistributionMap(lev);
+    AMREX_ALWAYS_ASSERT(np_per_grid.size() == ba.size());
+
+    Vector<Real> cost(ba.size());
+    for (int i = 0; i < ba.size(); ++i) {
+        cost[i] = static_cast<Real>(np_per_grid[i])
+            + load_balance_mesh_weight * static_cast<Real>(ba[i].numPts());
+    }
+
+    Real current_eff = 0.0;
+    DistributionMapping::ComputeDistributionMappingEfficiency(dm, cost, &current_eff);
+
+    Real proposed_eff = 0.0;
+    DistributionMapping new_dm;
+    if (load_balance_strategy == "knapsack") {
+        new_dm = DistributionMapping::makeKnapSack(cost, proposed_eff);
+    } else if (load_balance_strategy == "sfc") {
+        new_dm = DistributionMapping::makeSFC(cost, ba, proposed_eff);
+    } else {
+        amrex::Abort("ParticleContainer: unknown particles.load_balance_strategy "
+                     + load_balance_strategy);
+    }
+
+    const bool improved = proposed_eff > load_balance_threshold * current_eff;
+    if (m_verbose > 0) {
+        amrex::Print() << "ParticleContainer::BalanceParticleLoad: level " << lev
+                       << " efficiency " << current_eff << ", proposed " << proposed_eff
+                       << (improved ? ", rebalanced" : ", kept") << "\n";
+    }
+
+    if (improved) {
+        SetParticleDistributionMap(lev, new_dm);
+    }
+    return improved;
+}
+
 void ParticleContainerBase::SetParticleGeometry (int lev, const Geometry& new_geom)
 {
     m_gdb_object = ParGDB(m_gdb->ParticleGeom(), m_gdb->ParticleDistributionMap(),
@@ -1,4 +1,9 @@
 #include <AMReX_ParticleUtil.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <iostream>
+#include <sstream>
 
 #ifdef AMREX_USE_HDF5_ASYNC
 #include <hdf5.h>
@@ -72,6 +77,60 @@ Vector<int> computeNeighborProcs (const ParGDBBase* a_gdb, int ngrow)
     return neighbor_procs;
 }
 
+Vector<int>
+ParticleFileIndex::gridsIntersecting (const RealBox& region) const
+{
+    Vector<int> r;
+    for (int i = 0, N = count.size(); i < N; ++i) {
+        if (count[i] > 0 && bounds[i].intersects(region)) {
+            r.push_back(i);
+        }
+    }
+    return r;
+}
+
+void
+ParticleFileIndex::writeOn (std::ostream& os) const
+{
+    const auto old_prec = os.precision(17);
+    os << count.size() << '\n';
+    for (int i = 0, N = count.size(); i < N; ++i) {
+        os << which[i] << ' ' << count[i] << ' ' << where[i] << ' ' << bounds[i] << '\n';
+    }
+    os.precision(old_prec);
+}
+
+void
+ParticleFileIndex::readFrom (std::istream& is)
+{
+    int ngrids = 0;
+    is >> ngrids;
+    which.resize(ngrids);
+    count.resize(ngrids);
+    where.resize(ngrids);
+    bounds.resize(ngrids);
+    for (int i = 0; i < ngrids; ++i) {
+        is >> which[i] >> count[i] >> where[i] >> bounds[i];
+    }
+    if ( ! is.good()) {
+        amrex::Abort("ParticleFileIndex::readFrom: failed to read the index");
+    }
+}
+
+bool
+ParticleFileIndex::read (const std::string& filename)
+{
+    int exist = ParallelDescriptor::IOProcessor() ? amrex::FileExists(filename) : 0;
+    ParallelDescriptor::Bcast(&exist, 1, ParallelDescriptor::IOProcessorNumber());
+    if ( ! exist) { return false; }
+
+    Vector<char> chars;
+    ParallelDescriptor::ReadAndBcastFile(filename, chars);
+    std::istringstream is(std::string(chars.dataPtr()), std::istringstream::in);
+    readFrom(is);
+    return true;
+}
+
 #ifdef AMREX_USE_HDF5_ASYNC
 void async_vol_es_wait_particle()
 {
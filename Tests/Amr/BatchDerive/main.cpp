@@ -0,0 +1,312 @@
+// Compute derived quantities one name at a time and all together with the
+// batched AmrLevel::derive, on two levels and with ghost cells, and check
+// that the results are the same bit for bit.  The quantities use
+// contiguous and scattered state components, two state types and a grown
+// box.  The plotfiles written with amr.batch_derive = 0 and 1 are compared
+// too.
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_TagBox.H>
+#include <AMReX_FileSystem.H>
+
+using namespace amrex;
+
+extern "C" {
+    void amrex_probinit (const int* /*init*/, const int* /*name*/, const int* /*namelen*/,
+                         const amrex_real* /*problo*/, const amrex_real* /*probhi*/)
+    {}
+}
+
+namespace {
+
+void nullfill (Box const& /*bx*/, FArrayBox& /*data*/, const int /*dcomp*/, const int /*numcomp*/,
+               Geometry const& /*geom*/, const Real /*time*/, const Vector<BCRec>& /*bcr*/,
+               const int /*bcomp*/, const int /*scomp*/)
+{}
+
+// a+b from state 0
+void der_sum (const Box& bx, FArrayBox& derfab, int dcomp, int /*ncomp*/,
+              const FArrayBox& datafab, const Geometry& /*geom*/,
+              Real /*time*/, const int* /*bcrec*/, int /*level*/)
+{
+    auto const d = derfab.array(dcomp);
+    auto const s = datafab.const_array();
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k)
+    {
+        d(i,j,k) = s(i,j,k,0) + s(i,j,k,1);
+    });
+}
+
+// Laplacian of c, which needs one more ghost cell
+void der_lap (const Box& bx, FArrayBox& derfab, int dcomp, int /*ncomp*/,
+              const FArrayBox& datafab, const Geometry& geom,
+              Real /*time*/, const int* /*bcrec*/, int /*level*/)
+{
+    auto const d = derfab.array(dcomp);
+    auto const s = datafab.const_array();
+    const auto dxinv = geom.InvCellSizeArray();
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k)
+    {
+        d(i,j,k) = (s(i-1,j,k) - 2.0*s(i,j,k) + s(i+1,j,k))*dxinv[0]*dxinv[0]
+            +      (s(i,j-1,k) - 2.0*s(i,j,k) + s(i,j+1,k))*dxinv[1]*dxinv[1]
+            +      (s(i,j,k-1) - 2.0*s(i,j,k) + s(i,j,k+1))*dxinv[2]*dxinv[2];
+    });
+}
+
+// a*c - d, from components that are not contiguous and two state types
+void der_mix (const Box& bx, FArrayBox& derfab, int dcomp, int /*ncomp*/,
+              const FArrayBox& datafab, const Geometry& /*geom*/,
+              Real /*time*/, const int* /*bcrec*/, int /*level*/)
+{
+    auto const d = derfab.array(dcomp);
+    auto const s = datafab.const_array();
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k)
+    {
+        d(i,j,k) = s(i,j,k,0)*s(i,j,k,1) - s(i,j,k,2);
+    });
+}
+
+}
+
+class AmrLevelDer
+    : public AmrLevel
+{
+public:
+
+    AmrLevelDer () {}
+
+    AmrLevelDer (Amr& papa, int lev, const Geometry& level_geom,
+                 const BoxArray& bl, const DistributionMapping& dm, Real time)
+        : AmrLevel(papa,lev,level_geom,bl,dm,time) {}
+
+    static void variableSetUp ()
+    {
+        BCRec bc;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            bc.setLo(idim, BCType::int_dir);
+            bc.setHi(idim, BCType::int_dir);
+        }
+        StateDescriptor::BndryFunc bndryfunc(nullfill);
+        bndryfunc.setRunOnGPU(true);
+
+        desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                               1, 3, &cell_cons_interp);
+        desc_lst.setComponent(0, 0, "a", bc, bndryfunc);
+        desc_lst.setComponent(0, 1, "b", bc, bndryfunc);
+        desc_lst.setComponent(0, 2, "c", bc, bndryfunc);
+        desc_lst.addDescriptor(1, IndexType::TheCellType(), StateDescriptor::Point,
+                               1, 1, &cell_cons_interp);
+        desc_lst.setComponent(1, 0, "d", bc, bndryfunc);
+
+        derive_lst.add("sum_ab", IndexType::TheCellType(), 1, der_sum, DeriveRec::TheSameBox);
+        derive_lst.addComponent("sum_ab", desc_lst, 0, 0, 2);
+
+        derive_lst.add("lap_c", IndexType::TheCellType(), 1, der_lap, DeriveRec::GrowBoxByOne);
+        derive_lst.addComponent("lap_c", desc_lst, 0, 2, 1);
+
+        derive_lst.add("mix", IndexType::TheCellType(), 1, der_mix, DeriveRec::TheSameBox);
+        derive_lst.addComponent("mix", desc_lst, 0, 0, 1);
+        derive_lst.addComponent("mix", desc_lst, 0, 2, 1);
+        derive_lst.addComponent("mix", desc_lst, 1, 0, 1);
+
+        // Only c, which is contiguous in the filled data of sum_ab and lap_c
+        derive_lst.add("c_again", IndexType::TheCellType(), 1, der_lap, DeriveRec::GrowBoxByOne);
+        derive_lst.addComponent("c_again", desc_lst, 0, 2, 1);
+    }
+
+    static void variableCleanUp () { desc_lst.clear(); derive_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int /*sub_cycle*/, Vector<int>& n_cycle,
+                                   const Vector<IntVect>& /*ref_ratio*/,
+                                   Vector<Real>& dt_level, Real /*stop_time*/) override
+    {
+        Real dt = 0.1;
+        for (int i = 0; i <= finest_level; ++i) {
+            dt_level[i] = dt;
+            if (i < finest_level) dt /= n_cycle[i+1];
+        }
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Vector<int>& n_cycle,
+                               const Vector<IntVect>& ref_ratio, Vector<Real>& /*dt_min*/,
+                               Vector<Real>& dt_level, Real stop_time,
+                               int /*post_regrid_flag*/) override
+    {
+        computeInitialDt(finest_level, sub_cycle, n_cycle, ref_ratio, dt_level, stop_time);
+    }
+
+    virtual Real advance (Real /*time*/, Real dt, int /*iteration*/, int /*ncycle*/) override
+    {
+        return dt;
+    }
+
+    virtual void post_timestep (int /*iteration*/) override {}
+    virtual void post_regrid (int /*lbase*/, int /*new_finest*/) override {}
+    virtual void post_init (Real /*stop_time*/) override {}
+
+    virtual void initData () override
+    {
+        const auto problo = geom.ProbLoArray();
+        const auto dx = geom.CellSizeArray();
+        for (int k = 0; k < desc_lst.size(); ++k)
+        {
+            MultiFab& S_new = get_new_data(k);
+            const int ncomp = S_new.nComp();
+            const Real kk = k;
+            for (MFIter mfi(S_new); mfi.isValid(); ++mfi) {
+                auto const& s = S_new.array(mfi);
+                amrex::ParallelFor(mfi.validbox(), ncomp,
+                [=] AMREX_GPU_DEVICE (int i, int j, int kc, int n)
+                {
+                    const Real x = problo[0] + (i+0.5)*dx[0];
+                    const Real y = problo[1] + (j+0.5)*dx[1];
+                    const Real z = problo[2] + (kc+0.5)*dx[2];
+                    s(i,j,kc,n) = std::sin(6.28318530717958648*(x + (n+1)*y + kk*z))
+                        + (n+1)*std::cos(6.28318530717958648*z);
+                });
+            }
+        }
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        const Real dt_new = parent->dtLevel(level);
+        const Real cur_time = old.get_state_data(0).curTime();
+        const Real prev_time = old.get_state_data(0).prevTime();
+        setTimeLevel(cur_time, cur_time-prev_time, dt_new);
+        for (int k = 0; k < desc_lst.size(); ++k) {
+            MultiFab& S_new = get_new_data(k);
+            FillPatch(old, S_new, 0, cur_time, k, 0, S_new.nComp());
+        }
+    }
+
+    virtual void init () override
+    {
+        const Real dt = parent->dtLevel(level);
+        const Real cur_time = parent->getLevel(level-1).get_state_data(0).curTime();
+        const Real prev_time = parent->getLevel(level-1).get_state_data(0).prevTime();
+        setTimeLevel(cur_time, (cur_time-prev_time)/parent->MaxRefRatio(level-1), dt);
+        for (int k = 0; k < desc_lst.size(); ++k) {
+            MultiFab& S_new = get_new_data(k);
+            FillCoarsePatch(S_new, 0, cur_time, k, 0, S_new.nComp());
+        }
+    }
+
+    // Refine a fixed region.
+    virtual void errorEst (TagBoxArray& tags, int /*clearval*/, int tagval, Real /*time*/,
+                           int /*n_error_buf*/, int /*ngrow*/) override
+    {
+        const auto problo = geom.ProbLoArray();
+        const auto dx = geom.CellSizeArray();
+        const char tv = tagval;
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            auto const& t = tags.array(mfi);
+            amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                const Real x = problo[0] + (i+0.5)*dx[0];
+                const Real y = problo[1] + (j+0.5)*dx[1];
+                if (x > 0.125 && x < 0.625 && y > 0.25 && y < 0.75) {
+                    t(i,j,k) = tv;
+                }
+            });
+        }
+    }
+};
+
+class LevelBldDer
+    : public LevelBld
+{
+    virtual void variableSetUp () override { AmrLevelDer::variableSetUp(); }
+    virtual void variableCleanUp () override { AmrLevelDer::variableCleanUp(); }
+    virtual AmrLevel* operator() () override { return new AmrLevelDer; }
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new AmrLevelDer(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+LevelBldDer der_bld;
+
+namespace {
+
+void checkSame (const MultiFab& a, const MultiFab& b, const std::string& what)
+{
+    MultiFab diff(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrow());
+    MultiFab::Copy(diff, a, 0, 0, a.nComp(), a.nGrow());
+    MultiFab::Subtract(diff, b, 0, 0, a.nComp(), a.nGrow());
+    for (int n = 0; n < a.nComp(); ++n) {
+        const Real err = diff.norm0(n, a.nGrow());
+        if (err != 0.0) {
+            amrex::Print() << what << ": component " << n << " differs by " << err << "\n";
+            amrex::Abort("BatchDerive: " + what + " differs");
+        }
+    }
+    amrex::Print() << "  " << what << ": same\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        const Vector<std::string> names{"sum_ab", "b", "lap_c", "mix", "c_again", "d"};
+        const int nnames = names.size();
+
+        Amr amr(&der_bld);
+        amr.init(0.0, -1.0);
+        if (amr.finestLevel() != 1) {
+            amrex::Abort("BatchDerive: expected two levels");
+        }
+
+        for (int lev = 0; lev <= amr.finestLevel(); ++lev)
+        {
+            AmrLevel& level = amr.getLevel(lev);
+            const Real time = level.get_state_data(0).curTime();
+            for (int ng = 0; ng <= 2; ng += 2)
+            {
+                MultiFab single(level.boxArray(), level.DistributionMap(), nnames+1, ng);
+                MultiFab batch(level.boxArray(), level.DistributionMap(), nnames+1, ng);
+                single.setVal(0.0);
+                batch.setVal(0.0);
+                for (int i = 0; i < nnames; ++i) {
+                    level.derive(names[i], time, single, i+1);
+                }
+                level.derive(names, time, batch, 1);
+                checkSame(single, batch, "level " + std::to_string(lev) + " with "
+                          + std::to_string(ng) + " ghost cells");
+            }
+        }
+
+        // Plotfiles with and without amr.batch_derive
+        ParmParse pp("amr");
+        for (int batch = 0; batch < 2; ++batch)
+        {
+            pp.add("batch_derive", batch);
+            amr.getLevel(0).setPlotVariables();
+            amr.writePlotFile();
+            ParallelDescriptor::Barrier();
+            if (ParallelDescriptor::IOProcessor()) {
+                FileSystem::RemoveAll(batch ? "plt_batch" : "plt_single");
+                std::rename("plt00000", batch ? "plt_batch" : "plt_single");
+            }
+            ParallelDescriptor::Barrier();
+        }
+        PlotFileData single("plt_single"), batch("plt_batch");
+        if (single.varNames() != batch.varNames() || single.nComp() != 8) {
+            amrex::Abort("BatchDerive: wrong plot variables");
+        }
+        for (int lev = 0; lev <= amr.finestLevel(); ++lev) {
+            batch.syncDistributionMap(lev, single);
+            checkSame(single.get(lev), batch.get(lev), "plotfile level " + std::to_string(lev));
+        }
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,327 @@
+// Write checkpoints while advancing a small two-level problem, restart
+// from some of them and check that the restarted state is bit for bit
+// the same as the state that was written.  With amr.checkpoint_full_int
+// > 1 most of the checkpoints are differential.  With amrex.async_out and
+// stage_dir, the run is repeated with the checkpoints staged in stage_dir.
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_TagBox.H>
+#include <AMReX_FileSystem.H>
+#include <AMReX_AsyncOut.H>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+using namespace amrex;
+
+extern "C" {
+    void amrex_probinit (const int* /*init*/, const int* /*name*/, const int* /*namelen*/,
+                         const amrex_real* /*problo*/, const amrex_real* /*probhi*/)
+    {}
+}
+
+namespace {
+
+void nullfill (Box const& /*bx*/, FArrayBox& /*data*/, const int /*dcomp*/, const int /*numcomp*/,
+               Geometry const& /*geom*/, const Real /*time*/, const Vector<BCRec>& /*bcr*/,
+               const int /*bcomp*/, const int /*scomp*/)
+{}
+
+}
+
+class AmrLevelChk
+    : public AmrLevel
+{
+public:
+
+    AmrLevelChk () {}
+
+    AmrLevelChk (Amr& papa, int lev, const Geometry& level_geom,
+                 const BoxArray& bl, const DistributionMapping& dm, Real time)
+        : AmrLevel(papa,lev,level_geom,bl,dm,time) {}
+
+    static void variableSetUp ()
+    {
+        desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                               0, 2, &cell_cons_interp);
+        BCRec bc;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            bc.setLo(idim, BCType::int_dir);
+            bc.setHi(idim, BCType::int_dir);
+        }
+        StateDescriptor::BndryFunc bndryfunc(nullfill);
+        bndryfunc.setRunOnGPU(true);
+        desc_lst.setComponent(0, 0, "a", bc, bndryfunc);
+        desc_lst.setComponent(0, 1, "b", bc, bndryfunc);
+    }
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int /*sub_cycle*/, Vector<int>& n_cycle,
+                                   const Vector<IntVect>& /*ref_ratio*/,
+                                   Vector<Real>& dt_level, Real /*stop_time*/) override
+    {
+        Real dt = 0.1;
+        for (int i = 0; i <= finest_level; ++i) {
+            dt_level[i] = dt;
+            if (i < finest_level) dt /= n_cycle[i+1];
+        }
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Vector<int>& n_cycle,
+                               const Vector<IntVect>& ref_ratio, Vector<Real>& /*dt_min*/,
+                               Vector<Real>& dt_level, Real stop_time,
+                               int /*post_regrid_flag*/) override
+    {
+        computeInitialDt(finest_level, sub_cycle, n_cycle, ref_ratio, dt_level, stop_time);
+    }
+
+    // Only the data near the low x end change, so that a differential
+    // checkpoint has to write some of the FABs only.
+    virtual Real advance (Real /*time*/, Real dt, int /*iteration*/, int /*ncycle*/) override
+    {
+        for (int k = 0; k < desc_lst.size(); ++k) {
+            state[k].allocOldData();
+            state[k].swapTimeLevels(dt);
+        }
+        MultiFab const& S_old = get_old_data(0);
+        MultiFab& S_new = get_new_data(0);
+        const auto problo = geom.ProbLoArray();
+        const auto dx = geom.CellSizeArray();
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const& sold = S_old.const_array(mfi);
+            auto const& snew = S_new.array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                const Real x = problo[0] + (i+0.5)*dx[0];
+                const Real f = (x < 0.25) ? 1.0 + x : 0.0;
+                snew(i,j,k,0) = sold(i,j,k,0) + dt*f;
+                snew(i,j,k,1) = sold(i,j,k,1);
+            });
+        }
+        return dt;
+    }
+
+    virtual void post_timestep (int /*iteration*/) override {}
+    virtual void post_regrid (int /*lbase*/, int /*new_finest*/) override {}
+    virtual void post_init (Real /*stop_time*/) override {}
+
+    virtual void initData () override
+    {
+        MultiFab& S_new = get_new_data(0);
+        const auto problo = geom.ProbLoArray();
+        const auto dx = geom.CellSizeArray();
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const& s = S_new.array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                AMREX_D_TERM(const Real x = problo[0] + (i+0.5)*dx[0];,
+                             const Real y = problo[1] + (j+0.5)*dx[1];,
+                             const Real z = problo[2] + (k+0.5)*dx[2];);
+                s(i,j,k,0) = AMREX_D_TERM(std::sin(6.0*x), + std::cos(4.0*y), + x*z);
+                s(i,j,k,1) = static_cast<Real>(i+2*j+3*k);
+            });
+        }
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        const Real dt_new = parent->dtLevel(level);
+        const Real cur_time = old.get_state_data(0).curTime();
+        const Real prev_time = old.get_state_data(0).prevTime();
+        setTimeLevel(cur_time, cur_time-prev_time, dt_new);
+        MultiFab& S_new = get_new_data(0);
+        FillPatch(old, S_new, 0, cur_time, 0, 0, S_new.nComp());
+    }
+
+    virtual void init () override
+    {
+        const Real dt = parent->dtLevel(level);
+        const Real cur_time = parent->getLevel(level-1).get_state_data(0).curTime();
+        const Real prev_time = parent->getLevel(level-1).get_state_data(0).prevTime();
+        setTimeLevel(cur_time, (cur_time-prev_time)/parent->MaxRefRatio(level-1), dt);
+        MultiFab& S_new = get_new_data(0);
+        FillCoarsePatch(S_new, 0, cur_time, 0, 0, S_new.nComp());
+    }
+
+    // Refine a fixed region.
+    virtual void errorEst (TagBoxArray& tags, int /*clearval*/, int tagval, Real /*time*/,
+                           int /*n_error_buf*/, int /*ngrow*/) override
+    {
+        const auto problo = geom.ProbLoArray();
+        const auto dx = geom.CellSizeArray();
+        const char tv = tagval;
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            auto const& t = tags.array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                const Real x = problo[0] + (i+0.5)*dx[0];
+                const Real y = problo[1] + (j+0.5)*dx[1];
+                if (x > 0.125 && x < 0.625 && y > 0.25 && y < 0.75) {
+                    t(i,j,k) = tv;
+                }
+            });
+        }
+    }
+};
+
+class LevelBldChk
+    : public LevelBld
+{
+    virtual void variableSetUp () override { AmrLevelChk::variableSetUp(); }
+    virtual void variableCleanUp () override { AmrLevelChk::variableCleanUp(); }
+    virtual AmrLevel* operator() () override { return new AmrLevelChk; }
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new AmrLevelChk(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+LevelBldChk chk_bld;
+
+namespace {
+
+using State = Vector<std::unique_ptr<MultiFab> >;
+
+State copyState (Amr& amr)
+{
+    State r;
+    for (int lev = 0; lev <= amr.finestLevel(); ++lev) {
+        MultiFab const& S = amr.getLevel(lev).get_new_data(0);
+        r.emplace_back(std::make_unique<MultiFab>(S.boxArray(), S.DistributionMap(),
+                                                  S.nComp(), 0));
+        MultiFab::Copy(*r.back(), S, 0, 0, S.nComp(), 0);
+    }
+    return r;
+}
+
+void checkRestart (std::string const& chkfile, State const& expected, int step)
+{
+    ParmParse pp("amr");
+    pp.add("restart", chkfile);
+
+    Amr amr(&chk_bld);
+    amr.init(0.0, -1.0);
+
+    if (amr.levelSteps(0) != step) {
+        amrex::Abort("Checkpoint test: wrong step after restarting from "+chkfile);
+    }
+    if (amr.finestLevel()+1 != static_cast<int>(expected.size())) {
+        amrex::Abort("Checkpoint test: wrong number of levels after restarting from "+chkfile);
+    }
+
+    for (int lev = 0; lev <= amr.finestLevel(); ++lev) {
+        MultiFab const& S = amr.getLevel(lev).get_new_data(0);
+        if (S.boxArray() != expected[lev]->boxArray()) {
+            amrex::Abort("Checkpoint test: wrong grids after restarting from "+chkfile);
+        }
+        MultiFab ediff(S.boxArray(), S.DistributionMap(), S.nComp(), 0);
+        ediff.ParallelCopy(*expected[lev], 0, 0, S.nComp());
+        ediff.minus(S, 0, S.nComp(), 0);
+        Real err = 0.0;
+        for (int n = 0; n < S.nComp(); ++n) {
+            err = std::max(err, ediff.norm0(n));
+        }
+        amrex::Print() << "  " << chkfile << " level " << lev << ": max error " << err << "\n";
+        if (err != 0.0) {
+            amrex::Abort("Checkpoint test: restart from "+chkfile+" does not reproduce the state");
+        }
+    }
+}
+
+void runAndRestart (std::string const& check_file, int max_step,
+                    Vector<int> const& restart_steps, int checkpoint_full_int)
+{
+    {
+        ParmParse pp("amr");
+        pp.add("restart", std::string("init"));
+    }
+
+    std::map<int,State> states;
+    {
+        Amr amr(&chk_bld);
+        amr.init(0.0, -1.0);
+        while (amr.levelSteps(0) < max_step) {
+            amr.coarseTimeStep(-1.0);
+            states[amr.levelSteps(0)] = copyState(amr);
+        }
+    }
+
+    if (AsyncOut::UseAsyncOut()) {
+        AsyncOut::Finish();
+        ParallelDescriptor::Barrier();
+    }
+
+    for (int step : restart_steps) {
+        const std::string chkfile = amrex::Concatenate(check_file, step);
+        if (checkpoint_full_int > 1 && !amrex::FileExists(chkfile+"/DifferentialBase")) {
+            amrex::Abort("Checkpoint test: "+chkfile+" is not a differential checkpoint");
+        }
+        amrex::Print() << "Restarting from " << chkfile << "\n";
+        checkRestart(chkfile, states[step], step);
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int max_step = 5;
+        Vector<int> restart_steps{3,5};
+        std::string stage_dir;
+        {
+            ParmParse pp;
+            pp.query("max_step", max_step);
+            pp.queryarr("restart_steps", restart_steps);
+            pp.query("stage_dir", stage_dir);
+        }
+
+        std::string check_file("chk");
+        int checkpoint_full_int = 0;
+        {
+            ParmParse pp("amr");
+            pp.query("check_file", check_file);
+            pp.query("checkpoint_full_int", checkpoint_full_int);
+        }
+
+        runAndRestart(check_file, max_step, restart_steps, checkpoint_full_int);
+
+        // Do it again with the checkpoints staged in stage_dir.  All of
+        // them must have been drained and renamed when Amr is destroyed.
+        if (!stage_dir.empty() && AsyncOut::UseAsyncOut())
+        {
+            const std::string staged_file = check_file + "_staged";
+            {
+                ParmParse pp("amr");
+                pp.add("checkpoint_stage_dir", stage_dir);
+                pp.add("check_file", staged_file);
+            }
+
+            amrex::Print() << "Staging checkpoints in " << stage_dir << "\n";
+            runAndRestart(staged_file, max_step, restart_steps, checkpoint_full_int);
+
+            for (int step = 0; step <= max_step; ++step) {
+                const std::string chkfile = amrex::Concatenate(staged_file, step);
+                if (!amrex::FileExists(chkfile+"/Header") || amrex::FileExists(chkfile+".temp")) {
+                    amrex::Abort("Checkpoint test: "+chkfile+" has not been drained");
+                }
+            }
+            if (!FileSystem::ListFiles(stage_dir).empty()) {
+                amrex::Abort("Checkpoint test: the staging directory has not been emptied");
+            }
+        }
+    }
+    amrex::Finalize();
+}
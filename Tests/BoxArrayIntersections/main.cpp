@@ -0,0 +1,202 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Grids with large boxes in one half of the domain and small boxes in the
+// other, roughly what refined levels with a mix of blocking look like.
+BoxArray makeGrids (int n_cell, int coarse_size, int fine_size)
+{
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    Box lo = domain, hi = domain;
+    lo.setBig(0, n_cell/2-1);
+    hi.setSmall(0, n_cell/2);
+
+    BoxList bl;
+    BoxArray ba_lo(lo);
+    ba_lo.maxSize(coarse_size);
+    BoxArray ba_hi(hi);
+    ba_hi.maxSize(fine_size);
+    bl.join(ba_lo.boxList());
+    bl.join(ba_hi.boxList());
+    return BoxArray(std::move(bl));
+}
+
+Long queryAll (const BoxArray& ba, const Vector<Box>& queries, int ng)
+{
+    Long nisects = 0;
+    std::vector<std::pair<int,Box> > isects;
+    for (auto const& q : queries) {
+        ba.intersections(q, isects, false, IntVect(ng));
+        nisects += static_cast<Long>(isects.size());
+    }
+    return nisects;
+}
+
+// Appends the sorted intersections of every stride-th query to result, and
+// checks them against a brute force search over the boxes.
+void collect (const BoxArray& ba, const Vector<Box>& queries, int ng,
+              int stride, Vector<int>& result)
+{
+    std::vector<std::pair<int,Box> > isects;
+    for (int i = 0; i < queries.size(); i += stride) {
+        const Box q = amrex::convert(queries[i], ba.ixType());
+        ba.intersections(q, isects, false, IntVect(ng));
+        std::sort(isects.begin(), isects.end(),
+                  [] (std::pair<int,Box> const& a, std::pair<int,Box> const& b)
+                  { return a.first < b.first; });
+
+        std::vector<std::pair<int,Box> > expected;
+        for (int j = 0; j < ba.size(); ++j) {
+            const Box bx = amrex::grow(ba[j],ng) & q;
+            if (bx.ok()) { expected.push_back(std::make_pair(j,bx)); }
+        }
+        if (isects != expected) {
+            amrex::Abort("BoxArrayIntersections: intersections differ from brute force");
+        }
+
+        result.push_back(-1);
+        for (auto const& is : isects) {
+            result.push_back(is.first);
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                result.push_back(is.second.smallEnd(idim));
+                result.push_back(is.second.bigEnd(idim));
+            }
+        }
+    }
+}
+
+// The complement of the non-overlapping ba in q must be disjoint from ba and
+// make up the rest of q.
+void collectComplement (const BoxArray& ba, const Vector<Box>& queries,
+                        int stride, Vector<int>& result)
+{
+    std::vector<std::pair<int,Box> > isects;
+    for (int i = 0; i < queries.size(); i += stride) {
+        const Box q = amrex::convert(queries[i], ba.ixType());
+        const BoxList bl = ba.complementIn(q);
+        Long npts = 0;
+        for (auto const& b : bl) {
+            if (ba.intersects(b)) {
+                amrex::Abort("BoxArrayIntersections: complementIn overlaps the BoxArray");
+            }
+            npts += b.numPts();
+        }
+        ba.intersections(q, isects);
+        for (auto const& is : isects) { npts += is.second.numPts(); }
+        if (npts != q.numPts()) {
+            amrex::Abort("BoxArrayIntersections: complementIn misses part of the box");
+        }
+        result.push_back(static_cast<int>(bl.size()));
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 1024;
+    int coarse_size = 256;
+    int fine_size = 32;
+    int nqueries = 100000;
+    int ng = 2;
+    int nchecks = 100;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("coarse_size", coarse_size);
+        pp.query("fine_size", fine_size);
+        pp.query("nqueries", nqueries);
+        pp.query("ng", ng);
+        pp.query("nchecks", nchecks);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const BoxArray ba0 = makeGrids(n_cell, coarse_size, fine_size);
+
+    Vector<Box> queries;
+    queries.reserve(nqueries);
+    for (int i = 0; i < nqueries; ++i) {
+        IntVect lo, len;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            lo[idim] = static_cast<int>(amrex::Random_int(n_cell));
+            len[idim] = 1 + static_cast<int>(amrex::Random_int(2*fine_size));
+        }
+        queries.push_back(Box(lo, lo+len-1) & domain);
+    }
+
+    amrex::Print() << "BoxArray size " << ba0.size() << ", " << nqueries
+                   << " queries with " << ng << " ghost cells\n";
+
+    const BoxArray::IndexPolicy policies[] = {BoxArray::IndexPolicy::Hash,
+                                              BoxArray::IndexPolicy::Bins,
+                                              BoxArray::IndexPolicy::Auto};
+    const char* names[] = {"hash", "bins", "auto"};
+    const int stride = nqueries/nchecks + 1;
+    Vector<Vector<int> > result(3);
+
+    for (int ip = 0; ip < 3; ++ip)
+    {
+        BoxArray::SetIndexPolicy(policies[ip]);
+        BoxArray::SetBinsThreshold(0);
+        BoxArray ba(ba0.boxList());
+
+        double t0 = amrex::ParallelDescriptor::second();
+        std::vector<std::pair<int,Box> > isects;
+        ba.intersections(queries[0], isects);
+        double t_build = amrex::ParallelDescriptor::second() - t0;
+
+        t0 = amrex::ParallelDescriptor::second();
+        Long nisects = queryAll(ba, queries, ng);
+        double t_query = amrex::ParallelDescriptor::second() - t0;
+
+        amrex::Print() << "  " << names[ip] << ": build " << t_build
+                       << " s, queries " << t_query << " s, index "
+                       << ba.indexBytes() << " bytes, intersections "
+                       << nisects << "\n";
+
+        collect(ba, queries, ng, stride, result[ip]);
+        collectComplement(ba, queries, stride, result[ip]);
+
+        // BoxArrays sharing the index through a BATransformer
+        const BoxArray nba = amrex::convert(ba, IntVect(1));
+        collect(nba, queries, ng, stride, result[ip]);
+        const BoxArray xba = amrex::convert(ba, IntVect::TheDimensionVector(0));
+        collect(xba, queries, 0, stride, result[ip]);
+        const BoxArray cba = amrex::coarsen(ba, 2);
+        collect(cba, queries, ng, stride, result[ip]);
+        collectComplement(cba, queries, stride, result[ip]);
+        const BoxArray bba(ba, BATransformer(Orientation(1,Orientation::high),
+                                             IndexType::TheCellType(), 1, 0, 1));
+        collect(bba, queries, 0, stride, result[ip]);
+
+        // A coarsened BoxArray with an index of its own
+        const BoxArray ccba(amrex::coarsen(ba0, IntVect(4)).boxList());
+        collect(ccba, queries, ng, stride, result[ip]);
+        collectComplement(ccba, queries, stride, result[ip]);
+    }
+
+    BoxArray::SetIndexPolicy(BoxArray::IndexPolicy::Auto);
+
+    if (result[0] != result[1] || result[0] != result[2]) {
+        amrex::Abort("BoxArrayIntersections: hash and bins give different intersections");
+    }
+    amrex::Print() << "  hash and bins agree\n";
+}
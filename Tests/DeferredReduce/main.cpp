@@ -0,0 +1,133 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_DeferredReduce.H>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+template <typename T>
+void checkEqual (T a, T b, const std::string& name)
+{
+    if (!(a == b)) {
+        amrex::Print() << name << ": " << a << " != " << b << "\n";
+        amrex::Abort("DeferredReduce: wrong result for " + name);
+    }
+}
+
+void checkCount (Long a, Long b, const std::string& name)
+{
+    if (a != b) {
+        amrex::Print() << name << ": " << a << " != " << b << "\n";
+        amrex::Abort("DeferredReduce: wrong count for " + name);
+    }
+}
+
+}
+
+void test ()
+{
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    // Values that differ by process, against the blocking reductions.
+    const Real r = 1.5_rt + myproc*0.25_rt;
+    const int  i = 3*myproc - 7;
+    const Long l = 1000000000000L + myproc;
+    Vector<Real> rv{r, -r, 2.0_rt*r};
+
+    Real r_sum = r, r_min = r, r_max = r;
+    ParallelDescriptor::ReduceRealSum(r_sum);
+    ParallelDescriptor::ReduceRealMin(r_min);
+    ParallelDescriptor::ReduceRealMax(r_max);
+    int i_sum = i, i_max = i;
+    ParallelDescriptor::ReduceIntSum(i_sum);
+    ParallelDescriptor::ReduceIntMax(i_max);
+    Long l_sum = l;
+    ParallelDescriptor::ReduceLongSum(l_sum);
+    Vector<Real> rv_max = rv;
+    ParallelDescriptor::ReduceRealMax(rv_max.data(), rv_max.size());
+
+    const Long started0 = DeferredReduce::NumStarted();
+
+    auto h_rsum  = DeferredReduce::Sum(r);
+    auto h_rmin  = DeferredReduce::Min(r);
+    auto h_rmax  = DeferredReduce::Max(r);
+    auto h_isum  = DeferredReduce::Sum(i);
+    auto h_imax  = DeferredReduce::Max(i);
+    auto h_lsum  = DeferredReduce::Sum(l);
+    auto h_rvmax = DeferredReduce::Max(rv.data(), rv.size());
+    auto h_rsum2 = DeferredReduce::Sum(2.0_rt*r);
+
+    // Nothing is sent until a result is needed.
+    checkCount(DeferredReduce::NumPending(), 10, "pending before access");
+    checkCount(DeferredReduce::NumStarted()-started0, 0, "started before access");
+
+    // Accessing one result starts all the batches: real sum, min and max,
+    // int sum and max, and long sum.
+    checkEqual(h_rsum.get(), r_sum, "Real sum");
+    checkCount(DeferredReduce::NumPending(), 0, "pending after access");
+    checkCount(DeferredReduce::NumStarted()-started0, 6, "started after access");
+
+    checkEqual(h_rmin.get(), r_min, "Real min");
+    checkEqual(h_rmax.get(), r_max, "Real max");
+    checkEqual(h_isum.get(), i_sum, "int sum");
+    checkEqual(h_imax.get(), i_max, "int max");
+    checkEqual(h_lsum.get(), l_sum, "Long sum");
+    checkEqual(h_rsum2.get(), 2.0_rt*r_sum, "second Real sum in the batch");
+    checkCount(h_rvmax.size(), 3, "array size");
+    for (int n = 0; n < 3; ++n) {
+        checkEqual(h_rvmax[n], rv_max[n], "Real max array");
+    }
+    if (!h_rsum.isReady() || !h_rvmax.isReady()) {
+        amrex::Abort("DeferredReduce: results read but not ready");
+    }
+    checkCount(DeferredReduce::NumStarted()-started0, 6, "started after all access");
+
+    // Flush starts the batches early; later contributions go to new ones.
+    const Long started1 = DeferredReduce::NumStarted();
+    auto h_a = DeferredReduce::Sum(Real(myproc));
+    DeferredReduce::Flush();
+    checkCount(DeferredReduce::NumPending(), 0, "pending after Flush");
+    auto h_b = DeferredReduce::Sum(Real(1.0));
+    checkCount(DeferredReduce::NumStarted()-started1, 1, "started after Flush");
+    checkEqual(h_b.get(), Real(nprocs), "sum after Flush");
+    checkEqual(h_a.get(), Real(nprocs*(nprocs-1)/2), "sum before Flush");
+    checkCount(DeferredReduce::NumStarted()-started1, 2, "started after second batch");
+
+    // Local norms and dot products of MultiFabs fed to the handles.
+    BoxArray ba(Box(IntVect(0), IntVect(31)));
+    ba.maxSize(8);
+    DistributionMapping dm(ba);
+    MultiFab x(ba, dm, 1, 0), y(ba, dm, 1, 0);
+    for (MFIter mfi(x); mfi.isValid(); ++mfi) {
+        auto const& xa = x.array(mfi);
+        auto const& ya = y.array(mfi);
+        amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int ii, int jj, int kk)
+        {
+            xa(ii,jj,kk) = ii - jj + 0.5*kk;
+            ya(ii,jj,kk) = 0.25*(ii + jj) - kk;
+        });
+    }
+    auto h_nrm = DeferredReduce::Max(x.norm0(0, 0, true));
+    auto h_dot = DeferredReduce::Sum(MultiFab::Dot(x, 0, y, 0, 1, 0, true));
+    const Real nrm = x.norm0(0);
+    const Real dot = MultiFab::Dot(x, 0, y, 0, 1, 0);
+    checkEqual(h_nrm.get(), nrm, "MultiFab norm0");
+    if (std::abs(h_dot.get() - dot) > 1.e-12_rt*std::abs(dot)) {
+        amrex::Abort("DeferredReduce: wrong result for MultiFab dot");
+    }
+
+    amrex::Print() << "DeferredReduce: all results match the blocking reductions\n";
+}
@@ -0,0 +1,139 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_DistributedLayout.H>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+bool sameTags (const FabArrayBase::CopyComTagsContainer& a,
+               const FabArrayBase::CopyComTagsContainer& b)
+{
+    auto sa = a, sb = b;
+    std::sort(sa.begin(), sa.end());
+    std::sort(sb.begin(), sb.end());
+    if (sa.size() != sb.size()) return false;
+    for (int i = 0, N = sa.size(); i < N; ++i) {
+        if (sa[i].dbox != sb[i].dbox || sa[i].sbox != sb[i].sbox ||
+            sa[i].dstIndex != sb[i].dstIndex || sa[i].srcIndex != sb[i].srcIndex) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameTags (const FabArrayBase::MapOfCopyComTagContainers& a,
+               const FabArrayBase::MapOfCopyComTagContainers& b)
+{
+    if (a.size() != b.size()) return false;
+    for (auto const& kv : a) {
+        auto it = b.find(kv.first);
+        if (it == b.end() || !sameTags(kv.second, it->second)) return false;
+    }
+    return true;
+}
+
+// Compares the tags of the layout with those of FabArrayBase::FB.
+void compare (const DistributedLayout& layout, const MultiFab& mf,
+              const IntVect& nghost, const Periodicity& period, const std::string& name)
+{
+    FabArrayBase::CopyComTagsContainer loc_tags;
+    FabArrayBase::MapOfCopyComTagContainers snd_tags, rcv_tags;
+    layout.fillBoundaryTags(nghost, loc_tags, snd_tags, rcv_tags);
+
+    const FabArrayBase::FB& fb = mf.getFB(nghost, period);
+
+    bool ok = sameTags(loc_tags, *fb.m_LocTags)
+        &&    sameTags(snd_tags, *fb.m_SndTags)
+        &&    sameTags(rcv_tags, *fb.m_RcvTags);
+    ParallelDescriptor::ReduceBoolAnd(ok);
+    if (!ok) {
+        amrex::Abort("DistributedLayout: fillBoundaryTags differs from FB for " + name);
+    }
+    amrex::Print() << "  " << name << ": ok\n";
+}
+
+}
+
+void test ()
+{
+    int n_cell = 64;
+    int max_grid_size = 16;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const IntVect halo(2);
+
+    // Uneven boxes that do not cover the whole domain
+    BoxList bl(domain);
+    bl.maxSize(max_grid_size);
+    BoxList bl2;
+    int i = 0;
+    for (Box b : bl) {
+        if (i%7 == 3) { b.growHi(0, -3); }
+        if (i%5 != 1) { bl2.push_back(b); }
+        ++i;
+    }
+    const BoxArray ba(std::move(bl2));
+    const DistributionMapping dm(ba);
+
+    const Periodicity nonperiodic = Periodicity::NonPeriodic();
+    const Periodicity periodic(domain.length());
+
+    for (int nodal = 0; nodal < 2; ++nodal)
+    {
+        const BoxArray tba = nodal ? amrex::convert(ba, IntVect(1)) : ba;
+        const Box tdomain = nodal ? amrex::surroundingNodes(domain) : domain;
+        MultiFab mf(tba, dm, 1, halo);
+        const std::string type = nodal ? "nodal" : "cell";
+
+        for (int ip = 0; ip < 2; ++ip)
+        {
+            const Periodicity& period = ip ? periodic : nonperiodic;
+            const std::string name = type + (ip ? " periodic" : " non-periodic");
+
+            const DistributedLayout layout(tba, dm, tdomain, halo, period);
+            if (layout.numGlobalBoxes() != tba.size()) {
+                amrex::Abort("DistributedLayout: wrong number of boxes for " + name);
+            }
+            for (int ng = 1; ng <= halo[0]; ++ng) {
+                compare(layout, mf, IntVect(ng), period, name + " nghost " + std::to_string(ng));
+            }
+            compare(layout, mf, IntVect(AMREX_D_DECL(2,0,1)), period, name + " mixed nghost");
+        }
+    }
+
+    // Built from the local boxes only, with boxes numbered by process.
+    {
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int myproc = ParallelDescriptor::MyProc();
+        const int nboxes = ba.size();
+        Vector<int> pmap(nboxes);
+        BoxList local(ba.ixType());
+        for (int ib = 0; ib < nboxes; ++ib) {
+            pmap[ib] = static_cast<int>((Long(ib)*nprocs)/nboxes);
+            if (pmap[ib] == myproc) { local.push_back(ba[ib]); }
+        }
+        const DistributionMapping cdm(std::move(pmap));
+        MultiFab mf(ba, cdm, 1, halo);
+
+        const DistributedLayout layout(local, domain, halo, periodic);
+        compare(layout, mf, IntVect(2), periodic, "local boxes periodic nghost 2");
+    }
+}
@@ -0,0 +1,179 @@
+// Check EB2::Update against EB2::Build: after moving a sphere with an
+// incremental update, the EB data on every level must be the same as
+// those of an IndexSpace built from scratch with the sphere at its new
+// position.
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF_Sphere.H>
+#include <AMReX_EBFabFactory.H>
+
+using namespace amrex;
+
+namespace {
+
+Real maxdiff (MultiFab const& a, MultiFab const& b, int nghost)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.growntilebox(nghost);
+        auto const& fa = a.const_array(mfi);
+        auto const& fb = b.const_array(mfi);
+        ReduceOps<ReduceOpMax> reduce_op;
+        ReduceData<Real> reduce_data(reduce_op);
+        reduce_op.eval(bx, a.nComp(), reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) -> GpuTuple<Real>
+        {
+            return amrex::Math::abs(fa(i,j,k,n)-fb(i,j,k,n));
+        });
+        r = amrex::max(r, amrex::get<0>(reduce_data.value()));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+Real maxdiff (MultiCutFab const& a, MultiCutFab const& b, MultiFab const& layout, int nghost)
+{
+    Real r = 0.0;
+    for (MFIter mfi(layout); mfi.isValid(); ++mfi) {
+        if (a.ok(mfi) != b.ok(mfi)) {
+            amrex::Abort("EB2::Update: cut fabs differ at box "+std::to_string(mfi.index()));
+        }
+        if (!a.ok(mfi)) continue;
+        const Box& bx = amrex::convert(mfi.growntilebox(nghost), a[mfi].box().ixType());
+        auto const& fa = a.const_array(mfi);
+        auto const& fb = b.const_array(mfi);
+        ReduceOps<ReduceOpMax> reduce_op;
+        ReduceData<Real> reduce_data(reduce_op);
+        reduce_op.eval(bx, fa.nComp(), reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) -> GpuTuple<Real>
+        {
+            return amrex::Math::abs(fa(i,j,k,n)-fb(i,j,k,n));
+        });
+        r = amrex::max(r, amrex::get<0>(reduce_data.value()));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+int nflagdiff (FabArray<EBCellFlagFab> const& a, FabArray<EBCellFlagFab> const& b, int nghost)
+{
+    int r = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.growntilebox(nghost);
+        auto const& fa = a.const_array(mfi);
+        auto const& fb = b.const_array(mfi);
+        ReduceOps<ReduceOpSum> reduce_op;
+        ReduceData<int> reduce_data(reduce_op);
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> GpuTuple<int>
+        {
+            return (fa(i,j,k) == fb(i,j,k)) ? 0 : 1;
+        });
+        r += amrex::get<0>(reduce_data.value());
+    }
+    ParallelDescriptor::ReduceIntSum(r);
+    return r;
+}
+
+void compare (EB2::IndexSpace const* updated, EB2::IndexSpace const* built,
+              Geometry const& geom, int max_grid_size, int nlevs)
+{
+    const int ng = 2;
+    Geometry lgeom = geom;
+    for (int ilev = 0; ilev < nlevs; ++ilev) {
+        BoxArray ba(lgeom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        auto fu = makeEBFabFactory(updated, lgeom, ba, dm, {ng,ng,ng}, EBSupport::full);
+        auto fb = makeEBFabFactory(built  , lgeom, ba, dm, {ng,ng,ng}, EBSupport::full);
+
+        int nflags = nflagdiff(fu->getMultiEBCellFlagFab(), fb->getMultiEBCellFlagFab(), ng);
+        MultiFab const& vfrac = fu->getVolFrac();
+        Real err = maxdiff(vfrac, fb->getVolFrac(), ng);
+        err = amrex::max(err, maxdiff(fu->getCentroid(), fb->getCentroid(), vfrac, ng));
+        err = amrex::max(err, maxdiff(fu->getBndryCent(), fb->getBndryCent(), vfrac, ng));
+        err = amrex::max(err, maxdiff(fu->getBndryArea(), fb->getBndryArea(), vfrac, ng));
+        err = amrex::max(err, maxdiff(fu->getBndryNormal(), fb->getBndryNormal(), vfrac, ng));
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            err = amrex::max(err, maxdiff(*fu->getAreaFrac()[idim], *fb->getAreaFrac()[idim], vfrac, 0));
+            err = amrex::max(err, maxdiff(*fu->getFaceCent()[idim], *fb->getFaceCent()[idim], vfrac, 0));
+        }
+
+        amrex::Print() << "  level " << ilev << ": " << nflags << " flags differ, max error "
+                       << err << "\n";
+        if (nflags != 0 || err != 0.0) {
+            amrex::Abort("EB2::Update does not agree with EB2::Build on level "+std::to_string(ilev));
+        }
+
+        lgeom = amrex::coarsen(lgeom, 2);
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int nlevs = 3;
+        Real radius = 0.2;
+        Real shift = 0.05;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nlevs", nlevs);
+            pp.query("radius", radius);
+            pp.query("shift", shift);
+        }
+
+        Geometry geom(Box(IntVect(0),IntVect(n_cell-1)),
+                      RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                      CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+
+        RealArray c0{AMREX_D_DECL(Real(0.4),Real(0.5),Real(0.5))};
+        RealArray c1 = c0;
+        c1[0] += shift;
+
+        auto shop0 = EB2::makeShop(EB2::SphereIF(radius, c0, false));
+        auto shop1 = EB2::makeShop(EB2::SphereIF(radius, c1, false));
+
+        // Region swept by the sphere, padded by a few cells.
+        const Real pad = 3.0*geom.CellSize(0);
+        RealBox swept(AMREX_D_DECL(c0[0]-radius-pad, c0[1]-radius-pad, c0[2]-radius-pad),
+                      AMREX_D_DECL(c1[0]+radius+pad, c1[1]+radius+pad, c1[2]+radius+pad));
+
+        EB2::Build(shop0, geom, nlevs-1, nlevs-1);
+        const EB2::IndexSpace* updated = EB2::TopIndexSpace();
+
+        auto lu = EB2::Update(shop1, swept);
+        AMREX_ALWAYS_ASSERT(static_cast<int>(lu.size()) >= nlevs);
+        AMREX_ALWAYS_ASSERT(!lu[0].changed_boxes.empty());
+        AMREX_ALWAYS_ASSERT(lu[0].region.contains(IntVect(AMREX_D_DECL(static_cast<int>(c1[0]*n_cell),
+                                                                  n_cell/2, n_cell/2))));
+
+        EB2::Build(shop1, geom, nlevs-1, nlevs-1);
+        const EB2::IndexSpace* built = EB2::TopIndexSpace();
+
+        amrex::Print() << "Sphere moved by " << shift << ":\n";
+        compare(updated, built, geom, max_grid_size, nlevs);
+
+        // Move it back.  The updated IndexSpace must be on the top of
+        // the stack.
+        EB2::IndexSpace::pop();
+        EB2::Update(shop0, swept);
+        EB2::Build(shop0, geom, nlevs-1, nlevs-1);
+        built = EB2::TopIndexSpace();
+
+        amrex::Print() << "Sphere moved back:\n";
+        compare(updated, built, geom, max_grid_size, nlevs);
+    }
+    amrex::Finalize();
+}
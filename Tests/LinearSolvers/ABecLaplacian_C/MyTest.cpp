@@ -15,6 +15,49 @@ MyTest::MyTest ()
 
 void
 MyTest::solve ()
+{
+    if (outer_solver == MLMG::OuterSolver::mlmg) {
+        solveProblem();
+        return;
+    }
+
+    // Solve with plain MLMG from the same initial guess, and check that
+    // the Krylov solve converged to the same solution.
+    const int nlevels = geom.size();
+    Vector<MultiFab> initial(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        initial[ilev].define(grids[ilev], dmap[ilev], 1, solution[ilev].nGrow());
+        MultiFab::Copy(initial[ilev], solution[ilev], 0, 0, 1, solution[ilev].nGrow());
+    }
+
+    solveProblem();
+
+    Vector<MultiFab> krylov_solution(nlevels);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        krylov_solution[ilev].define(grids[ilev], dmap[ilev], 1, 0);
+        MultiFab::Copy(krylov_solution[ilev], solution[ilev], 0, 0, 1, 0);
+        MultiFab::Copy(solution[ilev], initial[ilev], 0, 0, 1, solution[ilev].nGrow());
+    }
+
+    const auto krylov_solver = outer_solver;
+    outer_solver = MLMG::OuterSolver::mlmg;
+    solveProblem();
+    outer_solver = krylov_solver;
+
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        const Real scale = solution[ilev].norm0(0, 0);
+        MultiFab::Subtract(krylov_solution[ilev], solution[ilev], 0, 0, 1, 0);
+        const Real diff = krylov_solution[ilev].norm0(0, 0);
+        amrex::Print() << "Level " << ilev << ": max difference from the plain MLMG solution "
+                       << diff << "\n";
+        if (diff > Real(1.e-6)*scale) {
+            amrex::Abort("The Krylov outer solver did not converge to the MLMG solution");
+        }
+    }
+}
+
+void
+MyTest::solveProblem ()
 {
     if (prob_type == 1) {
         solvePoisson();
@@ -65,6 +108,8 @@ MyTest::solvePoisson ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setOuterSolver(outer_solver);
+        mlmg.setFGMRESRestart(fgmres_restart);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -106,6 +151,8 @@ MyTest::solvePoisson ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setOuterSolver(outer_solver);
+            mlmg.setFGMRESRestart(fgmres_restart);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -182,6 +229,8 @@ MyTest::solveABecLaplacian ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setOuterSolver(outer_solver);
+        mlmg.setFGMRESRestart(fgmres_restart);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -239,6 +288,8 @@ MyTest::solveABecLaplacian ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setOuterSolver(outer_solver);
+            mlmg.setFGMRESRestart(fgmres_restart);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -324,6 +375,8 @@ MyTest::solveABecLaplacianInhomNeumann ()
         mlmg.setMaxFmgIter(max_fmg_iter);
         mlmg.setVerbose(verbose);
         mlmg.setBottomVerbose(bottom_verbose);
+        mlmg.setOuterSolver(outer_solver);
+        mlmg.setFGMRESRestart(fgmres_restart);
 #ifdef AMREX_USE_HYPRE
         if (use_hypre) {
             mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -381,6 +434,8 @@ MyTest::solveABecLaplacianInhomNeumann ()
             mlmg.setMaxFmgIter(max_fmg_iter);
             mlmg.setVerbose(verbose);
             mlmg.setBottomVerbose(bottom_verbose);
+            mlmg.setOuterSolver(outer_solver);
+            mlmg.setFGMRESRestart(fgmres_restart);
 #ifdef AMREX_USE_HYPRE
             if (use_hypre) {
                 mlmg.setBottomSolver(MLMG::BottomSolver::hypre);
@@ -433,6 +488,19 @@ MyTest::readParameters ()
     pp.query("max_coarsening_level", max_coarsening_level);
     pp.query("max_semicoarsening_level", max_semicoarsening_level);
 
+    std::string outer_solver_name = "mlmg";
+    pp.query("outer_solver", outer_solver_name);
+    if (outer_solver_name == "mlmg") {
+        outer_solver = MLMG::OuterSolver::mlmg;
+    } else if (outer_solver_name == "fgmres") {
+        outer_solver = MLMG::OuterSolver::fgmres;
+    } else if (outer_solver_name == "pcg") {
+        outer_solver = MLMG::OuterSolver::pcg;
+    } else {
+        amrex::Abort("Unknown outer_solver " + outer_solver_name);
+    }
+    pp.query("fgmres_restart", fgmres_restart);
+
 #ifdef AMREX_USE_HYPRE
     pp.query("use_hypre", use_hypre);
     pp.query("hypre_interface", hypre_interface_i);
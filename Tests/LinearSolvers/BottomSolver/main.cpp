@@ -0,0 +1,125 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLCGSolver.H>
+#include <AMReX_MLPoisson.H>
+
+using namespace amrex;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+void fillRhs (MultiFab& rhs, Geometry const& geom)
+{
+    const auto plo = geom.ProbLoArray();
+    const auto dx = geom.CellSizeArray();
+    for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& a = rhs.array(mfi);
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            AMREX_D_TERM(const Real x = plo[0] + (i + Real(0.5))*dx[0];,
+                         const Real y = plo[1] + (j + Real(0.5))*dx[1];,
+                         const Real z = plo[2] + (k + Real(0.5))*dx[2]);
+            const Real r2 = AMREX_D_TERM((x-Real(0.4))*(x-Real(0.4)),
+                                         + (y-Real(0.5))*(y-Real(0.5)),
+                                         + (z-Real(0.6))*(z-Real(0.6)));
+            a(i,j,k) = std::exp(Real(-40.)*r2);
+        });
+    }
+}
+
+// With no coarsening, every MLMG iteration is a bottom solve on the whole
+// level.  If the bottom solver fails, MLMG falls back to a few smoothing
+// sweeps and cannot reach the tolerance in a handful of iterations.
+void runBottomSolver (const char* name, BottomSolver bottom_solver,
+                      Geometry const& geom, BoxArray const& ba, DistributionMapping const& dm)
+{
+    LPInfo info;
+    info.setMaxCoarseningLevel(0);
+    MLPoisson linop({geom}, {ba}, {dm}, info);
+    linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet, LinOpBCType::Dirichlet, LinOpBCType::Dirichlet)},
+                      {AMREX_D_DECL(LinOpBCType::Dirichlet, LinOpBCType::Dirichlet, LinOpBCType::Dirichlet)});
+    linop.setLevelBC(0, nullptr);
+
+    MultiFab rhs(ba, dm, 1, 0);
+    MultiFab sol(ba, dm, 1, 1);
+    fillRhs(rhs, geom);
+    sol.setVal(0.0);
+
+    const int bottom_maxiter = 200;
+    MLMG mlmg(linop);
+    mlmg.setVerbose(0);
+    mlmg.setMaxIter(6);
+    mlmg.setMaxFmgIter(0);
+    mlmg.setBottomSolver(bottom_solver);
+    mlmg.setBottomMaxIter(bottom_maxiter);
+    mlmg.setBottomTolerance(1.e-4);
+    mlmg.solve({&sol}, {&rhs}, Real(1.e-10), Real(0.0));
+
+    const auto& niters_cg = mlmg.getNumCGIters();
+    if (niters_cg.empty()) {
+        amrex::Abort("BottomSolver: no bottom solve was done");
+    }
+    for (int n : niters_cg) {
+        if (n < 1 || n >= bottom_maxiter) {
+            amrex::Abort("BottomSolver: a bottom solve did not converge");
+        }
+    }
+
+    // The same solver called directly must succeed and agree with MLMG.
+    MLCGSolver<FArrayBox> cg(&mlmg, linop);
+    cg.setSolver(bottom_solver == BottomSolver::cg ? MLCGSolver<FArrayBox>::Type::CG
+                                                   : MLCGSolver<FArrayBox>::Type::BiCGStab);
+    cg.setMaxIter(bottom_maxiter);
+    MultiFab x(ba, dm, 1, 1);
+    x.setVal(0.0);
+    const int ret = cg.solve(x, rhs, Real(1.e-8), Real(-1.0));
+    if (ret != 0) {
+        amrex::Abort(std::string("BottomSolver: ") + name + " failed with " + std::to_string(ret));
+    }
+
+    const Real scale = sol.norm0(0, 0);
+    MultiFab::Subtract(x, sol, 0, 0, 1, 0);
+    const Real diff = x.norm0(0, 0);
+    amrex::Print() << "  " << name << ": " << mlmg.getNumIters() << " MLMG iterations, "
+                   << niters_cg.size() << " bottom solves, " << cg.getNumIters()
+                   << " iterations alone, difference " << diff << " of " << scale << "\n";
+    if (!(diff <= Real(1.e-5)*scale)) {
+        amrex::Abort("BottomSolver: the bottom solution differs from the MLMG solution");
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    {
+        ParmParse pp("bottom");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(0,0,0)};
+    Geometry geom(domain, real_box, CoordSys::cartesian, is_per);
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    runBottomSolver("bicgstab", BottomSolver::bicgstab, geom, ba, dm);
+    runBottomSolver("cg", BottomSolver::cg, geom, ba, dm);
+}
@@ -0,0 +1,195 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_MLABecLaplacian.H>
+#include <AMReX_MLTensorOp.H>
+
+using namespace amrex;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Gives access to the multigrid levels of an operator.
+template <class Op>
+class TestOp
+    : public Op
+{
+public:
+    using Op::Op;
+
+    int numMGLevels () const { return this->NMGLevels(0); }
+    Geometry const& mgGeom (int mglev) const { return this->m_geom[0][mglev]; }
+    BoxArray const& mgGrids (int mglev) const { return this->m_grids[0][mglev]; }
+    DistributionMapping const& mgDmap (int mglev) const { return this->m_dmap[0][mglev]; }
+};
+
+void fillField (MultiFab& mf, int seed)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& a = mf.array(mfi);
+        amrex::ParallelFor(bx, mf.nComp(), [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+        {
+            a(i,j,k,n) = std::sin(Real(0.7)*i + Real(1.3)*j + Real(0.3)*k + seed + n)
+                + Real(0.25)*std::cos(Real(2.1)*i*j + k + seed);
+        });
+    }
+}
+
+void setBCs (MLLinOp& op, bool periodic)
+{
+    Array<LinOpBCType,AMREX_SPACEDIM> lobc, hibc;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        lobc[idim] = periodic ? LinOpBCType::Periodic : LinOpBCType::Dirichlet;
+        hibc[idim] = periodic ? LinOpBCType::Periodic
+            : ((idim == 0) ? LinOpBCType::Neumann : LinOpBCType::Dirichlet);
+    }
+    if (op.getNComp() == 1) {
+        op.setDomainBC(lobc, hibc);
+    } else {
+        op.setDomainBC(Vector<Array<LinOpBCType,AMREX_SPACEDIM> >(op.getNComp(), lobc),
+                       Vector<Array<LinOpBCType,AMREX_SPACEDIM> >(op.getNComp(), hibc));
+    }
+    op.setLevelBC(0, nullptr);
+}
+
+void setupOp (TestOp<MLPoisson>& op, bool periodic)
+{
+    setBCs(op, periodic);
+}
+
+MultiFab makeACoef (BoxArray const& ba, DistributionMapping const& dm)
+{
+    MultiFab acoef(ba, dm, 1, 0);
+    fillField(acoef, 3);
+    acoef.plus(2.0, 0, 1);
+    return acoef;
+}
+
+Array<MultiFab,AMREX_SPACEDIM> makeBCoefs (BoxArray const& ba, DistributionMapping const& dm,
+                                           Geometry const& geom, bool periodic)
+{
+    Array<MultiFab,AMREX_SPACEDIM> bcoefs;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        bcoefs[idim].define(amrex::convert(ba, IntVect::TheDimensionVector(idim)), dm, 1, 0);
+        fillField(bcoefs[idim], 5+idim);
+        bcoefs[idim].plus(2.0, 0, 1);
+        if (periodic) {
+            // The faces on the periodic boundary must agree.
+            bcoefs[idim].OverrideSync(geom.periodicity());
+        }
+    }
+    return bcoefs;
+}
+
+void setupOp (TestOp<MLABecLaplacian>& op, bool periodic)
+{
+    setBCs(op, periodic);
+    op.setScalars(1.0, 1.0);
+    op.setACoeffs(0, makeACoef(op.mgGrids(0), op.mgDmap(0)));
+    const auto bcoefs = makeBCoefs(op.mgGrids(0), op.mgDmap(0), op.mgGeom(0), periodic);
+    op.setBCoeffs(0, GetArrOfConstPtrs(bcoefs));
+}
+
+void setupOp (TestOp<MLTensorOp>& op, bool periodic)
+{
+    setBCs(op, periodic);
+    op.setScalars(1.0, 1.0);
+    op.setACoeffs(0, makeACoef(op.mgGrids(0), op.mgDmap(0)));
+    const auto eta = makeBCoefs(op.mgGrids(0), op.mgDmap(0), op.mgGeom(0), periodic);
+    op.setShearViscosity(0, GetArrOfConstPtrs(eta));
+    op.setBulkViscosity(0, 0.5);
+}
+
+// On every multigrid level, correctionResidualRestriction must match
+// correctionResidual followed by restriction bit for bit.  Returns whether
+// the operator took the fused path on the finest level.
+template <class Op>
+bool checkOp (const char* name, Geometry const& geom, BoxArray const& ba,
+              DistributionMapping const& dm, bool periodic)
+{
+    TestOp<Op> op({geom}, {ba}, {dm});
+    setupOp(op, periodic);
+    op.prepareForSolve();
+
+    const int ncomp = op.getNComp();
+    for (int mglev = 0; mglev+1 < op.numMGLevels(); ++mglev)
+    {
+        const BoxArray& fba = op.mgGrids(mglev);
+        const DistributionMapping& fdm = op.mgDmap(mglev);
+        MultiFab b(fba, fdm, ncomp, 0);
+        MultiFab x_fused(fba, fdm, ncomp, 1);
+        MultiFab x_plain(fba, fdm, ncomp, 1);
+        fillField(b, 1);
+        fillField(x_fused, 2);
+        MultiFab::Copy(x_plain, x_fused, 0, 0, ncomp, 0);
+
+        MultiFab resid(fba, fdm, ncomp, 0);
+        MultiFab crse_fused(op.mgGrids(mglev+1), op.mgDmap(mglev+1), ncomp, 0);
+        MultiFab crse_plain(op.mgGrids(mglev+1), op.mgDmap(mglev+1), ncomp, 0);
+
+        op.correctionResidualRestriction(0, mglev+1, crse_fused, resid, x_fused, b);
+
+        op.correctionResidual(0, mglev, resid, x_plain, b, MLLinOp::BCMode::Homogeneous);
+        op.restriction(0, mglev+1, crse_plain, resid);
+
+        MultiFab::Subtract(crse_fused, crse_plain, 0, 0, ncomp, 0);
+        for (int n = 0; n < ncomp; ++n) {
+            if (crse_fused.norm0(n, 0) != 0) {
+                amrex::Print() << "  " << name << ": domain " << geom.Domain()
+                               << (periodic ? " periodic" : " walls")
+                               << ", mg level " << mglev << "\n";
+                amrex::Abort("ResidualRestriction: the fused path differs");
+            }
+        }
+    }
+
+    return op.supportsResidualRestriction(0, 0);
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    {
+        ParmParse pp("rr");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    const DistributionMapping dm(ba);
+
+    for (int periodic = 0; periodic < 2; ++periodic)
+    {
+        const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(periodic,periodic,periodic)};
+        const Geometry geom(domain, real_box, CoordSys::cartesian, is_per);
+
+        if (!checkOp<MLPoisson>("MLPoisson", geom, ba, dm, periodic)) {
+            amrex::Abort("ResidualRestriction: MLPoisson does not fuse");
+        }
+        if (!checkOp<MLABecLaplacian>("MLABecLaplacian", geom, ba, dm, periodic)) {
+            amrex::Abort("ResidualRestriction: MLABecLaplacian does not fuse");
+        }
+        // The fused ABecLaplacian kernel would drop the tensor terms.
+        if (checkOp<MLTensorOp>("MLTensorOp", geom, ba, dm, periodic)) {
+            amrex::Abort("ResidualRestriction: MLTensorOp takes the fused path");
+        }
+        amrex::Print() << (periodic ? "  periodic" : "  walls") << ": ok\n";
+    }
+}
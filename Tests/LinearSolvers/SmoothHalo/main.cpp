@@ -0,0 +1,208 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_MLABecLaplacian.H>
+
+using namespace amrex;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Gives access to the multigrid levels of an operator.
+template <class Op>
+class TestOp
+    : public Op
+{
+public:
+    using Op::Op;
+
+    int numMGLevels () const { return this->NMGLevels(0); }
+    Geometry const& mgGeom (int mglev) const { return this->m_geom[0][mglev]; }
+    BoxArray const& mgGrids (int mglev) const { return this->m_grids[0][mglev]; }
+    DistributionMapping const& mgDmap (int mglev) const { return this->m_dmap[0][mglev]; }
+};
+
+void fillField (MultiFab& mf, int seed)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& a = mf.array(mfi);
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            a(i,j,k) = std::sin(Real(0.7)*i + Real(1.3)*j + Real(0.3)*k + seed)
+                + Real(0.25)*std::cos(Real(2.1)*i*j + k + seed);
+        });
+    }
+}
+
+Real maxDiff (MultiFab const& a, MultiFab const& b)
+{
+    MultiFab diff(a.boxArray(), a.DistributionMap(), 1, 0);
+    MultiFab::Copy(diff, a, 0, 0, 1, 0);
+    MultiFab::Subtract(diff, b, 0, 0, 1, 0);
+    return diff.norm0(0, 0);
+}
+
+void setupOp (TestOp<MLPoisson>& op)
+{
+    op.setDomainBC({AMREX_D_DECL(LinOpBCType::Periodic, LinOpBCType::Periodic, LinOpBCType::Periodic)},
+                   {AMREX_D_DECL(LinOpBCType::Periodic, LinOpBCType::Periodic, LinOpBCType::Periodic)});
+    op.setLevelBC(0, nullptr);
+}
+
+void setupOp (TestOp<MLABecLaplacian>& op)
+{
+    op.setDomainBC({AMREX_D_DECL(LinOpBCType::Periodic, LinOpBCType::Periodic, LinOpBCType::Periodic)},
+                   {AMREX_D_DECL(LinOpBCType::Periodic, LinOpBCType::Periodic, LinOpBCType::Periodic)});
+    op.setLevelBC(0, nullptr);
+    op.setScalars(1.0, 1.0);
+
+    const BoxArray& ba = op.mgGrids(0);
+    const DistributionMapping& dm = op.mgDmap(0);
+    MultiFab acoef(ba, dm, 1, 0);
+    fillField(acoef, 3);
+    acoef.plus(2.0, 0, 1);
+    op.setACoeffs(0, acoef);
+
+    Array<MultiFab,AMREX_SPACEDIM> bcoefs;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        bcoefs[idim].define(amrex::convert(ba, IntVect::TheDimensionVector(idim)), dm, 1, 0);
+        fillField(bcoefs[idim], 5+idim);
+        bcoefs[idim].plus(2.0, 0, 1);
+        // The faces on the periodic boundary must agree.
+        bcoefs[idim].OverrideSync(op.mgGeom(0).periodicity());
+    }
+    op.setBCoeffs(0, GetArrOfConstPtrs(bcoefs));
+}
+
+// smoothSweeps with deep halos must give the same valid-region result as
+// repeated smooth on every multigrid level; on the levels where deep halos
+// cannot be used it must fall back to smooth.
+template <class Op>
+void checkSweeps (const char* name, Geometry const& geom, BoxArray const& ba,
+                  DistributionMapping const& dm, int depth, int nsweeps)
+{
+    LPInfo info;
+    info.setSmoothHaloDepth(depth);
+    TestOp<Op> op({geom}, {ba}, {dm}, info);
+    setupOp(op);
+    op.prepareForSolve();
+
+    for (int mglev = 0; mglev < op.numMGLevels(); ++mglev)
+    {
+        const BoxArray& mba = op.mgGrids(mglev);
+        const DistributionMapping& mdm = op.mgDmap(mglev);
+        MultiFab rhs(mba, mdm, 1, 0);
+        MultiFab sol_plain(mba, mdm, 1, 1);
+        MultiFab sol_halo(mba, mdm, 1, 1);
+        fillField(rhs, 1);
+        fillField(sol_plain, 2);
+        MultiFab::Copy(sol_halo, sol_plain, 0, 0, 1, 0);
+
+        for (int i = 0; i < nsweeps; ++i) {
+            op.smooth(0, mglev, sol_plain, rhs);
+        }
+        op.smoothSweeps(0, mglev, sol_halo, rhs, nsweeps);
+
+        if (maxDiff(sol_plain, sol_halo) != 0) {
+            amrex::Print() << "  " << name << ": domain " << geom.Domain()
+                           << ", depth " << depth << ", mg level " << mglev << "\n";
+            amrex::Abort("SmoothHalo: smoothSweeps differs from smooth");
+        }
+
+        // With skip_fillboundary, the ghost cells of a nonzero sol are
+        // already filled.
+        fillField(sol_plain, 3);
+        sol_plain.FillBoundary(op.mgGeom(mglev).periodicity());
+        MultiFab::Copy(sol_halo, sol_plain, 0, 0, 1, 1);
+        for (int i = 0; i < nsweeps; ++i) {
+            op.smooth(0, mglev, sol_plain, rhs, i == 0);
+        }
+        op.smoothSweeps(0, mglev, sol_halo, rhs, nsweeps, true);
+
+        if (maxDiff(sol_plain, sol_halo) != 0) {
+            amrex::Print() << "  " << name << ": domain " << geom.Domain()
+                           << ", depth " << depth << ", mg level " << mglev << "\n";
+            amrex::Abort("SmoothHalo: smoothSweeps differs from smooth with skip_fillboundary");
+        }
+    }
+}
+
+// A whole solve with deep halos must be bitwise identical to one without.
+template <class Op>
+void checkSolve (const char* name, Geometry const& geom, BoxArray const& ba,
+                 DistributionMapping const& dm, int depth)
+{
+    MultiFab rhs(ba, dm, 1, 0);
+    fillField(rhs, 4);
+    // A periodic problem needs a right-hand side with zero mean.
+    rhs.plus(-rhs.sum(0)/static_cast<Real>(ba.numPts()), 0, 1);
+
+    Vector<MultiFab> sol(2);
+    for (int n = 0; n < 2; ++n) {
+        LPInfo info;
+        if (n == 1) { info.setSmoothHaloDepth(depth); }
+        TestOp<Op> op({geom}, {ba}, {dm}, info);
+        setupOp(op);
+
+        sol[n].define(ba, dm, 1, 1);
+        sol[n].setVal(0.0);
+        MLMG mlmg(op);
+        mlmg.setVerbose(0);
+        mlmg.setBottomSolver(MLMG::BottomSolver::cg);
+        mlmg.setMaxFmgIter(0);
+        mlmg.setFinalFillBC(false);
+        mlmg.solve({&sol[n]}, {&rhs}, Real(1.e-10), Real(0.0));
+    }
+
+    if (maxDiff(sol[0], sol[1]) != 0) {
+        amrex::Print() << "  " << name << ": domain " << geom.Domain() << ", depth " << depth << "\n";
+        amrex::Abort("SmoothHalo: the solve with deep halos differs");
+    }
+}
+
+}
+
+void test ()
+{
+    // 32 stays even on every multigrid level; 20 has 5 cells on the third.
+    Vector<int> n_cells{32, 20};
+    int max_grid_size = 8;
+    int nsweeps = 3;
+    {
+        ParmParse pp("halo");
+        pp.queryarr("n_cells", n_cells);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nsweeps", nsweeps);
+    }
+
+    for (int n_cell : n_cells)
+    {
+        const Box domain(IntVect(0), IntVect(n_cell-1));
+        const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+        const Geometry geom(domain, real_box, CoordSys::cartesian, is_per);
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        const DistributionMapping dm(ba);
+
+        for (int depth = 2; depth <= 4; ++depth) {
+            checkSweeps<MLPoisson>("MLPoisson", geom, ba, dm, depth, nsweeps);
+            checkSweeps<MLABecLaplacian>("MLABecLaplacian", geom, ba, dm, depth, nsweeps);
+        }
+        checkSolve<MLPoisson>("MLPoisson", geom, ba, dm, 3);
+        checkSolve<MLABecLaplacian>("MLABecLaplacian", geom, ba, dm, 3);
+        amrex::Print() << "  domain " << n_cell << ": ok\n";
+    }
+}
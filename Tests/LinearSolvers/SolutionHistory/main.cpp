@@ -0,0 +1,195 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_MLNodeLaplacian.H>
+#ifdef AMREX_USE_EB
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#endif
+
+using namespace amrex;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// A Gaussian source whose center moves a little with each step.
+void fillRhs (MultiFab& rhs, Geometry const& geom, int step)
+{
+    const auto plo = geom.ProbLoArray();
+    const auto dx = geom.CellSizeArray();
+    const IntVect nodal = rhs.ixType().toIntVect();
+    const Real xc = Real(0.45) + Real(0.005)*step;
+    const Real yc = Real(0.5) - Real(0.003)*step;
+    for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& a = rhs.array(mfi);
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            const Real off = Real(0.5);
+            AMREX_D_TERM(const Real x = plo[0] + (i + (nodal[0] ? Real(0.) : off))*dx[0];,
+                         const Real y = plo[1] + (j + (nodal[1] ? Real(0.) : off))*dx[1];,
+                         const Real z = plo[2] + (k + (nodal[2] ? Real(0.) : off))*dx[2]);
+            const Real r2 = AMREX_D_TERM((x-xc)*(x-xc), + (y-yc)*(y-yc), + (z-Real(0.5))*(z-Real(0.5)));
+            a(i,j,k) = std::exp(Real(-50.)*r2);
+        });
+    }
+}
+
+void setDirichlet (MLLinOp& linop)
+{
+    linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet, LinOpBCType::Dirichlet, LinOpBCType::Dirichlet)},
+                      {AMREX_D_DECL(LinOpBCType::Dirichlet, LinOpBCType::Dirichlet, LinOpBCType::Dirichlet)});
+}
+
+// Each step solves from a zero initial guess twice: with a fresh MLMG, and
+// with one that keeps the corrections of the previous steps.  The two
+// solutions must agree, and the history must save iterations.
+template <class MakeOp>
+void runSteps (const char* name, MakeOp&& make_op, Vector<Geometry> const& geom,
+                Vector<BoxArray> const& ba, Vector<DistributionMapping> const& dm,
+                int nsteps, int history_size)
+{
+    const int nlevs = geom.size();
+    Vector<MultiFab> rhs(nlevs), sol_zero(nlevs), sol_hist(nlevs);
+    for (int lev = 0; lev < nlevs; ++lev) {
+        rhs[lev].define(ba[lev], dm[lev], 1, 0);
+        sol_zero[lev].define(ba[lev], dm[lev], 1, 1);
+        sol_hist[lev].define(ba[lev], dm[lev], 1, 1);
+    }
+
+    auto op_hist = make_op();
+    MLMG mlmg_hist(*op_hist);
+    mlmg_hist.setVerbose(0);
+    mlmg_hist.setMaxFmgIter(0);
+    mlmg_hist.setSolutionHistorySize(history_size);
+
+    const Real tol_rel = 1.e-10;
+    int niters_zero = 0, niters_hist = 0, last_zero = 0, last_hist = 0;
+    for (int step = 0; step < nsteps; ++step)
+    {
+        for (int lev = 0; lev < nlevs; ++lev) {
+            fillRhs(rhs[lev], geom[lev], step);
+            sol_zero[lev].setVal(0.0);
+            sol_hist[lev].setVal(0.0);
+        }
+
+        auto op_zero = make_op();
+        MLMG mlmg_zero(*op_zero);
+        mlmg_zero.setVerbose(0);
+        mlmg_zero.setMaxFmgIter(0);
+        mlmg_zero.solve(GetVecOfPtrs(sol_zero), GetVecOfConstPtrs(rhs), tol_rel, Real(0.0));
+        mlmg_hist.solve(GetVecOfPtrs(sol_hist), GetVecOfConstPtrs(rhs), tol_rel, Real(0.0));
+
+        last_zero = mlmg_zero.getNumIters();
+        last_hist = mlmg_hist.getNumIters();
+        niters_zero += last_zero;
+        niters_hist += last_hist;
+        if (step == 0 && last_hist != last_zero) {
+            amrex::Abort("SolutionHistory: the first solve is not a plain solve");
+        }
+
+        for (int lev = 0; lev < nlevs; ++lev) {
+            const Real scale = sol_zero[lev].norm0(0, 0);
+            MultiFab::Subtract(sol_hist[lev], sol_zero[lev], 0, 0, 1, 0);
+            const Real diff = sol_hist[lev].norm0(0, 0);
+            if (diff > Real(1.e-7)*scale) {
+                amrex::Print() << "  " << name << ": step " << step << ", level " << lev
+                               << ", difference " << diff << " of " << scale << "\n";
+                amrex::Abort("SolutionHistory: the solution differs from the zero-start solve");
+            }
+        }
+    }
+
+    amrex::Print() << "  " << name << ": " << niters_zero << " iterations from zero, "
+                   << niters_hist << " with history\n";
+    if (last_hist >= last_zero || 4*niters_hist > 3*niters_zero) {
+        amrex::Abort("SolutionHistory: the history does not reduce the iterations");
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int nsteps = 12;
+    int history_size = 8;
+    {
+        ParmParse pp("hist");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nsteps", nsteps);
+        pp.query("history_size", history_size);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(0,0,0)};
+
+    // Cell-centered, with a refined level around the source.
+    {
+        Vector<Geometry> geom(2);
+        Vector<BoxArray> ba(2);
+        Vector<DistributionMapping> dm(2);
+        geom[0].define(domain, real_box, CoordSys::cartesian, is_per);
+        geom[1].define(amrex::refine(domain, 2), real_box, CoordSys::cartesian, is_per);
+        ba[0].define(domain);
+        ba[1].define(amrex::refine(Box(IntVect(n_cell/4), IntVect(3*n_cell/4-1)), 2));
+        for (int lev = 0; lev < 2; ++lev) {
+            ba[lev].maxSize(max_grid_size);
+            dm[lev].define(ba[lev]);
+        }
+
+        auto make_op = [&] () {
+            auto op = std::make_unique<MLPoisson>(geom, ba, dm);
+            setDirichlet(*op);
+            for (int lev = 0; lev < 2; ++lev) {
+                op->setLevelBC(lev, nullptr);
+            }
+            return op;
+        };
+        runSteps("MLPoisson", make_op, geom, ba, dm, nsteps, history_size);
+    }
+
+    // Nodal; the Dirichlet nodes must keep their values.
+    {
+        Vector<Geometry> geom{Geometry(domain, real_box, CoordSys::cartesian, is_per)};
+        Vector<BoxArray> ba{BoxArray(domain)};
+        ba[0].maxSize(max_grid_size);
+        Vector<DistributionMapping> dm{DistributionMapping(ba[0])};
+        Vector<BoxArray> nba{amrex::convert(ba[0], IntVect::TheNodeVector())};
+
+        MultiFab sigma(ba[0], dm[0], 1, 0);
+        sigma.setVal(1.0);
+
+#ifdef AMREX_USE_EB
+        // With EB, the nodal operator needs an EB factory, here all regular.
+        EB2::Build(EB2::makeShop(EB2::AllRegularIF()), geom[0], 0, 30);
+        auto factory = makeEBFabFactory(geom[0], ba[0], dm[0], {2,2,2}, EBSupport::full);
+        const Vector<EBFArrayBoxFactory const*> factories{factory.get()};
+#else
+        const Vector<FabFactory<FArrayBox> const*> factories;
+#endif
+
+        auto make_op = [&] () {
+            auto op = std::make_unique<MLNodeLaplacian>(geom, ba, dm, LPInfo(), factories);
+            setDirichlet(*op);
+            op->setSigma(0, sigma);
+            return op;
+        };
+        runSteps("MLNodeLaplacian", make_op, geom, nba, dm, nsteps, history_size);
+    }
+}
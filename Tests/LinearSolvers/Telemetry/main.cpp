@@ -0,0 +1,365 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_FileSystem.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace amrex;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Gives access to the numbers of levels of an operator.
+class TestOp
+    : public MLPoisson
+{
+public:
+    using MLPoisson::MLPoisson;
+
+    int numAMRLevels () const { return NAMRLevels(); }
+    int numMGLevels (int amrlev) const { return NMGLevels(amrlev); }
+};
+
+struct JsonValue
+{
+    enum Type { null, boolean, number, string, array, object };
+    Type type = null;
+    double num = 0.;
+    std::string str;
+    std::vector<JsonValue> arr;
+    std::vector<std::pair<std::string,JsonValue> > obj;
+
+    JsonValue const* find (std::string const& key) const
+    {
+        for (auto const& kv : obj) {
+            if (kv.first == key) return &kv.second;
+        }
+        return nullptr;
+    }
+};
+
+// A strict parser for one JSON text, enough to validate the telemetry.
+class JsonParser
+{
+public:
+    explicit JsonParser (std::string const& s) : m_s(s) {}
+
+    bool parse (JsonValue& v)
+    {
+        skipSpace();
+        if (!value(v)) return false;
+        skipSpace();
+        return m_pos == m_s.size();
+    }
+
+private:
+    void skipSpace ()
+    {
+        while (m_pos < m_s.size() && (m_s[m_pos] == ' ' || m_s[m_pos] == '\t' ||
+                                      m_s[m_pos] == '\r' || m_s[m_pos] == '\n')) {
+            ++m_pos;
+        }
+    }
+
+    bool literal (const char* lit)
+    {
+        const std::size_t n = std::strlen(lit);
+        if (m_s.compare(m_pos, n, lit) != 0) return false;
+        m_pos += n;
+        return true;
+    }
+
+    bool value (JsonValue& v)
+    {
+        if (m_pos >= m_s.size()) return false;
+        const char c = m_s[m_pos];
+        if (c == '{') return objectValue(v);
+        if (c == '[') return arrayValue(v);
+        if (c == '"') { v.type = JsonValue::string; return stringValue(v.str); }
+        if (c == 't') { v.type = JsonValue::boolean; v.num = 1.; return literal("true"); }
+        if (c == 'f') { v.type = JsonValue::boolean; return literal("false"); }
+        if (c == 'n') { v.type = JsonValue::null; return literal("null"); }
+        return numberValue(v);
+    }
+
+    bool numberValue (JsonValue& v)
+    {
+        // strtod would also take nan, inf and hexadecimal numbers.
+        std::size_t p = m_pos;
+        if (p < m_s.size() && m_s[p] == '-') ++p;
+        if (p >= m_s.size() || !std::isdigit(m_s[p])) return false;
+        if (m_s[p] == '0' && p+1 < m_s.size() && std::isdigit(m_s[p+1])) return false;
+        while (p < m_s.size() && (std::isdigit(m_s[p]) || std::strchr(".eE+-", m_s[p]))) ++p;
+        const std::string token = m_s.substr(m_pos, p-m_pos);
+        char* end = nullptr;
+        v.type = JsonValue::number;
+        v.num = std::strtod(token.c_str(), &end);
+        if (end != token.c_str() + token.size()) return false;
+        m_pos = p;
+        return true;
+    }
+
+    bool stringValue (std::string& out)
+    {
+        ++m_pos; // "
+        while (m_pos < m_s.size())
+        {
+            const char c = m_s[m_pos++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c == '\\') {
+                if (m_pos >= m_s.size()) return false;
+                const char e = m_s[m_pos++];
+                if (e == 'u') {
+                    for (int i = 0; i < 4; ++i, ++m_pos) {
+                        if (m_pos >= m_s.size() || !std::isxdigit(m_s[m_pos])) return false;
+                    }
+                    out += '?';
+                } else if (std::strchr("\"\\/bfnrt", e) && e != '\0') {
+                    out += e;
+                } else {
+                    return false;
+                }
+            } else {
+                out += c;
+            }
+        }
+        return false;
+    }
+
+    bool arrayValue (JsonValue& v)
+    {
+        v.type = JsonValue::array;
+        ++m_pos; // [
+        skipSpace();
+        if (m_pos < m_s.size() && m_s[m_pos] == ']') { ++m_pos; return true; }
+        while (true) {
+            v.arr.emplace_back();
+            skipSpace();
+            if (!value(v.arr.back())) return false;
+            skipSpace();
+            if (m_pos >= m_s.size()) return false;
+            if (m_s[m_pos] == ']') { ++m_pos; return true; }
+            if (m_s[m_pos++] != ',') return false;
+        }
+    }
+
+    bool objectValue (JsonValue& v)
+    {
+        v.type = JsonValue::object;
+        ++m_pos; // {
+        skipSpace();
+        if (m_pos < m_s.size() && m_s[m_pos] == '}') { ++m_pos; return true; }
+        while (true) {
+            skipSpace();
+            if (m_pos >= m_s.size() || m_s[m_pos] != '"') return false;
+            std::string key;
+            if (!stringValue(key)) return false;
+            if (v.find(key)) return false;
+            skipSpace();
+            if (m_pos >= m_s.size() || m_s[m_pos++] != ':') return false;
+            skipSpace();
+            v.obj.emplace_back(key, JsonValue());
+            if (!value(v.obj.back().second)) return false;
+            skipSpace();
+            if (m_pos >= m_s.size()) return false;
+            if (m_s[m_pos] == '}') { ++m_pos; return true; }
+            if (m_s[m_pos++] != ',') return false;
+        }
+    }
+
+    std::string const& m_s;
+    std::size_t m_pos = 0;
+};
+
+JsonValue const& get (JsonValue const& v, const char* key, JsonValue::Type type)
+{
+    JsonValue const* r = v.find(key);
+    if (r == nullptr || r->type != type) {
+        amrex::Abort(std::string("Telemetry: missing or wrong type of ") + key);
+    }
+    return *r;
+}
+
+double getNonNegative (JsonValue const& v, const char* key)
+{
+    const double x = get(v, key, JsonValue::number).num;
+    if (!(x >= 0.)) {
+        amrex::Abort(std::string("Telemetry: negative ") + key);
+    }
+    return x;
+}
+
+// Each line must be a JSON object with one entry per AMR and MG level, in
+// order.  The nth line is from the nth solve.
+void checkFile (std::string const& file_name, TestOp const& op, Vector<int> const& niters,
+                int rank)
+{
+    std::ifstream ifs(file_name);
+    if (!ifs.good()) {
+        amrex::Abort("Telemetry: cannot open " + file_name);
+    }
+
+    std::string line;
+    int nlines = 0;
+    while (std::getline(ifs, line))
+    {
+        JsonValue v;
+        if (!JsonParser(line).parse(v) || v.type != JsonValue::object) {
+            amrex::Print() << "  line " << nlines << " of " << file_name << ": " << line << "\n";
+            amrex::Abort("Telemetry: a line is not a JSON object");
+        }
+        if (nlines >= niters.size()) {
+            amrex::Abort("Telemetry: more lines than solves");
+        }
+
+        if (get(v, "solve", JsonValue::number).num != nlines ||
+            get(v, "niters", JsonValue::number).num != niters[nlines] ||
+            static_cast<int>(get(v, "resid_history", JsonValue::array).arr.size()) != niters[nlines]) {
+            amrex::Abort("Telemetry: wrong solve or iteration count");
+        }
+        if (get(v, "operator", JsonValue::string).str != op.name()) {
+            amrex::Abort("Telemetry: wrong operator");
+        }
+        JsonValue const* r = v.find("rank");
+        if ((rank < 0) != (r == nullptr) || (r && r->num != rank)) {
+            amrex::Abort("Telemetry: wrong rank");
+        }
+        get(v, "nprocs", JsonValue::number);
+        // With a Krylov outer solver, the history is of the composite
+        // residual and ends with the final one.
+        const double resid = get(v, "resid", JsonValue::number).num;
+        auto const& history = get(v, "resid_history", JsonValue::array).arr;
+        if (get(v, "outer_solver", JsonValue::number).num != 0 &&
+            !history.empty() && history.back().num != resid) {
+            amrex::Abort("Telemetry: the residual history does not end with the final residual");
+        }
+        JsonValue const& time = get(v, "time", JsonValue::object);
+        for (const char* key : {"solve", "iter", "bottom"}) {
+            getNonNegative(time, key);
+        }
+
+        JsonValue const& levels = get(v, "levels", JsonValue::array);
+        std::size_t ilev = 0;
+        for (int amrlev = 0; amrlev < op.numAMRLevels(); ++amrlev) {
+            for (int mglev = 0; mglev < op.numMGLevels(amrlev); ++mglev, ++ilev) {
+                if (ilev >= levels.arr.size()) {
+                    amrex::Abort("Telemetry: too few levels");
+                }
+                JsonValue const& lev = levels.arr[ilev];
+                if (lev.type != JsonValue::object ||
+                    get(lev, "amrlev", JsonValue::number).num != amrlev ||
+                    get(lev, "mglev", JsonValue::number).num != mglev) {
+                    amrex::Abort("Telemetry: levels out of order");
+                }
+                for (const char* key : {"smooth", "residual", "restriction", "interpolation",
+                                        "bottom", "fillboundary", "nsends", "send_bytes"}) {
+                    getNonNegative(lev, key);
+                }
+            }
+        }
+        if (ilev != levels.arr.size()) {
+            amrex::Abort("Telemetry: too many levels");
+        }
+        ++nlines;
+    }
+
+    if (nlines != niters.size()) {
+        amrex::Abort("Telemetry: fewer lines than solves");
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    std::string file_name = "mlmg_telemetry.json";
+    {
+        ParmParse pp("tel");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("file", file_name);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(0,0,0)};
+    Vector<Geometry> geom(2);
+    Vector<BoxArray> ba(2);
+    Vector<DistributionMapping> dm(2);
+    geom[0].define(domain, real_box, CoordSys::cartesian, is_per);
+    geom[1].define(amrex::refine(domain, 2), real_box, CoordSys::cartesian, is_per);
+    ba[0].define(domain);
+    ba[1].define(amrex::refine(Box(IntVect(n_cell/4), IntVect(3*n_cell/4-1)), 2));
+    Vector<MultiFab> rhs(2), sol(2);
+    for (int lev = 0; lev < 2; ++lev) {
+        ba[lev].maxSize(max_grid_size);
+        dm[lev].define(ba[lev]);
+        rhs[lev].define(ba[lev], dm[lev], 1, 0);
+        sol[lev].define(ba[lev], dm[lev], 1, 1);
+        rhs[lev].setVal(1.0);
+    }
+
+    TestOp op(geom, ba, dm);
+    op.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet, LinOpBCType::Dirichlet, LinOpBCType::Dirichlet)},
+                   {AMREX_D_DECL(LinOpBCType::Dirichlet, LinOpBCType::Dirichlet, LinOpBCType::Dirichlet)});
+    for (int lev = 0; lev < 2; ++lev) {
+        op.setLevelBC(lev, nullptr);
+    }
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const std::string rank_file_name = file_name + "_per_rank";
+    const std::string my_rank_file_name = rank_file_name + "." + std::to_string(myproc);
+    // The telemetry is appended to the files.
+    if (ParallelDescriptor::IOProcessor()) {
+        FileSystem::Remove(file_name);
+    }
+    FileSystem::Remove(my_rank_file_name);
+    ParallelDescriptor::Barrier();
+
+    // Reduced over the processes; the second solve uses FGMRES.
+    Vector<int> niters;
+    {
+        MLMG mlmg(op);
+        mlmg.setVerbose(0);
+        mlmg.setTelemetryFile(file_name);
+        for (int n = 0; n < 2; ++n) {
+            if (n == 1) mlmg.setOuterSolver(MLMG::OuterSolver::fgmres);
+            for (auto& mf : sol) mf.setVal(0.0);
+            mlmg.solve(GetVecOfPtrs(sol), GetVecOfConstPtrs(rhs), Real(1.e-10), Real(0.0));
+            niters.push_back(mlmg.getNumIters());
+        }
+    }
+    if (ParallelDescriptor::IOProcessor()) {
+        checkFile(file_name, op, niters, -1);
+    }
+    amrex::Print() << "  reduced telemetry: ok\n";
+
+    // One file per process
+    {
+        MLMG mlmg(op);
+        mlmg.setVerbose(0);
+        mlmg.setTelemetryFile(rank_file_name, true);
+        for (auto& mf : sol) mf.setVal(0.0);
+        mlmg.solve(GetVecOfPtrs(sol), GetVecOfConstPtrs(rhs), Real(1.e-10), Real(0.0));
+        checkFile(my_rank_file_name, op, {mlmg.getNumIters()}, myproc);
+    }
+    ParallelDescriptor::Barrier();
+    amrex::Print() << "  per-rank telemetry: ok\n";
+}
@@ -0,0 +1,136 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabExpr.H>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Smooth but distinct data in the valid and ghost cells of every component.
+void fill (MultiFab& mf, Real seed)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        auto const& a = mf.array(mfi);
+        amrex::ParallelFor(bx, mf.nComp(), [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+        {
+            a(i,j,k,n) = std::sin(seed + Real(0.1)*i + Real(0.37)*j + Real(0.71)*k + Real(1.3)*n);
+        });
+    }
+}
+
+// The components [comp,comp+ncomp) of a and b, including nghost ghost
+// cells, must agree to round-off.
+void check (const MultiFab& a, const MultiFab& b, int comp, int ncomp, int nghost,
+            const std::string& name)
+{
+    MultiFab diff(a.boxArray(), a.DistributionMap(), ncomp, nghost);
+    MultiFab::Copy(diff, a, comp, 0, ncomp, nghost);
+    MultiFab::Subtract(diff, b, comp, 0, ncomp, nghost);
+    for (int n = 0; n < ncomp; ++n) {
+        const Real err = diff.norm0(n, nghost);
+        const Real ref = a.norm0(comp+n, nghost);
+        if (err > Real(1.e-14)*ref) {
+            amrex::Print() << name << ": component " << n << " differs by " << err << "\n";
+            amrex::Abort("MultiFabExpr: " + name + " does not match");
+        }
+    }
+    amrex::Print() << "  " << name << ": ok\n";
+}
+
+void checkValue (Real a, Real b, const std::string& name)
+{
+    if (std::abs(a-b) > Real(1.e-12)*std::abs(b)) {
+        amrex::Print() << name << ": " << a << " != " << b << "\n";
+        amrex::Abort("MultiFabExpr: " + name + " does not match");
+    }
+    amrex::Print() << "  " << name << ": ok\n";
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    const int ng = 2;
+    const Real a = 1.7, b = -0.3;
+
+    // Operands with more components and ghost cells than are used
+    MultiFab x(ba, dm, 3, ng+1);
+    MultiFab y(ba, dm, 2, ng);
+    MultiFab d0(ba, dm, 2, ng);
+    fill(x, 0.0);
+    fill(y, 1.0);
+    fill(d0, 2.0);
+
+    MultiFab d1(ba, dm, 2, ng), d2(ba, dm, 2, ng);
+
+    // Saxpy: dst += a*src, one component with an offset, then all with ghost cells.
+    MultiFab::Copy(d1, d0, 0, 0, 2, ng);
+    MultiFab::Copy(d2, d0, 0, 0, 2, ng);
+    MultiFab::Saxpy(d1, a, x, 2, 1, 1, ng);
+    amrex::Evaluate(d2, 1, 1, ng, lazy(d2,1) + a*lazy(x,2));
+    check(d1, d2, 0, 2, ng, "Saxpy one component");
+
+    MultiFab::Saxpy(d1, a, x, 1, 0, 2, 0);
+    amrex::Evaluate(d2, 0, 2, 0, lazy(d2) + a*lazy(x,1));
+    check(d1, d2, 0, 2, ng, "Saxpy valid cells");
+
+    // Xpay: dst = src + a*dst
+    MultiFab::Xpay(d1, a, x, 1, 0, 2, ng);
+    amrex::Evaluate(d2, 0, 2, ng, lazy(x,1) + a*lazy(d2));
+    check(d1, d2, 0, 2, ng, "Xpay");
+
+    // LinComb: dst = a*x + b*y
+    MultiFab::LinComb(d1, a, x, 0, b, y, 1, 1, 1, ng);
+    amrex::Evaluate(d2, 1, 1, ng, a*lazy(x) + b*lazy(y,1));
+    check(d1, d2, 0, 2, ng, "LinComb");
+
+    // A chain of them against one expression
+    MultiFab::Copy(d1, y, 0, 0, 2, ng);
+    MultiFab::Multiply(d1, x, 0, 0, 2, ng);
+    MultiFab::LinComb(d1, -b, d1, 0, a, d0, 0, 0, 2, ng);
+    MultiFab::Saxpy(d1, b, x, 1, 0, 2, ng);
+    amrex::Evaluate(d2, 0, 2, IntVect(ng),
+                    a*lazy(d0) - b*lazy(y)*lazy(x) + b*lazy(x,1));
+    check(d1, d2, 0, 2, ng, "chain");
+
+    // Reductions over the valid cells
+    MultiFab::LinComb(d1, a, x, 1, b, y, 0, 0, 2, 0);
+    const Real norm2 = amrex::EvaluateNorm2(d2, 0, 2, a*lazy(x,1) + b*lazy(y));
+    check(d1, d2, 0, 2, 0, "EvaluateNorm2 result");
+    checkValue(norm2, std::sqrt(MultiFab::Dot(d1, 0, d1, 0, 2, 0)), "EvaluateNorm2");
+
+    const Real dot = amrex::EvaluateDot(d2, 0, 2, a*lazy(x,1) + b*lazy(y), lazy(x));
+    checkValue(dot, MultiFab::Dot(d1, 0, x, 0, 2, 0), "EvaluateDot");
+
+    checkValue(amrex::Dot(lazy(x,1), lazy(y), 2), MultiFab::Dot(x, 1, y, 0, 2, 0), "Dot");
+    checkValue(amrex::Norm2(lazy(x,1), 1), x.norm2(1), "Norm2");
+    MultiFab t(ba, dm, 1, 0);
+    MultiFab::Copy(t, x, 2, 0, 1, 0);
+    MultiFab::Multiply(t, y, 1, 0, 1, 0);
+    checkValue(amrex::NormInf(-lazy(x,2)*lazy(y,1), 1), t.norm0(0), "NormInf");
+}
@@ -0,0 +1,173 @@
+// Write a MultiFab and a particle checkpoint through the aggregated writes
+// (vismf.useaggregatedwrites) and through the usual NFiles path, and check
+// that both read back to the data that were written.
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleReduce.H>
+#include <AMReX_Random.H>
+
+using namespace amrex;
+
+using PC = ParticleContainer<1, 0, 1, 0>;
+
+namespace {
+
+void fillRandom (MultiFab& mf)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.array(mfi);
+        amrex::ParallelForRNG(mfi.fabbox(), mf.nComp(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, int n, RandomEngine const& engine) noexcept
+        {
+            a(i,j,k,n) = amrex::Random(engine);
+        });
+    }
+}
+
+// The number of values that differ, counting the ghost cells.
+Long numDifferent (MultiFab const& a, MultiFab const& b)
+{
+    Long ndiff = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        auto const& x = a.const_array(mfi);
+        auto const& y = b.const_array(mfi);
+        const int ncomp = a.nComp();
+        amrex::LoopOnCpu(bx, ncomp, [&] (int i, int j, int k, int n) noexcept
+        {
+            if (x(i,j,k,n) != y(i,j,k,n)) { ++ndiff; }
+        });
+    }
+    ParallelDescriptor::ReduceLongSum(ndiff);
+    return ndiff;
+}
+
+// Sums over the particles that change if any particle or value is lost,
+// duplicated or mixed up with another.
+Vector<Real> particleSums (PC const& pc)
+{
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+    auto r = ParticleReduce<ReduceData<Real,Real,Real,Real> >(pc,
+    [=] AMREX_GPU_DEVICE (const PC::SuperParticleType& p) -> GpuTuple<Real,Real,Real,Real>
+    {
+        const Real id = static_cast<Real>(p.id());
+        Real xs = 0.0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) { xs += p.pos(idim); }
+        return {id, id*xs, id*p.rdata(0), id*p.rdata(1)};
+    }, reduce_op);
+    Vector<Real> sums{amrex::get<0>(r), amrex::get<1>(r), amrex::get<2>(r), amrex::get<3>(r)};
+    ParallelDescriptor::ReduceRealSum(sums.data(), sums.size());
+    return sums;
+}
+
+void checkClose (Vector<Real> const& a, Vector<Real> const& b, const std::string& what)
+{
+    for (int i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i]-b[i]) > Real(1.e-10)*std::abs(a[i])) {
+            amrex::Print() << "  sum " << i << ": " << a[i] << " != " << b[i] << "\n";
+            amrex::Abort("AggregatedWrites: " + what);
+        }
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        Long nparticles = 20000;
+        int nfiles = 1;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nparticles", nparticles);
+            pp.query("nfiles", nfiles);
+        }
+        AMREX_ALWAYS_ASSERT(VisMF::GetUseAggregatedWrites());
+        amrex::Print() << ParallelDescriptor::NProcs() << " ranks, " << nfiles
+                       << " files, chunks of " << VisMF::GetAggregateChunkSize() << " bytes\n";
+
+        RealBox real_box(AMREX_D_DECL(0.,0.,0.), AMREX_D_DECL(1.,1.,1.));
+        Geometry geom(Box(IntVect(0),IntVect(n_cell-1)), real_box,
+                      CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        VisMF::SetNOutFiles(nfiles);
+        {
+            ParmParse pp("particles");
+            pp.add("particles_nfiles", nfiles);
+        }
+
+        // MultiFab
+        {
+            MultiFab mf(ba, dm, 3, 1);
+            fillRandom(mf);
+
+            VisMF::SetUseAggregatedWrites(false);
+            VisMF::Write(mf, "mf_nfiles");
+            VisMF::SetUseAggregatedWrites(true);
+            VisMF::Write(mf, "mf_aggregated");
+
+            MultiFab mf_nfiles(ba, dm, 3, 1);
+            MultiFab mf_aggregated(ba, dm, 3, 1);
+            VisMF::Read(mf_nfiles, "mf_nfiles");
+            VisMF::Read(mf_aggregated, "mf_aggregated");
+            if (numDifferent(mf_nfiles, mf) != 0) {
+                amrex::Abort("AggregatedWrites: the MultiFab written by NFiles reads back wrong");
+            }
+            if (numDifferent(mf_aggregated, mf) != 0) {
+                amrex::Abort("AggregatedWrites: the aggregated MultiFab reads back wrong");
+            }
+            amrex::Print() << "  MultiFab: ok\n";
+        }
+
+        // Particle checkpoint
+        {
+            PC pc(geom, dm, ba);
+            PC::ParticleInitData pdata = {{1.0}, {}, {2.0}, {}};
+            pc.InitRandom(nparticles, 451, pdata, false);
+            // Different values for different particles
+            for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+                for (auto& p : pti.GetArrayOfStructs()) {
+                    p.rdata(0) = p.pos(0) + 2.0*p.pos(1);
+                }
+                auto& soa = pti.GetStructOfArrays().GetRealData(0);
+                auto const& aos = pti.GetArrayOfStructs();
+                for (int i = 0; i < soa.size(); ++i) {
+                    soa[i] = 3.0*aos[i].pos(AMREX_SPACEDIM-1) - 1.0;
+                }
+            }
+            const Vector<Real> expected = particleSums(pc);
+
+            VisMF::SetUseAggregatedWrites(false);
+            pc.Checkpoint("chk_nfiles", "particle0", true);
+            VisMF::SetUseAggregatedWrites(true);
+            pc.Checkpoint("chk_aggregated", "particle0", true);
+
+            PC pc_nfiles(geom, dm, ba);
+            pc_nfiles.Restart("chk_nfiles", "particle0");
+            PC pc_aggregated(geom, dm, ba);
+            pc_aggregated.Restart("chk_aggregated", "particle0");
+
+            AMREX_ALWAYS_ASSERT(pc_nfiles.TotalNumberOfParticles() == nparticles);
+            AMREX_ALWAYS_ASSERT(pc_aggregated.TotalNumberOfParticles() == nparticles);
+            checkClose(expected, particleSums(pc_nfiles), "the NFiles checkpoint reads back wrong");
+            checkClose(expected, particleSums(pc_aggregated), "the aggregated checkpoint reads back wrong");
+            if (particleSums(pc_nfiles) != particleSums(pc_aggregated)) {
+                amrex::Abort("AggregatedWrites: the two checkpoints read back differently");
+            }
+            amrex::Print() << "  particle checkpoint: ok\n";
+        }
+    }
+    amrex::Finalize();
+}
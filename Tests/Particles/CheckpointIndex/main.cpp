@@ -0,0 +1,128 @@
+// Check the per-grid index (Level_<lev>/Particle_I) of particle
+// checkpoints, and restarting only the particles inside a region.
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleUtil.H>
+#include <AMReX_ParticleReduce.H>
+
+using namespace amrex;
+
+using PC = ParticleContainer<1, 0, 1, 0>;
+
+namespace {
+
+// Number of particles inside region and the sum of their ids.
+std::pair<Long,Long> countInside (PC const& pc, RealBox const& region)
+{
+    ReduceOps<ReduceOpSum, ReduceOpSum> reduce_op;
+    auto r = ParticleReduce<ReduceData<Long,Long> >(pc,
+    [=] AMREX_GPU_DEVICE (const PC::SuperParticleType& p) -> GpuTuple<Long,Long>
+    {
+        const Real pos[AMREX_SPACEDIM] = {AMREX_D_DECL(p.pos(0), p.pos(1), p.pos(2))};
+        const bool inside = region.contains(pos);
+        return {inside ? 1 : 0, inside ? static_cast<Long>(p.id()) : 0};
+    }, reduce_op);
+    Long n = amrex::get<0>(r);
+    Long ids = amrex::get<1>(r);
+    ParallelDescriptor::ReduceLongSum(n);
+    ParallelDescriptor::ReduceLongSum(ids);
+    return std::make_pair(n, ids);
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        Long nparticles = 20000;
+        Vector<Real> region_lo{AMREX_D_DECL(0.1,0.2,0.3)};
+        Vector<Real> region_hi{AMREX_D_DECL(0.45,0.6,0.9)};
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nparticles", nparticles);
+            pp.queryarr("region_lo", region_lo);
+            pp.queryarr("region_hi", region_hi);
+        }
+
+        RealBox real_box(AMREX_D_DECL(0.,0.,0.), AMREX_D_DECL(1.,1.,1.));
+        Geometry geom(Box(IntVect(0),IntVect(n_cell-1)), real_box,
+                      CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        PC pc(geom, dm, ba);
+        PC::ParticleInitData pdata = {{1.0}, {}, {2.0}, {}};
+        pc.InitRandom(nparticles, 451, pdata, false);
+
+        const std::string dir("chk_particles");
+        const std::string name("particle0");
+        pc.Checkpoint(dir, name, true);
+
+        // The index must have one entry per grid with the right count, and
+        // the bounds must contain the particles of the grid.
+        ParticleFileIndex index;
+        if (!index.read(dir + "/" + name + "/Level_0/Particle_I")) {
+            amrex::Abort("CheckpointIndex: no index was written");
+        }
+        AMREX_ALWAYS_ASSERT(static_cast<int>(index.count.size()) == ba.size());
+
+        Vector<Long> count(ba.size(), 0);
+        int nbad = 0;
+        for (PC::ParConstIterType pti(pc, 0); pti.isValid(); ++pti) {
+            const int grid = pti.index();
+            count[grid] += pti.numParticles();
+            RealBox const& bounds = index.bounds[grid];
+            for (auto const& p : pti.GetArrayOfStructs()) {
+                const Real pos[AMREX_SPACEDIM] = {AMREX_D_DECL(p.pos(0), p.pos(1), p.pos(2))};
+                if (!bounds.contains(pos, 1.e-12)) { ++nbad; }
+            }
+        }
+        ParallelDescriptor::ReduceLongSum(count.data(), count.size());
+        ParallelDescriptor::ReduceIntSum(nbad);
+        for (int i = 0; i < ba.size(); ++i) {
+            if (count[i] != index.count[i]) {
+                amrex::Abort("CheckpointIndex: wrong particle count for grid "+std::to_string(i));
+            }
+        }
+        if (nbad > 0) {
+            amrex::Abort("CheckpointIndex: "+std::to_string(nbad)+" particles outside their grid's bounds");
+        }
+
+        // A full restart gets every particle back.
+        {
+            PC pc2(geom, dm, ba);
+            pc2.Restart(dir, name);
+            AMREX_ALWAYS_ASSERT(pc2.TotalNumberOfParticles() == pc.TotalNumberOfParticles());
+            AMREX_ALWAYS_ASSERT(countInside(pc2, real_box) == countInside(pc, real_box));
+        }
+
+        // A restart with a region gets exactly the particles inside it.
+        RealBox region(region_lo.data(), region_hi.data());
+        const auto expected = countInside(pc, region);
+        const auto ngrids = index.gridsIntersecting(region).size();
+        amrex::Print() << expected.first << " of " << pc.TotalNumberOfParticles()
+                       << " particles in the region, " << ngrids << " of " << ba.size()
+                       << " grids to read\n";
+        AMREX_ALWAYS_ASSERT(ngrids > 0 && static_cast<int>(ngrids) < ba.size());
+        {
+            PC pc2(geom, dm, ba);
+            pc2.Restart(dir, name, region);
+            const Long n = pc2.TotalNumberOfParticles();
+            if (n != expected.first || countInside(pc2, region) != expected) {
+                amrex::Abort("CheckpointIndex: restart with a region read "+std::to_string(n)
+                             +" particles, expected "+std::to_string(expected.first));
+            }
+            pc2.Redistribute();
+            AMREX_ALWAYS_ASSERT(pc2.OK());
+        }
+    }
+    amrex::Finalize();
+}
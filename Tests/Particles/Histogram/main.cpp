@@ -0,0 +1,243 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Histogram.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleReduce.H>
+
+#include <limits>
+
+using namespace amrex;
+
+using PC = ParticleContainer<2, 0, 0, 0>;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+constexpr int nbins = 10;
+
+// Values in [-1.1,10.9), so that some bins fall outside [0,nbins).
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real binValue (Long n) noexcept
+{
+    return Real(-1.1) + Real(0.37)*static_cast<Real>((n*7919) % 33);
+}
+
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+int binOf (Real v) noexcept
+{
+    return static_cast<int>(amrex::Math::floor(v));
+}
+
+void initParticles (PC& pc, int ppc)
+{
+    const int lev = 0;
+    const auto plo = pc.Geom(lev).ProbLoArray();
+    const auto dx = pc.Geom(lev).CellSizeArray();
+    for (MFIter mfi = pc.MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        const Box& tile_box = mfi.tilebox();
+        Gpu::HostVector<PC::ParticleType> host_particles;
+        for (IntVect iv = tile_box.smallEnd(); iv <= tile_box.bigEnd(); tile_box.next(iv))
+        {
+            for (int k = 0; k < ppc; ++k) {
+                PC::ParticleType p;
+                p.id()  = PC::ParticleType::NextID();
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + (k+Real(0.5))/ppc)*dx[d];
+                }
+                p.rdata(0) = binValue(p.id() + 1000*p.cpu());
+                p.rdata(1) = Real(0.5) + Real(0.001)*(p.id() % 1013);
+                host_particles.push_back(p);
+            }
+        }
+        auto& ptile = pc.DefineAndReturnParticleTile(lev, mfi.index(), mfi.LocalTileIndex());
+        const auto old_size = ptile.GetArrayOfStructs().size();
+        ptile.resize(old_size + host_particles.size());
+        Gpu::copy(Gpu::hostToDevice, host_particles.begin(), host_particles.end(),
+                  ptile.GetArrayOfStructs().begin() + old_size);
+    }
+    Gpu::synchronize();
+    pc.Redistribute();
+}
+
+struct HostBins
+{
+    Vector<Long> count = Vector<Long>(nbins, 0);
+    Vector<Real> sum = Vector<Real>(nbins, 0);
+    Vector<Real> min = Vector<Real>(nbins, std::numeric_limits<Real>::max());
+    Vector<Real> max = Vector<Real>(nbins, std::numeric_limits<Real>::lowest());
+
+    void add (Real bv, Real v)
+    {
+        const int b = binOf(bv);
+        if (b >= 0 && b < nbins) {
+            ++count[b];
+            sum[b] += v;
+            min[b] = std::min(min[b], v);
+            max[b] = std::max(max[b], v);
+        }
+    }
+
+    void reduce ()
+    {
+        ParallelDescriptor::ReduceLongSum(count.data(), nbins);
+        ParallelDescriptor::ReduceRealSum(sum.data(), nbins);
+        ParallelDescriptor::ReduceRealMin(min.data(), nbins);
+        ParallelDescriptor::ReduceRealMax(max.data(), nbins);
+    }
+};
+
+HostBins particleHostBins (PC const& pc)
+{
+    HostBins h;
+    for (PC::ParConstIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto& aos = pti.GetArrayOfStructs();
+        Gpu::HostVector<PC::ParticleType> host_particles(aos.numParticles());
+        Gpu::copy(Gpu::deviceToHost, aos().begin(), aos().end(), host_particles.begin());
+        for (const auto& p : host_particles) {
+            h.add(p.rdata(0), p.rdata(1));
+        }
+    }
+    return h;
+}
+
+HostBins meshHostBins (MultiFab const& mf, Real fac)
+{
+    HostBins h;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            const Long n = bx.index(iv) + 100000*mfi.index();
+            h.add(binValue(n), fac*binValue(n));
+        }
+    }
+    return h;
+}
+
+template <typename T>
+void checkEqual (Vector<T> const& a, Vector<T> const& b, const char* what)
+{
+    if (a.size() != b.size()) {
+        amrex::Abort(std::string("Histogram: wrong number of bins in ") + what);
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i]) {
+            amrex::Abort(std::string("Histogram: ") + what + " differs");
+        }
+    }
+}
+
+void checkClose (Vector<Real> const& a, Vector<Real> const& b, const char* what)
+{
+    if (a.size() != b.size()) {
+        amrex::Abort(std::string("Histogram: wrong number of bins in ") + what);
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i]-b[i]) > Real(1.e-12)*std::abs(b[i])) {
+            amrex::Abort(std::string("Histogram: ") + what + " differs");
+        }
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int ppc = 2;
+    {
+        ParmParse pp("hist");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("ppc", ppc);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+    const Geometry geom(domain, real_box, CoordSys::cartesian, is_per);
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    const DistributionMapping dm(ba);
+    const int myproc = ParallelDescriptor::MyProc();
+    const int root = ParallelDescriptor::NProcs()-1;
+
+    {
+        PC pc(geom, dm, ba);
+        initParticles(pc, ppc);
+
+        using SPType = PC::SuperParticleType;
+        auto fbin = [=] AMREX_GPU_HOST_DEVICE (const SPType& p) noexcept -> int
+                        { return binOf(p.rdata(0)); };
+        auto fval = [=] AMREX_GPU_HOST_DEVICE (const SPType& p) noexcept -> Real
+                        { return p.rdata(1); };
+
+        HostBins local = particleHostBins(pc);
+        checkEqual(HistogramCount(pc, nbins, fbin, true), local.count, "local particle count");
+        checkClose(Histogram<ReduceOpSum>(pc, nbins, fbin, fval, true), local.sum, "local particle sum");
+
+        HostBins global = local;
+        global.reduce();
+        Long np_in_bins = 0;
+        for (auto n : global.count) { np_in_bins += n; }
+        if (np_in_bins == 0 || np_in_bins == pc.TotalNumberOfParticles()) {
+            amrex::Abort("Histogram: the particle values do not exercise skipped bins");
+        }
+        checkEqual(HistogramCount(pc, nbins, fbin), global.count, "particle count");
+        checkClose(Histogram<ReduceOpSum>(pc, nbins, fbin, fval), global.sum, "particle sum");
+        checkEqual(Histogram<ReduceOpMin>(pc, nbins, fbin, fval), global.min, "particle min");
+        checkEqual(Histogram<ReduceOpMax>(pc, 0, 0, nbins, fbin, fval), global.max, "particle max");
+
+        const auto count_root = HistogramCount(pc, nbins, fbin, false, root);
+        if (myproc == root) {
+            checkEqual(count_root, global.count, "particle count on root");
+        }
+        amrex::Print() << "  particle histograms: ok\n";
+    }
+
+    {
+        const Real fac = 2.0;
+        MultiFab mf(ba, dm, 1, 1);
+        mf.setVal(std::numeric_limits<Real>::quiet_NaN());
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            const auto& a = mf.array(mfi);
+            const int gid = mfi.index();
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                a(i,j,k) = binValue(bx.index(IntVect(AMREX_D_DECL(i,j,k))) + 100000*gid);
+            });
+        }
+
+        auto fbin = [=] AMREX_GPU_HOST_DEVICE (Array4<Real const> const& a, int i, int j, int k) noexcept
+                        -> int { return binOf(a(i,j,k)); };
+        auto fval = [=] AMREX_GPU_HOST_DEVICE (Array4<Real const> const& a, int i, int j, int k) noexcept
+                        -> Real { return fac*a(i,j,k); };
+
+        HostBins global = meshHostBins(mf, fac);
+        global.reduce();
+        checkEqual(HistogramCount(mf, IntVect(0), nbins, fbin), global.count, "cell count");
+        checkClose(Histogram<ReduceOpSum>(mf, IntVect(0), nbins, fbin, fval), global.sum, "cell sum");
+        checkEqual(Histogram<ReduceOpMin>(mf, IntVect(0), nbins, fbin, fval), global.min, "cell min");
+        checkEqual(Histogram<ReduceOpMax>(mf, IntVect(0), nbins, fbin, fval), global.max, "cell max");
+
+        const auto sum_root = Histogram<ReduceOpSum>(mf, IntVect(0), nbins, fbin, fval, false, root);
+        if (myproc == root) {
+            checkClose(sum_root, global.sum, "cell sum on root");
+        }
+        amrex::Print() << "  mesh histograms: ok\n";
+    }
+}
@@ -0,0 +1,243 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleMesh.H>
+#include <AMReX_ParticleReduce.H>
+
+using namespace amrex;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+class TestParticleContainer
+    : public ParticleContainer<1, 0, 0, 0>
+{
+public:
+
+    TestParticleContainer (const Geometry& geom, const DistributionMapping& dm, const BoxArray& ba)
+        : ParticleContainer<1, 0, 0, 0>(geom, dm, ba)
+    {}
+
+    using ParticleContainer<1, 0, 0, 0>::BalanceParticleLoad;
+
+    // ppc particles in each cell of the low corner region, one in every
+    // other cell elsewhere, so that the grids are far from equally loaded.
+    void InitParticles (const Box& crowded, int ppc)
+    {
+        const int lev = 0;
+        const auto plo = Geom(lev).ProbLoArray();
+        const auto dx = Geom(lev).CellSizeArray();
+
+        for (MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+        {
+            const Box& tile_box = mfi.tilebox();
+            Gpu::HostVector<ParticleType> host_particles;
+            for (IntVect iv = tile_box.smallEnd(); iv <= tile_box.bigEnd(); tile_box.next(iv))
+            {
+                const int n = crowded.contains(iv) ? ppc : (iv.sum() % 2);
+                for (int k = 0; k < n; ++k) {
+                    ParticleType p;
+                    p.id()  = ParticleType::NextID();
+                    p.cpu() = ParallelDescriptor::MyProc();
+                    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                        p.pos(d) = plo[d] + (iv[d] + (k+Real(0.5))/(ppc+1))*dx[d];
+                    }
+                    p.rdata(0) = Real(1.) + Real(0.01)*(p.id()%97);
+                    host_particles.push_back(p);
+                }
+            }
+
+            auto& ptile = DefineAndReturnParticleTile(lev, mfi.index(), mfi.LocalTileIndex());
+            const auto old_size = ptile.GetArrayOfStructs().size();
+            ptile.resize(old_size + host_particles.size());
+            Gpu::copy(Gpu::hostToDevice, host_particles.begin(), host_particles.end(),
+                      ptile.GetArrayOfStructs().begin() + old_size);
+        }
+        Gpu::synchronize();
+        Redistribute();
+    }
+};
+
+// The largest number of particles on a process over the mean.
+Real imbalance (TestParticleContainer const& pc)
+{
+    Long np_local = pc.TotalNumberOfParticles(true, true);
+    Long np_max = np_local;
+    Long np_sum = np_local;
+    ParallelDescriptor::ReduceLongMax(np_max);
+    ParallelDescriptor::ReduceLongSum(np_sum);
+    return static_cast<Real>(np_max) * ParallelDescriptor::NProcs() / static_cast<Real>(np_sum);
+}
+
+// Cloud-in-cell deposition of the particle weight.
+void deposit (TestParticleContainer const& pc, MultiFab& mf)
+{
+    ParticleToMesh(pc, mf, 0,
+        [=] AMREX_GPU_DEVICE (const TestParticleContainer::ParticleType& p,
+                              Array4<Real> const& rho,
+                              GpuArray<Real,AMREX_SPACEDIM> const& plo,
+                              GpuArray<Real,AMREX_SPACEDIM> const& dxi) noexcept
+        {
+            Real w[AMREX_SPACEDIM][2];
+            int lo[AMREX_SPACEDIM];
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                const Real x = (p.pos(d) - plo[d])*dxi[d] - Real(0.5);
+                lo[d] = static_cast<int>(amrex::Math::floor(x));
+                w[d][1] = x - lo[d];
+                w[d][0] = Real(1.) - w[d][1];
+            }
+#if (AMREX_SPACEDIM == 3)
+            for (int kk = 0; kk < 2; ++kk) {
+#else
+            for (int kk = 0; kk < 1; ++kk) {
+#endif
+#if (AMREX_SPACEDIM >= 2)
+            for (int jj = 0; jj < 2; ++jj) {
+#else
+            for (int jj = 0; jj < 1; ++jj) {
+#endif
+            for (int ii = 0; ii < 2; ++ii) {
+                Real wt = p.rdata(0)*w[0][ii];
+#if (AMREX_SPACEDIM >= 2)
+                wt *= w[1][jj];
+#endif
+#if (AMREX_SPACEDIM == 3)
+                wt *= w[2][kk];
+#endif
+                Gpu::Atomic::AddNoRet(&rho(AMREX_D_DECL(lo[0]+ii, lo[1]+jj, lo[2]+kk)), wt);
+            }}}
+        });
+}
+
+void checkClose (MultiFab const& a, MultiFab const& b, Real tol, const char* what)
+{
+    MultiFab diff(a.boxArray(), a.DistributionMap(), 1, 0);
+    MultiFab::Copy(diff, a, 0, 0, 1, 0);
+    MultiFab::Subtract(diff, b, 0, 0, 1, 0);
+    const Real err = diff.norminf(0, 0);
+    const Real scale = a.norminf(0, 0);
+    if (err > tol*scale) {
+        amrex::Abort(std::string("LoadBalance: ") + what + " differ");
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 8;
+    int ppc = 8;
+    {
+        ParmParse pp("lb");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("ppc", ppc);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+    const Geometry geom(domain, real_box, CoordSys::cartesian, is_per);
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    const DistributionMapping dm(ba);
+    const Box crowded(IntVect(0), IntVect(n_cell/4-1));
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    TestParticleContainer pc(geom, dm, ba);
+    pc.InitParticles(crowded, ppc);
+    const Long np = pc.TotalNumberOfParticles();
+
+    // The deposit on the mesh grids before balancing takes the path in which
+    // the particles live on the grids of the MultiFab.
+    MultiFab rho_same(ba, dm, 1, 1);
+    deposit(pc, rho_same);
+
+    const Real imbalance_before = imbalance(pc);
+    const bool changed = pc.LoadBalance();
+    const Real imbalance_after = imbalance(pc);
+    amrex::Print() << "  " << np << " particles, imbalance " << imbalance_before
+                   << " -> " << imbalance_after << "\n";
+
+    if (pc.TotalNumberOfParticles() != np) {
+        amrex::Abort("LoadBalance: number of particles changed");
+    }
+    if (!pc.OK()) {
+        amrex::Abort("LoadBalance: particles are not in their grids");
+    }
+    if (pc.ParticleBoxArray(0) != ba) {
+        amrex::Abort("LoadBalance: the particle BoxArray changed");
+    }
+    if (nprocs > 1) {
+        if (!changed || pc.ParticleDistributionMap(0) == dm) {
+            amrex::Abort("LoadBalance: the DistributionMapping was not changed");
+        }
+        if (imbalance_after >= imbalance_before) {
+            amrex::Abort("LoadBalance: the imbalance did not drop");
+        }
+    } else if (changed) {
+        amrex::Abort("LoadBalance: a single process was rebalanced");
+    }
+
+    // Balanced particles cannot be improved by the threshold factor again.
+    const DistributionMapping dm_balanced = pc.ParticleDistributionMap(0);
+    if (pc.LoadBalance() ||
+        pc.BalanceParticleLoad(0, pc.NumberOfParticlesInGrid(0)) ||
+        !(pc.ParticleDistributionMap(0) == dm_balanced)) {
+        amrex::Abort("LoadBalance: balanced twice");
+    }
+    amrex::Print() << "  LoadBalance: ok\n";
+
+    // The same BoxArray takes the box by box path of add_to_mesh; another
+    // BoxArray takes the general ParallelAdd.  Both must agree with the
+    // deposit done before the particles moved.
+    MultiFab rho_fast(ba, dm, 1, 1);
+    deposit(pc, rho_fast);
+
+    BoxArray ba_other(domain);
+    ba_other.maxSize(max_grid_size*2);
+    const DistributionMapping dm_other(ba_other);
+    MultiFab rho_general(ba_other, dm_other, 1, 2);
+    deposit(pc, rho_general);
+    MultiFab rho_general_on_ba(ba, dm, 1, 0);
+    rho_general_on_ba.ParallelCopy(rho_general, 0, 0, 1);
+
+    checkClose(rho_same, rho_fast, Real(1.e-13), "the deposits before and after balancing");
+    checkClose(rho_fast, rho_general_on_ba, Real(1.e-13), "the fast and general deposits");
+    using PType = TestParticleContainer::ParticleType;
+    Real weight = amrex::ReduceSum(pc, [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
+                                       { return p.rdata(0); });
+    ParallelDescriptor::ReduceRealSum(weight);
+    if (std::abs(rho_fast.sum(0) - weight) > Real(1.e-12)*weight) {
+        amrex::Abort("LoadBalance: the deposit lost weight");
+    }
+    amrex::Print() << "  add_to_mesh: ok\n";
+
+    // With particles.load_balance_int = 2, every second Redistribute balances.
+    TestParticleContainer pc2(geom, dm, ba);
+    pc2.InitParticles(crowded, ppc);
+    ParticleContainerBase::load_balance_int = 2;
+    pc2.Redistribute();
+    if (nprocs > 1 && !(pc2.ParticleDistributionMap(0) == dm)) {
+        amrex::Abort("LoadBalance: balanced on the first Redistribute");
+    }
+    pc2.Redistribute();
+    ParticleContainerBase::load_balance_int = 0;
+    if (nprocs > 1 && pc2.ParticleDistributionMap(0) == dm) {
+        amrex::Abort("LoadBalance: not balanced on the second Redistribute");
+    }
+    if (pc2.TotalNumberOfParticles() != np || !pc2.OK()) {
+        amrex::Abort("LoadBalance: Redistribute lost particles while balancing");
+    }
+    amrex::Print() << "  load_balance_int: ok\n";
+}
@@ -3,6 +3,8 @@
 
 #include "CheckPair.H"
 
+#include <algorithm>
+
 using namespace amrex;
 
 namespace
@@ -218,6 +220,38 @@ void MDParticleContainer::moveParticles(amrex::Real dx)
     }
 }
 
+void MDParticleContainer::moveParticlesRandomly(amrex::Real max_dx)
+{
+    BL_PROFILE("MDParticleContainer::moveParticlesRandomly");
+
+    const int lev = 0;
+    auto& plev  = GetParticles(lev);
+
+    // Each component is at most max_dx/sqrt(3), so the length is at most max_dx.
+    const Real a = max_dx / std::sqrt(3.0);
+
+    for(MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        int gid = mfi.index();
+        int tid = mfi.LocalTileIndex();
+
+        auto& ptile = plev[std::make_pair(gid, tid)];
+        auto& aos   = ptile.GetArrayOfStructs();
+        ParticleType* pstruct = &(aos[0]);
+
+        const int np = aos.numParticles();
+
+        amrex::ParallelForRNG( np,
+        [=] AMREX_GPU_DEVICE (int i, RandomEngine const& engine) noexcept
+        {
+            ParticleType& p = pstruct[i];
+            p.pos(0) += a*(2.0*amrex::Random(engine) - 1.0);
+            p.pos(1) += a*(2.0*amrex::Random(engine) - 1.0);
+            p.pos(2) += a*(2.0*amrex::Random(engine) - 1.0);
+        });
+    }
+}
+
 void MDParticleContainer::writeParticles(const int n)
 {
     BL_PROFILE("MDParticleContainer::writeParticles");
@@ -318,7 +352,7 @@ void MDParticleContainer::checkNeighborParticles()
 #endif
 }
 
-void MDParticleContainer::checkNeighborList()
+void MDParticleContainer::checkNeighborList(amrex::Real skin, bool reused)
 {
     BL_PROFILE("MDParticleContainer::checkNeighborList");
 
@@ -380,15 +414,38 @@ void MDParticleContainer::checkNeighborList()
                 }
             }
 
+            // A reused list was built with cutoff+skin, and since then each
+            // particle of a pair may have moved by up to half the skin.
+            const Real skin_cutoff = 5.0*Params::cutoff + (reused ? 2.0*skin : skin);
             for (const auto& p2 : nbor_data.getNeighbors(i))
             {
                 Gpu::Atomic::AddNoRet(&(p_neighbor_count[i]),1);
+
+                Real dx = p1.pos(0) - p2.pos(0);
+                Real dy = p1.pos(1) - p2.pos(1);
+                Real dz = p1.pos(2) - p2.pos(2);
+                if (skin > 0.0 && dx*dx + dy*dy + dz*dz > skin_cutoff*skin_cutoff) {
+                    amrex::PrintToFile("neighbor_test") << "Neighbor list of particle " << i
+                                                        << " has a particle beyond its bound" << std::endl;
+                    amrex::Abort();
+                }
                 nbor_nbors.push_back(p2.id());
             }
 
             std::sort(full_nbors.begin(), full_nbors.end());
             std::sort(nbor_nbors.begin(), nbor_nbors.end());
 
+            if (skin > 0.0)
+            {
+                if (!std::includes(nbor_nbors.begin(), nbor_nbors.end(),
+                                   full_nbors.begin(), full_nbors.end()))
+                {
+                    amrex::PrintToFile("neighbor_test") << "Neighbor list misses neighbors of particle " << i << std::endl;
+                    amrex::Abort();
+                }
+                continue;
+            }
+
             if (nbor_nbors.size() != full_nbors.size())
             {
                amrex::PrintToFile("neighbor_test") << "Number of neighbors do not match for particle " << i << std::endl;
@@ -183,4 +183,38 @@ void testNeighborList ()
     pc.buildNeighborList(CheckPair());
 
     pc.checkNeighborList();
+
+    amrex::PrintToFile("neighbor_test") << "Testing neighbor list reuse with a skin" << std::endl;
+
+    const Real skin = 0.5;
+    pc.setNeighborListSkin(skin);
+    pc.buildNeighborList(CheckPairWithSkin{skin});
+    pc.checkNeighborList(skin);
+
+    // Different displacements for different particles, so the distances
+    // change while the lists are reused.
+    amrex::ResetRandomSeed(ParallelDescriptor::MyProc()+1);
+    pc.moveParticlesRandomly(0.4*skin);
+    pc.updateNeighbors();
+    AMREX_ALWAYS_ASSERT( ! pc.neighborListNeedsRebuild());
+
+    // The lists are reused here.
+    pc.buildNeighborList(CheckPairWithSkin{skin});
+    pc.checkNeighborList(skin, true);
+
+    // Every particle is now more than half the skin from where it was.
+    pc.moveParticles(0.3);
+    pc.updateNeighbors();
+    AMREX_ALWAYS_ASSERT(pc.neighborListNeedsRebuild());
+
+    // The particles have moved too far, so the lists are rebuilt.
+    pc.buildNeighborList(CheckPairWithSkin{skin});
+    pc.checkNeighborList(skin);
+    AMREX_ALWAYS_ASSERT( ! pc.neighborListNeedsRebuild());
+
+    pc.Redistribute();
+    pc.fillNeighbors();
+    pc.buildNeighborList(CheckPairWithSkin{skin});
+
+    pc.checkNeighborList(skin);
 }
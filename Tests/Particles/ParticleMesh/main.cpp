@@ -6,6 +6,7 @@
 #include "AMReX_Particles.H"
 #include "AMReX_PlotFileUtil.H"
 #include <AMReX_ParticleMesh.H>
+#include <AMReX_ParticleReduce.H>
 
 using namespace amrex;
 
@@ -15,9 +16,201 @@ struct TestParams {
   int nz;
   int max_grid_size;
   int nppc;
+  int nbench;
   bool verbose;
 };
 
+// The shape factor of order Order at a distance r, in cells, from a point.
+template <int Order>
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+amrex::Real shapeWeight (amrex::Real r)
+{
+    r = amrex::Math::abs(r);
+    if (Order == 1) {
+        return (r < 1.) ? 1.-r : 0.;
+    } else if (Order == 2) {
+        return (r < 0.5) ? 0.75-r*r : ((r < 1.5) ? 0.5*(1.5-r)*(1.5-r) : 0.);
+    } else {
+        return (r < 1.) ? (4.-6.*r*r+3.*r*r*r)/6. : ((r < 2.) ? (2.-r)*(2.-r)*(2.-r)/6. : 0.);
+    }
+}
+
+// Compare ParticleToMeshSoA<Order> and MeshToParticleSoA<Order> with
+// ParticleToMesh and MeshToParticle using the shape factors above on the
+// 4 points around each particle in each direction.
+template <int Order, class PC>
+void checkShapeOrder (PC& pc, const BoxArray& ba, const DistributionMapping& dmap,
+                      const Geometry& geom)
+{
+  using ParticleType = typename PC::ParticleType;
+  const int nc = 1 + BL_SPACEDIM;
+  const auto plo = geom.ProbLoArray();
+  const auto dxi = geom.InvCellSizeArray();
+
+  // The stencil of the particles in the last cells reaches 2 ghost cells.
+  MultiFab rho_ref(ba, dmap, nc, 2);
+  MultiFab rho_soa(ba, dmap, nc, 2);
+
+  amrex::ParticleToMesh(pc, rho_ref, 0,
+      [=] AMREX_GPU_DEVICE (const ParticleType& p, amrex::Array4<amrex::Real> const& rho)
+      {
+          amrex::Real x[3] = {0., 0., 0.};
+          int lo[3] = {0, 0, 0};
+          for (int d = 0; d < BL_SPACEDIM; ++d) {
+              x[d] = (p.pos(d) - plo[d]) * dxi[d] - 0.5;
+              lo[d] = static_cast<int>(amrex::Math::floor(x[d])) - 1;
+          }
+          for (int kk = 0; kk < 4; ++kk) {
+          for (int jj = 0; jj < 4; ++jj) {
+          for (int ii = 0; ii < 4; ++ii) {
+              const amrex::Real w = shapeWeight<Order>(x[0]-lo[0]-ii)
+                  *                 shapeWeight<Order>(x[1]-lo[1]-jj)
+                  *                 shapeWeight<Order>(x[2]-lo[2]-kk);
+              if (w == 0.) continue;
+              for (int comp = 0; comp < nc; ++comp) {
+                  const amrex::Real q = (comp == 0) ? p.rdata(0) : p.rdata(0)*p.rdata(comp);
+                  amrex::Gpu::Atomic::AddNoRet(&rho(lo[0]+ii, lo[1]+jj, lo[2]+kk, comp), w*q);
+              }
+          }}}
+      });
+
+  amrex::ParticleToMeshSoA<Order>(pc, rho_soa, 0,
+      [=] AMREX_GPU_HOST_DEVICE (const typename PC::ParticleTileType::ConstParticleTileDataType& ptd,
+                                 int i, int comp) -> amrex::Real
+      {
+          const auto& p = ptd.m_aos[i];
+          return (comp == 0) ? p.rdata(0) : p.rdata(0)*p.rdata(comp);
+      });
+
+  MultiFab::Subtract(rho_soa, rho_ref, 0, 0, nc, 0);
+  for (int comp = 0; comp < nc; ++comp) {
+      const amrex::Real err = rho_soa.norm0(comp, 0);
+      if (err > 1.e-12*rho_ref.norm0(comp, 0)) {
+          amrex::Print() << "Order " << Order << " deposition, component " << comp
+                         << ": difference " << err << '\n';
+          amrex::Abort("ParticleToMeshSoA does not match ParticleToMesh");
+      }
+  }
+
+  // A smooth field, with the ghost cells filled.
+  MultiFab field(ba, dmap, BL_SPACEDIM, 2);
+  for (MFIter mfi(field); mfi.isValid(); ++mfi) {
+      auto const& f = field.array(mfi);
+      const amrex::Real h = 1./geom.Domain().length(0);
+      amrex::ParallelFor(mfi.validbox(), BL_SPACEDIM,
+      [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+      {
+          f(i,j,k,n) = std::sin(6.28318530717958648*h*(i + 2*j + 3*k + n)) + n;
+      });
+  }
+  field.FillBoundary(geom.periodicity());
+
+  amrex::MeshToParticle(pc, field, 0,
+      [=] AMREX_GPU_DEVICE (ParticleType& p, amrex::Array4<const amrex::Real> const& acc)
+      {
+          amrex::Real x[3] = {0., 0., 0.};
+          int lo[3] = {0, 0, 0};
+          for (int d = 0; d < BL_SPACEDIM; ++d) {
+              x[d] = (p.pos(d) - plo[d]) * dxi[d] - 0.5;
+              lo[d] = static_cast<int>(amrex::Math::floor(x[d])) - 1;
+          }
+          for (int comp = 0; comp < BL_SPACEDIM; ++comp) {
+              amrex::Real a = 0.;
+              for (int kk = 0; kk < 4; ++kk) {
+              for (int jj = 0; jj < 4; ++jj) {
+              for (int ii = 0; ii < 4; ++ii) {
+                  const amrex::Real w = shapeWeight<Order>(x[0]-lo[0]-ii)
+                      *                 shapeWeight<Order>(x[1]-lo[1]-jj)
+                      *                 shapeWeight<Order>(x[2]-lo[2]-kk);
+                  if (w != 0.) { a += w*acc(lo[0]+ii, lo[1]+jj, lo[2]+kk, comp); }
+              }}}
+              p.rdata(4+comp) = a;
+          }
+      });
+
+  // Store the difference with the reference in the particles.
+  amrex::MeshToParticleSoA<Order>(pc, field, 0,
+      [=] AMREX_GPU_HOST_DEVICE (const typename PC::ParticleTileType::ParticleTileDataType& ptd,
+                                 int i, int comp, amrex::Real val)
+      {
+          ptd.m_aos[i].rdata(4+comp) = val - ptd.m_aos[i].rdata(4+comp);
+      });
+
+  using PType = typename PC::SuperParticleType;
+  const amrex::Real err = amrex::ReduceMax(pc,
+      [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> amrex::Real
+      {
+          amrex::Real e = 0.;
+          for (int comp = 0; comp < BL_SPACEDIM; ++comp) {
+              e = amrex::max(e, amrex::Math::abs(p.rdata(4+comp)));
+          }
+          return e;
+      });
+  if (err > 1.e-12*field.norm0(0)) {
+      amrex::Print() << "Order " << Order << " interpolation: difference " << err << '\n';
+      amrex::Abort("MeshToParticleSoA does not match MeshToParticle");
+  }
+
+  amrex::Print() << "Order " << Order << " shape factors: batched kernels match\n";
+}
+
+// Invalidate the first particle of each tile and move it far outside the
+// domain.  The batched kernels must leave it out: nothing is deposited
+// from it and nothing is interpolated to it.
+template <int Order, class PC>
+void checkInvalidParticles (PC& pc, const BoxArray& ba, const DistributionMapping& dmap)
+{
+  Long nvalid = 0;
+  for (typename PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+      auto& aos = pti.GetArrayOfStructs();
+      for (int i = 0; i < aos.numParticles(); ++i) {
+          auto& p = aos[i];
+          if (i == 0) {
+              p.id() = -1;
+              for (int d = 0; d < BL_SPACEDIM; ++d) { p.pos(d) = 1.e10; }
+              p.rdata(4) = -7.0;
+          } else if (p.id() >= 0) {
+              ++nvalid;
+          }
+      }
+  }
+  ParallelDescriptor::ReduceLongSum(nvalid);
+
+  MultiFab count(ba, dmap, 1, 2);
+  amrex::ParticleToMeshSoA<Order>(pc, count, 0,
+      [=] AMREX_GPU_HOST_DEVICE (const typename PC::ParticleTileType::ConstParticleTileDataType&,
+                                 int, int) -> amrex::Real
+      {
+          return 1.0;
+      });
+  if (std::abs(count.sum(0) - nvalid) > 1.e-9*nvalid) {
+      amrex::Print() << "Order " << Order << ": deposited " << count.sum(0)
+                     << " particles out of " << nvalid << '\n';
+      amrex::Abort("ParticleToMeshSoA deposits invalid particles");
+  }
+
+  MultiFab field(ba, dmap, 1, 2);
+  field.setVal(1.0);
+  amrex::MeshToParticleSoA<Order>(pc, field, 0,
+      [=] AMREX_GPU_HOST_DEVICE (const typename PC::ParticleTileType::ParticleTileDataType& ptd,
+                                 int i, int, amrex::Real val)
+      {
+          ptd.m_aos[i].rdata(4) = val;
+      });
+  for (typename PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+      auto& aos = pti.GetArrayOfStructs();
+      for (int i = 0; i < aos.numParticles(); ++i) {
+          const auto& p = aos[i];
+          const amrex::Real expected = (p.id() < 0) ? -7.0 : 1.0;
+          if (std::abs(p.rdata(4) - expected) > 1.e-12) {
+              amrex::Abort("MeshToParticleSoA interpolates to invalid particles");
+          }
+      }
+  }
+
+  amrex::Print() << "Order " << Order << " shape factors: invalid particles skipped\n";
+}
+
 void testParticleMesh (TestParams& parms)
 {
 
@@ -66,7 +259,7 @@ void testParticleMesh (TestParams& parms)
   int nc = 1 + BL_SPACEDIM;
   const auto plo = geom.ProbLoArray();
   const auto dxi = geom.InvCellSizeArray();
-  amrex::ParticleToMesh(myPC, partMF, 0,
+  auto deposit =
       [=] AMREX_GPU_DEVICE (const MyParticleContainer::ParticleType& p,
                             amrex::Array4<amrex::Real> const& rho)
       {
@@ -105,13 +298,14 @@ void testParticleMesh (TestParams& parms)
                   }
               }
           }
-      });
+      };
+  amrex::ParticleToMesh(myPC, partMF, 0, deposit);
 
   MultiFab acceleration(ba, dmap, BL_SPACEDIM, 1);
   acceleration.setVal(5.0);
 
   nc = BL_SPACEDIM;
-  amrex::MeshToParticle(myPC, acceleration, 0,
+  auto interpolate =
       [=] AMREX_GPU_DEVICE (MyParticleContainer::ParticleType& p,
                             amrex::Array4<const amrex::Real> const& acc)
       {
@@ -140,13 +334,73 @@ void testParticleMesh (TestParams& parms)
                   }
               }
           }
-      });
+      };
+  amrex::MeshToParticle(myPC, acceleration, 0, interpolate);
+
+  // Compare with the batched kernels, which compute the cloud-in-cell
+  // shape factors themselves.
+  if (parms.nbench > 0) {
+      auto deposit_soa =
+          [=] AMREX_GPU_HOST_DEVICE (const MyParticleContainer::ParticleTileType::ConstParticleTileDataType& ptd,
+                                     int i, int comp) -> amrex::Real
+          {
+              const auto& p = ptd.m_aos[i];
+              return (comp == 0) ? p.rdata(0) : p.rdata(0)*p.rdata(comp);
+          };
+      auto interpolate_soa =
+          [=] AMREX_GPU_HOST_DEVICE (const MyParticleContainer::ParticleTileType::ParticleTileDataType& ptd,
+                                     int i, int comp, amrex::Real val)
+          {
+              ptd.m_aos[i].rdata(4+comp) = val;
+          };
+
+      MultiFab partMF_soa(ba, dmap, 1 + BL_SPACEDIM, 1);
+      Real t[4] = {0.0, 0.0, 0.0, 0.0};
+      for (int n = 0; n < parms.nbench; ++n) {
+          Real t0 = amrex::second();
+          amrex::ParticleToMesh(myPC, partMF, 0, deposit);
+          Real t1 = amrex::second();
+          amrex::ParticleToMeshSoA<1>(myPC, partMF_soa, 0, deposit_soa);
+          Real t2 = amrex::second();
+          amrex::MeshToParticle(myPC, acceleration, 0, interpolate);
+          Real t3 = amrex::second();
+          amrex::MeshToParticleSoA<1>(myPC, acceleration, 0, interpolate_soa);
+          Real t4 = amrex::second();
+          t[0] += t1-t0;
+          t[1] += t2-t1;
+          t[2] += t3-t2;
+          t[3] += t4-t3;
+      }
+      ParallelDescriptor::ReduceRealMax(t, 4);
+
+      MultiFab::Subtract(partMF_soa, partMF, 0, 0, 1 + BL_SPACEDIM, 0);
+      Real maxdiff = 0.0;
+      for (int comp = 0; comp < 1 + BL_SPACEDIM; ++comp) {
+          maxdiff = std::max(maxdiff, partMF_soa.norm0(comp, 0));
+      }
+
+      amrex::Print() << "ParticleToMesh time : " << t[0]/parms.nbench
+                     << ", batched: " << t[1]/parms.nbench << '\n'
+                     << "MeshToParticle time : " << t[2]/parms.nbench
+                     << ", batched: " << t[3]/parms.nbench << '\n'
+                     << "Max difference      : " << maxdiff << '\n';
+      if (maxdiff > 1.e-12*partMF.norm0(0, 0)) {
+          amrex::Abort("ParticleToMeshSoA<1> does not match ParticleToMesh");
+      }
+  }
+
+  checkShapeOrder<1>(myPC, ba, dmap, geom);
+  checkShapeOrder<2>(myPC, ba, dmap, geom);
+  checkShapeOrder<3>(myPC, ba, dmap, geom);
 
   WriteSingleLevelPlotfile("plot", partMF,
                            {"density", "vx", "vy", "vz"},
                            geom, 0.0, 0);
 
   myPC.Checkpoint("plot", "particle0");
+
+  checkInvalidParticles<1>(myPC, ba, dmap);
+  checkInvalidParticles<3>(myPC, ba, dmap);
 }
 
 int main(int argc, char* argv[])
@@ -165,6 +419,9 @@ int main(int argc, char* argv[])
   if (parms.nppc < 1 && ParallelDescriptor::IOProcessor())
     amrex::Abort("Must specify at least one particle per cell");
 
+  parms.nbench = 1;
+  pp.query("nbench", parms.nbench);
+
   parms.verbose = false;
   pp.query("verbose", parms.verbose);
 
@@ -0,0 +1,208 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleReduce.H>
+
+using namespace amrex;
+
+// The four struct-of-arrays components are sent as float, as 16-bit
+// integers, not at all, and as ParticleReal.  The integer component holds
+// the process a particle was on before it was last moved.
+static constexpr int NAR = 4;
+using PC = ParticleContainer<0, 0, NAR, 1>;
+
+void test ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+constexpr ParticleReal fixed16_scale = 1.e-3;
+
+// The values depend on the id and cpu only, so they can be checked after the
+// particles have moved.
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+ParticleReal expected (int comp, int id, int cpu) noexcept
+{
+    switch (comp) {
+    case 0:  return ParticleReal(1.) + id*ParticleReal(1.e-3) + cpu*ParticleReal(0.5)
+                                     + ParticleReal(1.)/ParticleReal(3.);
+    case 1:  return ParticleReal(30.)*std::sin(id*ParticleReal(0.1) + cpu);
+    case 2:  return ParticleReal(-1.) - id;
+    default: return id + cpu*ParticleReal(0.1) + ParticleReal(1.)/ParticleReal(7.);
+    }
+}
+
+void initParticles (PC& pc)
+{
+    const int lev = 0;
+    const auto plo = pc.Geom(lev).ProbLoArray();
+    const auto dx = pc.Geom(lev).CellSizeArray();
+
+    for (MFIter mfi = pc.MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        const Box& tile_box = mfi.tilebox();
+
+        Gpu::HostVector<PC::ParticleType> host_particles;
+        std::array<Gpu::HostVector<ParticleReal>, NAR> host_real;
+        for (IntVect iv = tile_box.smallEnd(); iv <= tile_box.bigEnd(); tile_box.next(iv))
+        {
+            PC::ParticleType p;
+            p.id()  = PC::ParticleType::NextID();
+            p.cpu() = ParallelDescriptor::MyProc();
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                p.pos(d) = plo[d] + (iv[d] + Real(0.5))*dx[d];
+            }
+            host_particles.push_back(p);
+            for (int i = 0; i < NAR; ++i) {
+                host_real[i].push_back(expected(i, p.id(), p.cpu()));
+            }
+        }
+
+        auto& ptile = pc.DefineAndReturnParticleTile(lev, mfi.index(), mfi.LocalTileIndex());
+        const auto old_size = ptile.GetArrayOfStructs().size();
+        ptile.resize(old_size + host_particles.size());
+        Gpu::copy(Gpu::hostToDevice, host_particles.begin(), host_particles.end(),
+                  ptile.GetArrayOfStructs().begin() + old_size);
+        for (int i = 0; i < NAR; ++i) {
+            Gpu::copy(Gpu::hostToDevice, host_real[i].begin(), host_real[i].end(),
+                      ptile.GetStructOfArrays().GetRealData(i).begin() + old_size);
+        }
+    }
+    Gpu::synchronize();
+    pc.Redistribute();
+}
+
+// Shift every particle by a fraction of the periodic domain, so that it
+// lands in a box that is, with more than one process, mostly on another
+// process.
+void moveParticles (PC& pc, const RealVect& shift)
+{
+    const int lev = 0;
+    const auto plo = pc.Geom(lev).ProbLoArray();
+    const auto phi = pc.Geom(lev).ProbHiArray();
+    const int myproc = ParallelDescriptor::MyProc();
+    for (PC::ParIterType pti(pc, lev); pti.isValid(); ++pti)
+    {
+        auto* pstruct = pti.GetArrayOfStructs()().dataPtr();
+        auto* from = pti.GetStructOfArrays().GetIntData(0).dataPtr();
+        const auto np = pti.numParticles();
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            from[i] = myproc;
+            auto& p = pstruct[i];
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                p.pos(d) += shift[d]*(phi[d]-plo[d]);
+            }
+        });
+    }
+    Gpu::synchronize();
+    pc.Redistribute();
+}
+
+void checkValues (PC const& pc, Long np_expected)
+{
+    const Long np = pc.TotalNumberOfParticles();
+    if (np != np_expected) {
+        amrex::Abort("WireFormat: number of particles changed");
+    }
+
+    const int myproc = ParallelDescriptor::MyProc();
+    using SPType = PC::SuperParticleType;
+    ReduceOps<ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpSum> reduce_ops;
+    auto r = ParticleReduce<ReduceData<ParticleReal, ParticleReal, ParticleReal, Long>>(
+        pc, [=] AMREX_GPU_DEVICE (const SPType& p) noexcept
+            -> GpuTuple<ParticleReal, ParticleReal, ParticleReal, Long>
+        {
+            const int id = p.id();
+            const int cpu = p.cpu();
+            const ParticleReal e0 = expected(0, id, cpu);
+            const ParticleReal e1 = expected(1, id, cpu);
+            const ParticleReal e3 = expected(3, id, cpu);
+            return {std::abs(p.rdata(0)-e0)/std::abs(e0),
+                    std::abs(p.rdata(1)-e1),
+                    std::abs(p.rdata(3)-e3),
+                    static_cast<Long>(p.idata(0) != myproc)};
+        }, reduce_ops);
+
+    ParticleReal err_float = amrex::get<0>(r);
+    ParticleReal err_fixed = amrex::get<1>(r);
+    ParticleReal err_full  = amrex::get<2>(r);
+    Long nmoved = amrex::get<3>(r);
+    ParallelDescriptor::ReduceRealMax(err_float);
+    ParallelDescriptor::ReduceRealMax(err_fixed);
+    ParallelDescriptor::ReduceRealMax(err_full);
+    ParallelDescriptor::ReduceLongSum(nmoved);
+
+    if (ParallelDescriptor::NProcs() > 1 && nmoved == 0) {
+        amrex::Abort("WireFormat: no particle changed process");
+    }
+    if (err_float > ParticleReal(2.)*std::numeric_limits<float>::epsilon()) {
+        amrex::Abort("WireFormat: Float component differs by more than float precision");
+    }
+    if (err_fixed > ParticleReal(0.5001)*fixed16_scale) {
+        amrex::Abort("WireFormat: Fixed16 component differs by more than half the scale");
+    }
+    if (err_full != 0) {
+        amrex::Abort("WireFormat: Full component differs");
+    }
+    amrex::Print() << "  " << np << " particles, " << nmoved
+                   << " changed process: float error " << err_float
+                   << ", fixed16 error " << err_fixed << "\n";
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int nsteps = 3;
+    {
+        ParmParse pp("wire");
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nsteps", nsteps);
+    }
+
+    const Box domain(IntVect(0), IntVect(n_cell-1));
+    const RealBox real_box({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    const Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+    const Geometry geom(domain, real_box, CoordSys::cartesian, is_per);
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    const DistributionMapping dm(ba);
+
+    PC pc(geom, dm, ba);
+    const Long full_size = pc.superParticleSize();
+    pc.SetRealCompWireFormat(0, RealCompWireFormat::Float);
+    pc.SetRealCompWireFormat(1, RealCompWireFormat::Fixed16, fixed16_scale);
+    pc.SetRealCompWireFormat(2, RealCompWireFormat::None);
+    pc.SetRealCompWireFormat(3, RealCompWireFormat::Full);
+
+    const Long saved = 3*sizeof(ParticleReal) - sizeof(float) - sizeof(std::int16_t);
+    if (pc.superParticleSize() != full_size - saved) {
+        amrex::Abort("WireFormat: wrong size of a particle in the buffers");
+    }
+
+    initParticles(pc);
+    const Long np = pc.TotalNumberOfParticles();
+    if (np != domain.numPts()) {
+        amrex::Abort("WireFormat: wrong number of particles");
+    }
+
+    // The Full component must arrive bit for bit; the reduced ones within
+    // their precision.  Once rounded, a value survives further round trips
+    // within the same bound.
+    for (int step = 0; step < nsteps; ++step) {
+        moveParticles(pc, RealVect(AMREX_D_DECL(Real(0.5), Real(0.25), Real(0.5))));
+        checkValues(pc, np);
+    }
+    amrex::Print() << "  wire format redistribute: ok\n";
+}
@@ -0,0 +1,193 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_PlotFileUtil.H>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Linear in space, so averaging down gives the value at the coarse cell center.
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real exact (Real x, Real y, Real z, int n) noexcept
+{
+    return (n == 0) ? x + 2.0_rt*y + 3.0_rt*z : 1.0_rt - 0.5_rt*x + 0.25_rt*z - y;
+}
+
+void fill (MultiFab& mf, const Geometry& geom)
+{
+    const auto dx = geom.CellSizeArray();
+    const auto problo = geom.ProbLoArray();
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.array(mfi);
+        amrex::ParallelFor(mfi.validbox(), mf.nComp(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+        {
+            a(i,j,k,n) = exact(problo[0] + (i+0.5_rt)*dx[0],
+                               problo[1] + (j+0.5_rt)*dx[1],
+                               problo[2] + (k+0.5_rt)*dx[2], n);
+        });
+    }
+}
+
+/**
+* Reads plotfile back and checks the domain of each level, the refinement
+* ratios, that each level holds exactly the cells of the original grids
+* inside its domain, coarsened by crse[lev], and that the data are right.
+* For a plane normal to z, layer[lev] is the z index of the layer on level
+* lev in the original data.  In the plotfile, every level must have the
+* index and the thickness of the level 0 layer.
+*/
+void check (const std::string& plotfile, const Vector<Box>& domain, const Vector<int>& ratio,
+            const Vector<BoxArray>& grids, const Vector<int>& crse,
+            const Vector<int>& layer = Vector<int>())
+{
+    PlotFileData pf(plotfile);
+    const int nlevels = domain.size();
+    if (pf.finestLevel() != nlevels-1) {
+        amrex::Abort("PlotfileRegion: wrong number of levels in " + plotfile);
+    }
+    const bool plane = !layer.empty();
+    for (int lev = 0; lev < nlevels; ++lev)
+    {
+        Box out_domain = domain[lev];
+        if (plane) { out_domain.setRange(2, layer[0]); }
+        if (pf.probDomain(lev) != out_domain) {
+            amrex::Print() << plotfile << " level " << lev << ": domain " << pf.probDomain(lev)
+                           << " instead of " << out_domain << "\n";
+            amrex::Abort("PlotfileRegion: wrong domain in " + plotfile);
+        }
+        if (lev > 0 && pf.refRatio(lev-1) != ratio[lev-1]) {
+            amrex::Abort("PlotfileRegion: wrong refinement ratio in " + plotfile);
+        }
+        // The levels must nest: the domain of every level covers the same
+        // space, so the ratio normal to a plane is 1.
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            const Real extent = pf.probDomain(lev).length(d) * pf.cellSize(lev)[d];
+            const Real extent0 = pf.probDomain(0).length(d) * pf.cellSize(0)[d];
+            if (std::abs(extent - extent0) > 1.e-12_rt * extent0) {
+                amrex::Print() << plotfile << " level " << lev << ": extent " << extent
+                               << " instead of " << extent0 << " in direction " << d << "\n";
+                amrex::Abort("PlotfileRegion: levels do not nest in " + plotfile);
+            }
+        }
+
+        Long npts = 0;
+        const BoxArray& ba = pf.boxArray(lev);
+        for (int i = 0; i < ba.size(); ++i) {
+            if (!out_domain.contains(ba[i])) {
+                amrex::Abort("PlotfileRegion: grid outside the region in " + plotfile);
+            }
+            npts += ba[i].numPts();
+        }
+        BoxArray region_grids = amrex::intersect(amrex::coarsen(grids[lev], crse[lev]),
+                                                 domain[lev]);
+        if (plane) { region_grids.shift(2, layer[0]-layer[lev]); }
+        if (npts != region_grids.numPts() || !ba.contains(region_grids)) {
+            amrex::Abort("PlotfileRegion: wrong cells in " + plotfile);
+        }
+
+        const MultiFab& mf = pf.get(lev);
+        const auto dx = pf.cellSize(lev);
+        Real err = 0.0;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.const_array(mfi);
+            const Box& bx = mfi.validbox();
+            for (int n = 0; n < 2; ++n) {
+                amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+                {
+                    // Cell centers in the original coordinates, where the
+                    // cells are cubes
+                    const Real x = (i+0.5_rt)*dx[0];
+                    const Real y = (j+0.5_rt)*dx[1];
+                    const Real z = plane ? (layer[lev]+0.5_rt)*dx[0] : (k+0.5_rt)*dx[2];
+                    err = amrex::max(err, std::abs(a(i,j,k,n) - exact(x,y,z,n)));
+                });
+            }
+        }
+        ParallelDescriptor::ReduceRealMax(err);
+        if (err > 1.e-12_rt) {
+            amrex::Print() << plotfile << " level " << lev << ": error " << err << "\n";
+            amrex::Abort("PlotfileRegion: wrong data in " + plotfile);
+        }
+    }
+    amrex::Print() << "  " << plotfile << ": ok\n";
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 8;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    // Two levels on the unit cube, the fine one covering the middle half.
+    const Box domain0(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Vector<Geometry> geom{Geometry(domain0, rb, 0, {AMREX_D_DECL(0,0,0)}),
+                          Geometry(amrex::refine(domain0,2), rb, 0, {AMREX_D_DECL(0,0,0)})};
+    Vector<IntVect> ref_ratio{IntVect(2)};
+
+    Vector<BoxArray> grids(2);
+    grids[0] = BoxArray(domain0);
+    grids[0].maxSize(max_grid_size);
+    grids[1] = BoxArray(amrex::refine(Box(IntVect(n_cell/4), IntVect(3*n_cell/4-1)), 2));
+    grids[1].maxSize(max_grid_size);
+
+    Vector<MultiFab> mf(2);
+    Vector<const MultiFab*> mfp(2);
+    for (int lev = 0; lev < 2; ++lev) {
+        mf[lev].define(grids[lev], DistributionMapping(grids[lev]), 2, 0);
+        fill(mf[lev], geom[lev]);
+        mfp[lev] = &mf[lev];
+    }
+    const Vector<std::string> varnames{"u", "v"};
+    const Vector<int> steps{0, 0};
+
+    // A box crossing the edge of the fine level, and a plane through both levels.
+    const Box box(IntVect(AMREX_D_DECL(n_cell/8, 3*n_cell/16, 0)),
+                  IntVect(AMREX_D_DECL(5*n_cell/8-1, 7*n_cell/16-1, n_cell-1)));
+    const Real zplane = 0.3;
+    // A plane limited to the box.
+    const Vector<PlotFileRegion> regions{PlotFileRegion("box", box),
+                                         PlotFileRegion::Plane("zslice", geom[0], 2, zplane),
+                                         PlotFileRegion::Plane("zpart", geom[0], 2, zplane, box)};
+    WriteMultiLevelPlotfileRegions("plt", 2, mfp, varnames, geom, 0.0, steps, ref_ratio, regions);
+
+    const Vector<int> nocrse{1, 1};
+    check("plt_box", {box, amrex::refine(box,2)}, {2}, grids, nocrse);
+
+    const Vector<int> layer{static_cast<int>(zplane*n_cell), static_cast<int>(zplane*2*n_cell)};
+    Box slice0 = domain0, slice1 = amrex::refine(domain0,2);
+    slice0.setRange(2, layer[0]);
+    slice1.setRange(2, layer[1]);
+    check("plt_zslice", {slice0, slice1}, {2}, grids, nocrse, layer);
+    check("plt_zpart", {slice0 & box, slice1 & amrex::refine(box,2)}, {2}, grids, nocrse, layer);
+
+    // The fine level averaged down by 2 and the coarse one by 4.
+    const Box cbox(IntVect(n_cell/4), IntVect(3*n_cell/4-1));
+    WriteMultiLevelPlotfileRegion("plt_coarse", 2, mfp, varnames, geom, 0.0, steps, ref_ratio,
+                                  PlotFileRegion("coarse", cbox, {IntVect(4), IntVect(2)}));
+    check("plt_coarse", {amrex::coarsen(cbox,4), cbox}, {4}, grids, {4, 2});
+
+    // Single level
+    WriteSingleLevelPlotfileRegion("plt_single", mf[0], varnames, geom[0], 0.0, 0,
+                                   PlotFileRegion("single", box));
+    check("plt_single", {box}, {}, grids, nocrse);
+}
@@ -0,0 +1,294 @@
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_PlotFileStreamed.H>
+
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// The cells where plotfile B differs from A the most, and where it has a
+// NaN in variable c, both on level 1.
+const IntVect spike_cell(AMREX_D_DECL(20,21,22));
+const IntVect nan_cell(AMREX_D_DECL(30,30,30));
+
+void fill (MultiFab& mf, const Geometry& geom, int lev, bool is_b)
+{
+    const auto dx = geom.CellSizeArray();
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.array(mfi);
+        amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k)
+        {
+            const Real x = (i+0.5_rt)*dx[0];
+            const Real y = (j+0.5_rt)*dx[1];
+            const Real z = (k+0.5_rt)*dx[2];
+            a(i,j,k,0) = std::sin(6.0_rt*x) * std::cos(4.0_rt*y) + z;
+            a(i,j,k,1) = x*y - z*z + 0.1_rt*lev;
+            a(i,j,k,2) = std::exp(-x) + y;
+            if (is_b) {
+                a(i,j,k,1) += 1.e-3_rt * std::cos(3.0_rt*x + y);
+                if (lev == 1 && IntVect(AMREX_D_DECL(i,j,k)) == spike_cell) {
+                    a(i,j,k,1) += 0.5_rt;
+                }
+                if (lev == 1 && IntVect(AMREX_D_DECL(i,j,k)) == nan_cell) {
+                    a(i,j,k,2) = std::numeric_limits<Real>::quiet_NaN();
+                }
+            }
+        });
+    }
+}
+
+// The cells of level 0 under level 1 hold values that fextrema must skip.
+void fillCovered (MultiFab& mf, const BoxArray& fine_ba, int ratio)
+{
+    const BoxArray cba = amrex::coarsen(fine_ba, ratio);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        for (auto const& is : cba.intersections(mfi.validbox())) {
+            mf[mfi].setVal<RunOn::Host>( 100.0_rt, is.second, 0, 1);
+            mf[mfi].setVal<RunOn::Host>(-100.0_rt, is.second, 1, 1);
+        }
+    }
+}
+
+// The extrema of the cells not covered by the next finer level, from whole
+// levels read at once.
+void wholeExtrema (PlotFileData& pf, Vector<int> const& icomp,
+                   Vector<Real>& vmin, Vector<Real>& vmax)
+{
+    for (int lev = 0; lev <= pf.finestLevel(); ++lev) {
+        MultiFab mf = pf.get(lev);
+        iMultiFab mask;
+        if (lev < pf.finestLevel()) {
+            mask = amrex::makeFineMask(mf, pf.boxArray(lev+1), IntVect(pf.refRatio(lev)));
+        } else {
+            mask.define(mf.boxArray(), mf.DistributionMap(), 1, 0);
+            mask.setVal(0);
+        }
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            auto const& a = mf.const_array(mfi);
+            auto const& m = mask.const_array(mfi);
+            for (int ivar = 0; ivar < icomp.size(); ++ivar) {
+                amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k)
+                {
+                    if (m(i,j,k) == 0) {
+                        vmin[ivar] = std::min(vmin[ivar], a(i,j,k,icomp[ivar]));
+                        vmax[ivar] = std::max(vmax[ivar], a(i,j,k,icomp[ivar]));
+                    }
+                });
+            }
+        }
+    }
+    ParallelDescriptor::ReduceRealMin(vmin.data(), vmin.size());
+    ParallelDescriptor::ReduceRealMax(vmax.data(), vmax.size());
+}
+
+// What fextrema reports
+void checkExtrema (PlotFileData& pf, Vector<int> const& icomp)
+{
+    const int nvars = icomp.size();
+    Vector<Real> vmin(nvars, std::numeric_limits<Real>::max());
+    Vector<Real> vmax(nvars, std::numeric_limits<Real>::lowest());
+    for (int lev = pf.finestLevel(); lev >= 0; --lev) {
+        extrema_level_streamed(pf, lev, icomp, vmin, vmax);
+    }
+    ParallelDescriptor::ReduceRealMin(vmin.data(), vmin.size());
+    ParallelDescriptor::ReduceRealMax(vmax.data(), vmax.size());
+
+    Vector<Real> whole_min(nvars, std::numeric_limits<Real>::max());
+    Vector<Real> whole_max(nvars, std::numeric_limits<Real>::lowest());
+    wholeExtrema(pf, icomp, whole_min, whole_max);
+
+    for (int ivar = 0; ivar < nvars; ++ivar) {
+        if (vmin[ivar] != whole_min[ivar] || vmax[ivar] != whole_max[ivar]) {
+            amrex::Print() << " variable " << icomp[ivar] << ": streamed " << vmin[ivar] << " "
+                           << vmax[ivar] << ", whole " << whole_min[ivar] << " "
+                           << whole_max[ivar] << "\n";
+            amrex::Abort("PlotfileTools: wrong extrema");
+        }
+        if (vmax[ivar] >= 100.0_rt || vmin[ivar] <= -100.0_rt) {
+            amrex::Abort("PlotfileTools: the extrema include covered cells");
+        }
+    }
+}
+
+// What fnan reports.  Returns has_nan[n*nlevels+lev].
+Vector<int> checkNaN (PlotFileData& pf)
+{
+    const int ncomp = pf.nComp();
+    const int nlevels = pf.finestLevel()+1;
+    Vector<int> has_nan(ncomp*nlevels, 0);
+    for (int lev = 0; lev < nlevels; ++lev) {
+        Vector<int> lev_nan(ncomp, 0);
+        nan_level_streamed(pf, lev, lev_nan);
+        ParallelDescriptor::ReduceIntMax(lev_nan.data(), ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            has_nan[n*nlevels+lev] = lev_nan[n];
+            const bool whole = pf.get(lev, pf.varNames()[n]).contains_nan();
+            if (bool(lev_nan[n]) != whole) {
+                amrex::Print() << " level " << lev << " variable " << n << ": streamed "
+                               << lev_nan[n] << ", whole " << whole << "\n";
+                amrex::Abort("PlotfileTools: wrong NaN detection");
+            }
+        }
+    }
+    return has_nan;
+}
+
+bool close (Real a, Real b)
+{
+    return std::abs(a-b) <= 1.e-12_rt * std::max(std::abs(a), std::abs(b));
+}
+
+// What fcompare computes for a level, against whole levels read at once
+// as fcompare does for grids that differ.
+void checkCompare (PlotFileData& pf_a, PlotFileData& pf_b, int norm, int save_var,
+                   ErrZone& err_zone)
+{
+    const int ncomp = pf_a.nComp();
+    Vector<int> ivar_b(ncomp);
+    for (int n = 0; n < ncomp; ++n) { ivar_b[n] = n; }
+
+    for (int lev = 0; lev <= pf_a.finestLevel(); ++lev) {
+        LevelErrors errs(ncomp);
+        MultiFab diff(pf_a.boxArray(lev), pf_a.DistributionMap(lev), 1, 0);
+        compare_level_streamed(pf_a, pf_b, lev, ivar_b, norm, save_var, &diff,
+                               save_var, err_zone, errs);
+
+        for (int n = 0; n < ncomp; ++n) {
+            const std::string& name = pf_a.varNames()[n];
+            MultiFab mf_a = pf_a.get(lev, name);
+            MultiFab mf_b = pf_b.get(lev, name);
+            const bool nan_a = mf_a.contains_nan();
+            const bool nan_b = mf_b.contains_nan();
+            if (bool(errs.has_nan_a[n]) != nan_a || bool(errs.has_nan_b[n]) != nan_b) {
+                amrex::Abort("PlotfileTools: fcompare has the wrong NaN flags");
+            }
+            if (nan_a || nan_b) { continue; }
+
+            MultiFab::Subtract(mf_b, mf_a, 0, 0, 1, 0);
+            Real err_norm, a_norm;
+            if (norm == 1) {
+                err_norm = mf_b.norm1();
+                a_norm = mf_a.norm1();
+            } else if (norm == 2) {
+                err_norm = mf_b.norm2();
+                a_norm = mf_a.norm2();
+            } else {
+                err_norm = mf_b.norm0();
+                a_norm = mf_a.norm0();
+            }
+            if (errs.max_err[n] != mf_b.norm0() ||
+                !close(errs.err_norm[n], err_norm) || !close(errs.a_norm[n], a_norm))
+            {
+                amrex::Print() << " level " << lev << " variable " << name << " norm " << norm
+                               << ": streamed " << errs.max_err[n] << " " << errs.err_norm[n]
+                               << " " << errs.a_norm[n] << ", whole " << mf_b.norm0() << " "
+                               << err_norm << " " << a_norm << "\n";
+                amrex::Abort("PlotfileTools: wrong fcompare differences");
+            }
+
+            if (n == save_var) {
+                mf_b.abs(0, 1);
+                MultiFab::Subtract(mf_b, diff, 0, 0, 1, 0);
+                if (mf_b.norm0() != 0.0_rt) {
+                    amrex::Abort("PlotfileTools: wrong fcompare diff plotfile data");
+                }
+            }
+        }
+    }
+}
+
+}
+
+void test ()
+{
+    int n_cell = 32;
+    int max_grid_size = 8;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+    }
+
+    const int nlevels = 2;
+    const int ratio = 2;
+    RealBox rb({AMREX_D_DECL(0.0_rt,0.0_rt,0.0_rt)}, {AMREX_D_DECL(1.0_rt,1.0_rt,1.0_rt)});
+    Vector<Geometry> geom(nlevels);
+    Vector<BoxArray> grids(nlevels);
+    Vector<DistributionMapping> dmap(nlevels);
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    for (int lev = 0; lev < nlevels; ++lev) {
+        geom[lev].define(domain, rb, CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        if (lev == 0) {
+            grids[lev] = BoxArray(domain);
+        } else {
+            grids[lev] = BoxArray(amrex::grow(domain, -domain.length(0)/4));
+        }
+        grids[lev].maxSize(max_grid_size);
+        dmap[lev].define(grids[lev]);
+        domain.refine(ratio);
+    }
+
+    const Vector<std::string> varnames{"a", "b", "c"};
+    const Vector<int> level_steps(nlevels, 0);
+    const Vector<IntVect> ref_ratio(nlevels-1, IntVect(ratio));
+    for (int ib = 0; ib < 2; ++ib) {
+        Vector<MultiFab> mf(nlevels);
+        for (int lev = 0; lev < nlevels; ++lev) {
+            mf[lev].define(grids[lev], dmap[lev], varnames.size(), 0);
+            fill(mf[lev], geom[lev], lev, ib == 1);
+        }
+        fillCovered(mf[0], grids[1], ratio);
+        WriteMultiLevelPlotfile(ib == 0 ? "plt_a" : "plt_b", nlevels, GetVecOfConstPtrs(mf),
+                                varnames, geom, 0.0, level_steps, ref_ratio);
+    }
+
+    PlotFileData pf_a("plt_a");
+    PlotFileData pf_b("plt_b");
+    pf_b.syncDistributionMap(pf_a);
+
+    checkExtrema(pf_a, {0, 1, 2});
+    checkExtrema(pf_b, {0, 1});
+    amrex::Print() << "  fextrema: ok\n";
+
+    for (int has_nan : checkNaN(pf_a)) {
+        if (has_nan) { amrex::Abort("PlotfileTools: NaN found in a clean plotfile"); }
+    }
+    const Vector<int> has_nan = checkNaN(pf_b);
+    for (int n = 0; n < pf_b.nComp(); ++n) {
+        for (int lev = 0; lev < nlevels; ++lev) {
+            if (bool(has_nan[n*nlevels+lev]) != (n == 2 && lev == 1)) {
+                amrex::Abort("PlotfileTools: the NaN is not reported where it was put");
+            }
+        }
+    }
+    amrex::Print() << "  fnan: ok\n";
+
+    for (int norm = 0; norm <= 2; ++norm) {
+        ErrZone err_zone;
+        checkCompare(pf_a, pf_b, norm, 1, err_zone);
+        if (err_zone.level != 1 || err_zone.cell != spike_cell ||
+            !pf_a.boxArray(1)[err_zone.grid_index].contains(spike_cell))
+        {
+            amrex::Print() << " zone: level " << err_zone.level << " cell " << err_zone.cell
+                           << " grid " << err_zone.grid_index << "\n";
+            amrex::Abort("PlotfileTools: fcompare reports the wrong zone");
+        }
+    }
+    amrex::Print() << "  fcompare: ok\n";
+}
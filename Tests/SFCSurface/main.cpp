@@ -0,0 +1,152 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+using namespace amrex;
+
+void test ();
+BoxArray readBoxList (const std::string& file, Box& domain);
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+// Grids covering a spherical shell, like a refined level around a front.
+BoxArray makeGrids (int n_cell, int max_grid_size)
+{
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+
+    const Real c = 0.5_rt*n_cell;
+    const Real r0 = 0.25_rt*n_cell, r1 = 0.4_rt*n_cell;
+    BoxList bl;
+    for (int i = 0; i < ba.size(); ++i) {
+        const Box& bx = ba[i];
+        Real rmin = 0, rmax = 0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            const Real lo = bx.smallEnd(idim) - c, hi = bx.bigEnd(idim) + 1 - c;
+            const Real near = (lo > 0) ? lo : ((hi < 0) ? -hi : 0);
+            const Real far = std::max(std::abs(lo), std::abs(hi));
+            rmin += near*near;
+            rmax += far*far;
+        }
+        if (rmin <= r1*r1 && rmax >= r0*r0) {
+            bl.push_back(bx);
+        }
+    }
+    return BoxArray(std::move(bl));
+}
+
+// Number of ghost cells each process receives from other processes.
+Vector<Long> commSurface (const BoxArray& ba, const std::vector<std::vector<int> >& pmap, int ng)
+{
+    Vector<int> owner(ba.size());
+    for (int p = 0; p < static_cast<int>(pmap.size()); ++p) {
+        for (int i : pmap[p]) {
+            owner[i] = p;
+        }
+    }
+
+    Vector<Long> surface(pmap.size(), 0);
+    std::vector<std::pair<int,Box> > isects;
+    for (int i = 0; i < ba.size(); ++i) {
+        ba.intersections(amrex::grow(ba[i],ng), isects);
+        for (auto const& is : isects) {
+            if (owner[is.first] != owner[i]) {
+                surface[owner[i]] += is.second.numPts();
+            }
+        }
+    }
+    return surface;
+}
+
+}
+
+void test ()
+{
+    int n_cell = 256;
+    int max_grid_size = 16;
+    int ng = 2;
+    Vector<int> nprocs{8, 64, 512};
+    std::string grids_file;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("ng", ng);
+        pp.queryarr("nprocs", nprocs);
+        pp.query("grids_file", grids_file);
+    }
+
+    BoxArray ba;
+    if (grids_file.empty()) {
+        ba = makeGrids(n_cell, max_grid_size);
+    } else {
+        Box domain;
+        ba = readBoxList(grids_file, domain);
+    }
+
+    amrex::Print() << "BoxArray size " << ba.size() << ", " << ng << " ghost cells\n"
+                   << "  nprocs   curve   max surface  mean surface  total surface\n";
+
+    const DistributionMapping::SFCCurve curves[] = {DistributionMapping::SFCCurve::Morton,
+                                                    DistributionMapping::SFCCurve::Hilbert};
+    const char* names[] = {"morton ", "hilbert"};
+
+    for (int np : nprocs) {
+        for (int ic = 0; ic < 2; ++ic) {
+            DistributionMapping::SFC_Curve(curves[ic]);
+            const auto& pmap = DistributionMapping::makeSFC(ba, true, np);
+            Vector<int> count(ba.size(), 0);
+            for (auto const& boxes : pmap) {
+                for (int i : boxes) { ++count[i]; }
+            }
+            if (static_cast<int>(pmap.size()) != np ||
+                std::any_of(count.begin(), count.end(), [] (int c) { return c != 1; })) {
+                amrex::Abort("SFCSurface: every box must be assigned to exactly one process");
+            }
+            const Vector<Long>& surface = commSurface(ba, pmap, ng);
+            Long total = 0, smax = 0;
+            for (Long s : surface) {
+                total += s;
+                smax = std::max(smax, s);
+            }
+            amrex::Print() << "  " << std::setw(6) << np << "   " << names[ic]
+                           << std::setw(13) << smax
+                           << std::setw(14) << total/np
+                           << std::setw(15) << total << "\n";
+        }
+    }
+}
+
+BoxArray
+readBoxList (const std::string& file, Box& domain)
+{
+    BoxArray retval;
+
+    std::ifstream ifs;
+    ifs.open(file.c_str(), std::ios::in);
+    if (!ifs.good()) {
+        amrex::FileOpenFailed(file);
+    }
+    ifs >> domain;
+    ifs.ignore(1000,'\n');
+    retval.readFrom(ifs);
+
+    return retval;
+}
@@ -0,0 +1,121 @@
+
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_TileSizeTuner.H>
+
+#include <chrono>
+#include <thread>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+void checkTrue (bool b, const std::string& what)
+{
+    if (!b) {
+        amrex::Abort("TileSizeTuner: " + what);
+    }
+}
+
+// One tuned loop over mf.  It is slow unless the tile size is fast_tile.
+IntVect run (const std::string& kernel, MultiFab& mf, const IntVect& fast_tile)
+{
+    TileSizeTuner tuner(kernel, mf);
+    for (MFIter mfi(mf, tuner.tileSize()); mfi.isValid(); ++mfi) {
+        mf[mfi].setVal<RunOn::Host>(1.0, mfi.tilebox());
+    }
+    if (tuner.tileSize() != fast_tile) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return tuner.tileSize();
+}
+
+}
+
+void test ()
+{
+    // Candidates
+    const IntVect boxsize(AMREX_D_DECL(64,32,16));
+    const Vector<IntVect> cand = TileSizeTuner::Candidates(boxsize);
+    checkTrue(!cand.empty(), "no candidates");
+    IntVect deftile = FabArrayBase::mfiter_tile_size;
+    deftile.min(boxsize);
+    checkTrue(cand[0] == deftile, "the default tile size is not the first candidate");
+    for (int i = 0; i < cand.size(); ++i) {
+        checkTrue(cand[i].allGT(IntVect(0)) && cand[i].allLE(boxsize),
+                  "candidate outside the box");
+        for (int j = 0; j < i; ++j) {
+            checkTrue(cand[i] != cand[j], "duplicate candidates");
+        }
+    }
+#if (AMREX_SPACEDIM == 3)
+    // The default, then tiles 64 and 32 long by 4x4, 8x4, 8x8, 16x8, 16x16
+    // and 32x16, the trimmed 32x32.  The default is the same as 64x8x8.
+    checkTrue(cand.size() == 12, "wrong number of candidates");
+#endif
+    // Boxes smaller than any tile leave a single candidate.
+    checkTrue(TileSizeTuner::Candidates(IntVect(2)) == Vector<IntVect>{IntVect(2)},
+              "wrong candidates for a small box");
+
+    // The state machine, with tile_tuner.enable = 1 and tile_tuner.nsamples = 2
+    // from the inputs.  Each candidate is tried in turn, nsamples times, and
+    // then the fastest is kept.
+    BoxArray ba(Box(IntVect(0), boxsize-1));
+    ba.maxSize(boxsize);
+    DistributionMapping dm(ba);
+    MultiFab mf(ba, dm, 1, 0);
+
+    const int nsamples = 2;
+    const IntVect fast = cand[cand.size()/2];
+    const int ncalls = nsamples * cand.size();
+    for (int i = 0; i < ncalls; ++i) {
+        checkTrue(TileSizeTuner::TunedTileSize("slow kernel", boxsize) == FabArrayBase::mfiter_tile_size,
+                  "tuned too early");
+        checkTrue(run("slow kernel", mf, fast) == cand[i % cand.size()],
+                  "candidates not tried in turn");
+    }
+    checkTrue(TileSizeTuner::TunedTileSize("slow kernel", boxsize) == fast,
+              "the fastest candidate is not chosen");
+    for (int i = 0; i < 3; ++i) {
+        checkTrue(run("slow kernel", mf, fast) == fast, "the chosen tile size is not used");
+    }
+
+    // A second kernel is tuned on its own.
+    for (int i = 0; i < ncalls; ++i) {
+        run("other kernel", mf, cand.back());
+    }
+    checkTrue(TileSizeTuner::TunedTileSize("other kernel", boxsize) == cand.back(),
+              "the second kernel is not tuned separately");
+    checkTrue(TileSizeTuner::TunedTileSize("slow kernel", boxsize) == fast,
+              "the first kernel changed");
+    checkTrue(TileSizeTuner::TunedTileSize("slow kernel", IntVect(8)) == FabArrayBase::mfiter_tile_size,
+              "a different box size is tuned");
+
+    // Write and read back into an empty table, with tuning off.
+    const std::string file = "tile_tuner_test.txt";
+    TileSizeTuner::Write(file);
+    ParallelDescriptor::Barrier();
+    TileSizeTuner::Finalize();
+    checkTrue(TileSizeTuner::TunedTileSize("slow kernel", boxsize) == FabArrayBase::mfiter_tile_size,
+              "the table is not cleared by Finalize");
+    TileSizeTuner::Read(file);
+    checkTrue(TileSizeTuner::TunedTileSize("slow kernel", boxsize) == fast &&
+              TileSizeTuner::TunedTileSize("other kernel", boxsize) == cand.back(),
+              "the tile sizes read do not match those written");
+    checkTrue(run("slow kernel", mf, fast) == fast, "the tile size read is not used");
+
+    // A missing file is not an error.
+    TileSizeTuner::Read("no_such_tile_tuner_file.txt");
+
+    amrex::Print() << "TileSizeTuner: ok\n";
+}
@@ -0,0 +1,114 @@
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Arena.H>
+#include <AMReX_CArena.H>
+#include <AMReX_TinyProfiler.H>
+
+using namespace amrex;
+
+void test ();
+
+int main(int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test();
+    amrex::Finalize();
+}
+
+namespace {
+
+struct MemoryStats
+{
+    Long nalloc = -1, nfree = -1, npeak = -1;
+};
+
+#ifdef AMREX_TINY_PROFILING
+MemoryStats getStats (const std::string& fname)
+{
+    MemoryStats r;
+    if (!TinyProfiler::GetMemoryStats(fname, r.nalloc, r.nfree, r.npeak)) {
+        amrex::Abort("TinyProfilerMemory: no timer " + fname);
+    }
+    return r;
+}
+#endif
+
+void checkEqual (Long a, Long b, const std::string& name)
+{
+    if (a != b) {
+        amrex::Print() << name << ": " << a << " != " << b << "\n";
+        amrex::Abort("TinyProfilerMemory: wrong " + name);
+    }
+}
+
+}
+
+void test ()
+{
+#ifdef AMREX_TINY_PROFILING
+    int memory_profiling = 0;
+    {
+        ParmParse pp("tiny_profiler");
+        pp.query("memory_profiling", memory_profiling);
+    }
+
+    constexpr Long M = 1024L*1024L;
+    CArena carena;
+
+    // The bytes in use when the timers start.
+    {
+        TinyProfiler base("TPM::base");
+    }
+
+    {
+        TinyProfiler outer("TPM::outer");
+        void* a = The_Arena()->alloc(M);
+        {
+            TinyProfiler inner("TPM::inner");
+            void* b = The_Cpu_Arena()->alloc(2*M);
+            The_Cpu_Arena()->free(b);
+            void* c = carena.alloc(3*M);
+            carena.free(c);
+        }
+        {
+            // A second call of the same timer adds up.
+            TinyProfiler inner("TPM::inner");
+            void* d = carena.alloc(M);
+            carena.free(d);
+        }
+        The_Arena()->free(a);
+    }
+
+    const MemoryStats base = getStats("TPM::base");
+    const MemoryStats outer = getStats("TPM::outer");
+    const MemoryStats inner = getStats("TPM::inner");
+
+    if (memory_profiling) {
+        checkEqual(base.nalloc, 0, "base alloc");
+        checkEqual(base.nfree, 0, "base free");
+        const Long live = base.npeak;
+
+        // The inner timers see b and c, then d, with a in use all along.
+        checkEqual(inner.nalloc, 6*M, "inner alloc");
+        checkEqual(inner.nfree, 6*M, "inner free");
+        checkEqual(inner.npeak, live + 4*M, "inner peak");
+
+        // The outer timer includes its children.
+        checkEqual(outer.nalloc, 7*M, "outer alloc");
+        checkEqual(outer.nfree, 7*M, "outer free");
+        checkEqual(outer.npeak, live + 4*M, "outer peak");
+        amrex::Print() << "  per-timer memory: ok\n";
+    } else {
+        // Nothing is counted.
+        for (auto const& s : {base, outer, inner}) {
+            checkEqual(s.nalloc, 0, "alloc without memory_profiling");
+            checkEqual(s.nfree, 0, "free without memory_profiling");
+            checkEqual(s.npeak, 0, "peak without memory_profiling");
+        }
+        amrex::Print() << "  no memory counted: ok\n";
+    }
+#else
+    amrex::Print() << "  TinyProfilerMemory needs TINY_PROFILE = TRUE\n";
+#endif
+}
@@ -0,0 +1,246 @@
+#include <AMReX_PlotFileStreamed.H>
+#include <AMReX_PlotFileFabStream.H>
+#include <AMReX_OpenMP.H>
+#include <algorithm>
+#include <cmath>
+
+namespace amrex {
+
+void compare_level_streamed (PlotFileData& pf_a, PlotFileData& pf_b, int ilev,
+                             Vector<int> const& ivar_b, int norm,
+                             int save_var_a, MultiFab* diff,
+                             int zone_info_var_a, ErrZone& err_zone,
+                             LevelErrors& errs)
+{
+    const int ncomp = ivar_b.size();
+    const BoxArray& ba = pf_a.boxArray(ilev);
+    const Vector<int> local_grids = PlotFileFabStream::LocalGrids(pf_a, ilev);
+    const int nbatch = OpenMP::get_max_threads();
+    PlotFileFabStream stream_a(pf_a, ilev, local_grids, 2*nbatch);
+    PlotFileFabStream stream_b(pf_b, ilev, local_grids, 2*nbatch);
+
+    Vector<Real> sum_err(ncomp, 0.0);
+    Vector<Real> sum_a(ncomp, 0.0);
+    Real zone_err = std::numeric_limits<Real>::lowest();
+    int zone_grid = -1;
+    IntVect zone_cell;
+
+    Vector<int> gids, gids_b;
+    Vector<FArrayBox> fabs_a, fabs_b;
+    while (stream_a.next(nbatch, gids, fabs_a) > 0)
+    {
+        stream_b.next(nbatch, gids_b, fabs_b);
+        const int nfabs = fabs_a.size();
+        Vector<Real> fab_max_err(nfabs*ncomp, 0.0);
+        Vector<Real> fab_sum_err(nfabs*ncomp, 0.0);
+        Vector<Real> fab_a(nfabs*ncomp, 0.0);
+        Vector<int> fab_nan_a(nfabs*ncomp, false);
+        Vector<int> fab_nan_b(nfabs*ncomp, false);
+        Vector<IntVect> fab_max_cell(nfabs);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+        for (int ifab = 0; ifab < nfabs; ++ifab) {
+            const Box& bx = ba[gids[ifab]];
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            const auto& a = fabs_a[ifab].const_array();
+            const auto& b = fabs_b[ifab].const_array();
+            for (int n = 0; n < ncomp; ++n) {
+                const int nb = ivar_b[n];
+                if (nb < 0) { continue; }
+                const int m = ifab*ncomp+n;
+                fab_nan_a[m] = fabs_a[ifab].contains_nan<RunOn::Host>(fabs_a[ifab].box(), n, 1);
+                fab_nan_b[m] = fabs_b[ifab].contains_nan<RunOn::Host>(fabs_b[ifab].box(), nb, 1);
+                Array4<Real> d;
+                if (n == save_var_a) { d = diff->array(gids[ifab]); }
+                Real max_err = 0.0, sum_e = 0.0, sum_av = 0.0;
+                IntVect max_cell = bx.smallEnd();
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            const Real e = std::abs(b(i,j,k,nb) - a(i,j,k,n));
+                            const Real av = std::abs(a(i,j,k,n));
+                            if (e > max_err) {
+                                max_err = e;
+                                max_cell = IntVect(AMREX_D_DECL(i,j,k));
+                            }
+                            if (norm == 1) {
+                                sum_e += e;
+                                sum_av += av;
+                            } else if (norm == 2) {
+                                sum_e += e*e;
+                                sum_av += av*av;
+                            } else {
+                                sum_av = std::max(sum_av, av);
+                            }
+                            if (d) { d(i,j,k) = e; }
+                        }
+                    }
+                }
+                fab_max_err[m] = max_err;
+                fab_sum_err[m] = sum_e;
+                fab_a[m] = sum_av;
+                if (n == zone_info_var_a) { fab_max_cell[ifab] = max_cell; }
+            }
+        }
+
+        for (int ifab = 0; ifab < nfabs; ++ifab) {
+            for (int n = 0; n < ncomp; ++n) {
+                const int m = ifab*ncomp+n;
+                errs.max_err[n] = std::max(errs.max_err[n], fab_max_err[m]);
+                errs.has_nan_a[n] = errs.has_nan_a[n] || fab_nan_a[m];
+                errs.has_nan_b[n] = errs.has_nan_b[n] || fab_nan_b[m];
+                if (norm == 0) {
+                    sum_a[n] = std::max(sum_a[n], fab_a[m]);
+                } else {
+                    sum_err[n] += fab_sum_err[m];
+                    sum_a[n] += fab_a[m];
+                }
+            }
+            if (zone_info_var_a >= 0 && fab_max_err[ifab*ncomp+zone_info_var_a] > zone_err) {
+                zone_err = fab_max_err[ifab*ncomp+zone_info_var_a];
+                zone_grid = gids[ifab];
+                zone_cell = fab_max_cell[ifab];
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceRealMax(errs.max_err.data(), ncomp);
+    ParallelDescriptor::ReduceIntMax(errs.has_nan_a.data(), ncomp);
+    ParallelDescriptor::ReduceIntMax(errs.has_nan_b.data(), ncomp);
+    if (norm == 0) {
+        ParallelDescriptor::ReduceRealMax(sum_a.data(), ncomp);
+    } else {
+        ParallelDescriptor::ReduceRealSum(sum_err.data(), ncomp);
+        ParallelDescriptor::ReduceRealSum(sum_a.data(), ncomp);
+    }
+    for (int n = 0; n < ncomp; ++n) {
+        if (norm == 0) {
+            errs.err_norm[n] = errs.max_err[n];
+            errs.a_norm[n] = sum_a[n];
+        } else if (norm == 1) {
+            errs.err_norm[n] = sum_err[n];
+            errs.a_norm[n] = sum_a[n];
+        } else {
+            errs.err_norm[n] = std::sqrt(sum_err[n]);
+            errs.a_norm[n] = std::sqrt(sum_a[n]);
+        }
+    }
+
+    if (zone_info_var_a >= 0 && ivar_b[zone_info_var_a] >= 0) {
+        const Real max_err = errs.max_err[zone_info_var_a];
+        if (max_err > err_zone.max_abs_err) {
+            // the lowest rank holding the maximum broadcasts its location
+            const int nprocs = ParallelDescriptor::NProcs();
+            int root = (zone_grid >= 0 && zone_err == max_err)
+                ? ParallelDescriptor::MyProc() : nprocs;
+            ParallelDescriptor::ReduceIntMin(root);
+            AMREX_ALWAYS_ASSERT(root < nprocs);
+            ParallelDescriptor::Bcast(&zone_grid, 1, root);
+            ParallelDescriptor::Bcast(zone_cell.begin(), AMREX_SPACEDIM, root);
+            err_zone.max_abs_err = max_err;
+            err_zone.level = ilev;
+            err_zone.cell = zone_cell;
+            err_zone.grid_index = zone_grid;
+        }
+    }
+}
+
+void extrema_level_streamed (PlotFileData& pf, int ilev, Vector<int> const& icomp,
+                             Vector<Real>& vvmin, Vector<Real>& vvmax)
+{
+    const int nvars = icomp.size();
+    const int dim = pf.spaceDim();
+    const BoxArray& ba = pf.boxArray(ilev);
+    BoxArray fine_ba;
+    if (ilev < pf.finestLevel()) {
+        IntVect ratio{pf.refRatio(ilev)};
+        for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
+            ratio[idim] = 1;
+        }
+        fine_ba = amrex::coarsen(pf.boxArray(ilev+1), ratio);
+    }
+
+    // The fabs are processed by a batch at a time, one fab per thread.
+    const int nbatch = OpenMP::get_max_threads();
+    PlotFileFabStream stream(pf, ilev, PlotFileFabStream::LocalGrids(pf, ilev), 2*nbatch);
+    Vector<int> gids;
+    Vector<FArrayBox> fabs;
+    while (stream.next(nbatch, gids, fabs) > 0) {
+        const int nfabs = fabs.size();
+        Vector<Real> fab_min(nfabs*nvars, std::numeric_limits<Real>::max());
+        Vector<Real> fab_max(nfabs*nvars, std::numeric_limits<Real>::lowest());
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+        for (int ifab = 0; ifab < nfabs; ++ifab) {
+            const Box& bx = ba[gids[ifab]];
+            BaseFab<int> covered(bx, 1);
+            covered.setVal<RunOn::Host>(0);
+            if (!fine_ba.empty()) {
+                for (auto const& is : fine_ba.intersections(bx)) {
+                    covered.setVal<RunOn::Host>(1, is.second);
+                }
+            }
+            const auto lo = amrex::lbound(bx);
+            const auto hi = amrex::ubound(bx);
+            const auto& msk = covered.const_array();
+            const auto& fab = fabs[ifab].const_array();
+            for (int ivar = 0; ivar < nvars; ++ivar) {
+                const int n = icomp[ivar];
+                Real vmin = fab_min[ifab*nvars+ivar];
+                Real vmax = fab_max[ifab*nvars+ivar];
+                for         (int k = lo.z; k <= hi.z; ++k) {
+                    for     (int j = lo.y; j <= hi.y; ++j) {
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            if (msk(i,j,k) == 0) {
+                                vmin = std::min(fab(i,j,k,n),vmin);
+                                vmax = std::max(fab(i,j,k,n),vmax);
+                            }
+                        }
+                    }
+                }
+                fab_min[ifab*nvars+ivar] = vmin;
+                fab_max[ifab*nvars+ivar] = vmax;
+            }
+        }
+        for (int ifab = 0; ifab < nfabs; ++ifab) {
+            for (int ivar = 0; ivar < nvars; ++ivar) {
+                vvmin[ivar] = std::min(vvmin[ivar], fab_min[ifab*nvars+ivar]);
+                vvmax[ivar] = std::max(vvmax[ivar], fab_max[ifab*nvars+ivar]);
+            }
+        }
+    }
+}
+
+void nan_level_streamed (PlotFileData& pf, int ilev, Vector<int>& has_nan)
+{
+    const int ncomp = pf.nComp();
+    const BoxArray& ba = pf.boxArray(ilev);
+
+    // The fabs are checked by a batch at a time, one fab per thread.
+    const int nbatch = OpenMP::get_max_threads();
+    PlotFileFabStream stream(pf, ilev, PlotFileFabStream::LocalGrids(pf, ilev), 2*nbatch);
+    Vector<int> gids;
+    Vector<FArrayBox> fabs;
+    while (stream.next(nbatch, gids, fabs) > 0) {
+        const int nfabs = fabs.size();
+        Vector<int> fab_nan(nfabs*ncomp, 0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+        for (int ifab = 0; ifab < nfabs; ++ifab) {
+            for (int n = 0; n < ncomp; ++n) {
+                fab_nan[ifab*ncomp+n] = fabs[ifab].contains_nan<RunOn::Host>(ba[gids[ifab]], n, 1);
+            }
+        }
+        for (int ifab = 0; ifab < nfabs; ++ifab) {
+            for (int n = 0; n < ncomp; ++n) {
+                has_nan[n] |= fab_nan[ifab*ncomp+n];
+            }
+        }
+    }
+}
+
+}
@@ -1,6 +1,7 @@
 #include <AMReX.H>
 #include <AMReX_Print.H>
 #include <AMReX_PlotFileUtil.H>
+#include <AMReX_PlotFileStreamed.H>
 #include <algorithm>
 #include <limits>
 #include <cmath>
@@ -8,13 +9,6 @@
 
 using namespace amrex;
 
-struct ErrZone {
-    Real max_abs_err = std::numeric_limits<Real>::lowest();
-    int level;
-    int grid_index;
-    IntVect cell;
-};
-
 int main_main()
 {
     const int narg = amrex::command_argument_count();
@@ -201,48 +195,36 @@ int main_main()
 
         Vector<Real> aerror(ncomp_a, 0.0);
         Vector<Real> rerror(ncomp_a, 0.0);
-        Vector<Real> rerror_denom(ncomp_a, 0.0);
-        Vector<int> has_nan_a(ncomp_a, false);
-        Vector<int> has_nan_b(ncomp_a, false);
-        for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
-            if (ivar_b[icomp_a] >= 0) {
+        LevelErrors errs(ncomp_a);
+        Vector<int>& has_nan_a = errs.has_nan_a;
+        Vector<int>& has_nan_b = errs.has_nan_b;
+        if (grids_match) {
+            compare_level_streamed(pf_a, pf_b, ilev, ivar_b, norm,
+                                   save_var_a, (save_var_a >= 0) ? &mf_array[ilev] : nullptr,
+                                   zone_info_var_a, err_zone, errs);
+        } else {
+            for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
+                if (ivar_b[icomp_a] < 0) { continue; }
                 const MultiFab& mf_a = pf_a.get(ilev, names_a[icomp_a]);
-                MultiFab mf_b;
-                if (grids_match) {
-                    mf_b = pf_b.get(ilev, names_b[ivar_b[icomp_a]]);
-                } else {
-                    mf_b.define(mf_a.boxArray(), mf_a.DistributionMap(), 1, 0);
+                MultiFab mf_b(mf_a.boxArray(), mf_a.DistributionMap(), 1, 0);
+                {
                     MultiFab tmp = pf_b.get(ilev, names_b[ivar_b[icomp_a]]);
                     mf_b.ParallelCopy(tmp);
                 }
                 has_nan_a[icomp_a] = mf_a.contains_nan();
                 has_nan_b[icomp_a] = mf_b.contains_nan();
                 MultiFab::Subtract(mf_b,mf_a,0,0,1,0); // b = b - a
-                Real max_err = mf_b.norm0();
+                const Real max_err = mf_b.norm0();
+                errs.max_err[icomp_a] = max_err;
                 if (norm == 1) {
-                    aerror[icomp_a] = mf_b.norm1();
-                    rerror[icomp_a] = aerror[icomp_a];
-                    rerror_denom[icomp_a] = mf_a.norm1();
+                    errs.err_norm[icomp_a] = mf_b.norm1();
+                    errs.a_norm[icomp_a] = mf_a.norm1();
                 } else if (norm == 2) {
-                    aerror[icomp_a] = mf_b.norm2();
-                    rerror[icomp_a] = aerror[icomp_a];
-                    rerror_denom[icomp_a] = mf_a.norm2();
-                } else {
-                    aerror[icomp_a] = max_err;
-                    rerror[icomp_a] = aerror[icomp_a];
-                    rerror_denom[icomp_a] = mf_a.norm0();
-                }
-
-                if (norm == 0) {
-                    rerror[icomp_a] /= rerror_denom[icomp_a];
+                    errs.err_norm[icomp_a] = mf_b.norm2();
+                    errs.a_norm[icomp_a] = mf_a.norm2();
                 } else {
-                    const auto& dx = pf_a.cellSize(ilev);
-                    Real dv = 1.0;
-                    for (int idim = 0; idim < dm; ++idim) {
-                        dv *= dx[idim];
-                    }
-                    aerror[icomp_a] *= std::pow(dv,1./static_cast<Real>(norm));
-                    rerror[icomp_a] = rerror[icomp_a]/rerror_denom[icomp_a];
+                    errs.err_norm[icomp_a] = max_err;
+                    errs.a_norm[icomp_a] = mf_a.norm0();
                 }
 
                 if (icomp_a == save_var_a || icomp_a == zone_info_var_a) {
@@ -266,6 +248,20 @@ int main_main()
             }
         }
 
+        for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
+            if (ivar_b[icomp_a] < 0) { continue; }
+            aerror[icomp_a] = errs.err_norm[icomp_a];
+            rerror[icomp_a] = aerror[icomp_a]/errs.a_norm[icomp_a];
+            if (norm != 0) {
+                const auto& dx = pf_a.cellSize(ilev);
+                Real dv = 1.0;
+                for (int idim = 0; idim < dm; ++idim) {
+                    dv *= dx[idim];
+                }
+                aerror[icomp_a] *= std::pow(dv,1./static_cast<Real>(norm));
+            }
+        }
+
         amrex::Print() << " level = " << ilev << "\n";
         for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
             if (ivar_b[icomp_a] < 0) {
@@ -347,10 +343,11 @@ int main_main()
                                   << "   level = " << err_zone.level << " (i,j,k) = " << err_zone.cell << "\n";
             }
 
-            for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
-                const MultiFab& mf = pf_a.get(err_zone.level,names_a[icomp_a]);
-                if (owner_proc) {
-                    Real v = mf[err_zone.grid_index](err_zone.cell);
+            if (owner_proc) {
+                // read only the fab holding the zone
+                FArrayBox fab = pf_a.getFab(err_zone.level, err_zone.grid_index);
+                for (int icomp_a = 0; icomp_a < ncomp_a; ++icomp_a) {
+                    Real v = fab(err_zone.cell, icomp_a);
                     amrex::AllPrint() << " " << std::setw(24)
                                       << names_a[icomp_a] << "  "
                                       << std::setw(24) << std::right
@@ -1,7 +1,7 @@
 #include <AMReX.H>
 #include <AMReX_Print.H>
 #include <AMReX_PlotFileUtil.H>
-#include <AMReX_MultiFabUtil.H>
+#include <AMReX_PlotFileStreamed.H>
 #include <algorithm>
 #include <limits>
 #include <cmath>
@@ -59,46 +59,22 @@ void main_main()
         }
 
         // get the extrema
-        Vector<Real> vvmin(var_names.size());
-        Vector<Real> vvmax(var_names.size());
-
-        const int dim = pf.spaceDim();
+        Vector<int> icomp(var_names.size());
+        for (int ivar = 0; ivar < var_names.size(); ++ivar) {
+            auto r = std::find(var_names_pf.begin(), var_names_pf.end(), var_names[ivar]);
+            if (r == var_names_pf.end()) {
+                amrex::Abort("fextrema: variable not found "+var_names[ivar]);
+            }
+            icomp[ivar] = static_cast<int>(std::distance(var_names_pf.begin(), r));
+        }
+        const int nvars = var_names.size();
+        Vector<Real> vvmin(nvars, std::numeric_limits<Real>::max());
+        Vector<Real> vvmax(nvars, std::numeric_limits<Real>::lowest());
 
+        // The fabs are streamed from disk.  On coarse levels the cells
+        // covered by the next finer level are skipped.
         for (int ilev = pf.finestLevel(); ilev >= 0; --ilev) {
-            if (ilev == pf.finestLevel()) {
-                for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                    const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                    vvmin[ivar] = mf.min(0,0,false);
-                    vvmax[ivar] = mf.max(0,0,false);
-                }
-            } else {
-                IntVect ratio{pf.refRatio(ilev)};
-                for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
-                    ratio[idim] = 1;
-                }
-                iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
-                                              pf.boxArray(ilev+1), ratio);
-                for (int ivar = 0; ivar < var_names.size(); ++ivar) {
-                    const MultiFab& mf = pf.get(ilev, var_names[ivar]);
-                    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
-                        const Box& bx = mfi.validbox();
-                        const auto lo = amrex::lbound(bx);
-                        const auto hi = amrex::ubound(bx);
-                        const auto& ifab = mask.array(mfi);
-                        const auto& fab = mf.array(mfi);
-                        for         (int k = lo.z; k <= hi.z; ++k) {
-                            for     (int j = lo.y; j <= hi.y; ++j) {
-                                for (int i = lo.x; i <= hi.x; ++i) {
-                                    if (ifab(i,j,k) == 0) {
-                                        vvmin[ivar] = std::min(fab(i,j,k),vvmin[ivar]);
-                                        vvmax[ivar] = std::max(fab(i,j,k),vvmax[ivar]);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            extrema_level_streamed(pf, ilev, icomp, vvmin, vvmax);
         }
 
         ParallelDescriptor::ReduceRealMin(vvmin.data(), vvmin.size());
@@ -1,6 +1,7 @@
 #include <AMReX.H>
 #include <AMReX_Print.H>
 #include <AMReX_PlotFileUtil.H>
+#include <AMReX_PlotFileStreamed.H>
 #include <algorithm>
 
 using namespace amrex;
@@ -31,24 +32,31 @@ void main_main()
     for (auto const& name : names) {
         nwidth = std::max(nwidth, static_cast<int>(name.size()));
     }
-    for (int n = 0; n < ncomp; ++n) {
-        const std::string& varname = names[n];
-        Vector<int> has_nan(nlevels);
-        for (int ilev = 0; ilev < nlevels; ++ilev) {
-            const MultiFab& mf = plotfile.get(ilev,varname);
-            has_nan[ilev] = mf.contains_nan(0,1,0);
+
+    // has_nan[n*nlevels+ilev]: does variable n have a NaN on level ilev?
+    // The fabs are streamed from disk.
+    Vector<int> has_nan(ncomp*nlevels, 0);
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        Vector<int> lev_nan(ncomp, 0);
+        nan_level_streamed(plotfile, ilev, lev_nan);
+        for (int n = 0; n < ncomp; ++n) {
+            has_nan[n*nlevels+ilev] = lev_nan[n];
         }
+    }
+    ParallelDescriptor::ReduceIntMax(has_nan.data(), has_nan.size());
 
+    for (int n = 0; n < ncomp; ++n) {
+        const std::string& varname = names[n];
         int num_nans = 0;
-        for (int b : has_nan) {
-            if (b) ++num_nans;
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            if (has_nan[n*nlevels+ilev]) ++num_nans;
         }
         if (num_nans == 0) {
             amrex::Print() << " " << std::setw(nwidth+1) << std::left << varname << ": clean" << "\n";
         } else {
             amrex::Print() << " " << varname << ": has NaNs on level(s)";
             for (int ilev = 0; ilev < nlevels; ++ilev) {
-                if (has_nan[ilev]) {
+                if (has_nan[n*nlevels+ilev]) {
                     amrex::Print() << "  " << ilev;
                 }
             }